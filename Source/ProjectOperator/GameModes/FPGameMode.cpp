@@ -4,6 +4,8 @@
 #include "GameModes/FPGameMode.h"
 #include "Characters/FPCharacter.h"
 #include "Controllers/FPPlayerController.h"
+#include "Variant_Shooter/ShooterRoundResetSubsystem.h"
+#include "Engine/World.h"
 
 AFPGameMode::AFPGameMode()
 {
@@ -15,4 +17,18 @@ AFPGameMode::AFPGameMode()
 void AFPGameMode::BeginPlay()
 {
 	Super::BeginPlay();
+
+	// Snapshot the starting state so rounds can be reset in place
+	if (UShooterRoundResetSubsystem* RoundReset = GetWorld()->GetSubsystem<UShooterRoundResetSubsystem>())
+	{
+		RoundReset->RequestSnapshot();
+	}
+}
+
+void AFPGameMode::ResetRound()
+{
+	if (UShooterRoundResetSubsystem* RoundReset = GetWorld()->GetSubsystem<UShooterRoundResetSubsystem>())
+	{
+		RoundReset->StartRoundReset();
+	}
 }
\ No newline at end of file
@@ -18,6 +18,10 @@ class PROJECTOPERATOR_API AFPGameMode : public AGameModeBase
 public:
 	AFPGameMode();
 
+	/** Restores the level to its starting state over the next few frames, without reloading the map */
+	UFUNCTION(BlueprintCallable, Category = "Round")
+	void ResetRound();
+
 protected:
 	virtual void BeginPlay() override;
 };
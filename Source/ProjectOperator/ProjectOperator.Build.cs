@@ -15,10 +15,13 @@ public class ProjectOperator : ModuleRules
 			"InputCore",
 			"EnhancedInput",
 			"AIModule",
+			"NavigationSystem",
+			"MassEntity",
 			"StateTreeModule",
 			"GameplayStateTreeModule",
 			"UMG",
-			"Slate"
+			"Slate",
+			"NetCore"
 		});
 
 		PrivateDependencyModuleNames.AddRange(new string[] { });
@@ -5,4 +5,7 @@
 #include "CoreMinimal.h"
 
 /** Main log category used across the project */
-DECLARE_LOG_CATEGORY_EXTERN(LogProjectOperator, Log, All);
\ No newline at end of file
+DECLARE_LOG_CATEGORY_EXTERN(LogProjectOperator, Log, All);
+
+/** Stat group for the budgeted shooter AI systems */
+DECLARE_STATS_GROUP(TEXT("ShooterAI"), STATGROUP_ShooterAI, STATCAT_Advanced);
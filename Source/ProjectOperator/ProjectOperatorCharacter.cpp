@@ -10,28 +10,39 @@
 #include "GameFramework/CharacterMovementComponent.h"
 #include "ProjectOperator.h"
 
-AProjectOperatorCharacter::AProjectOperatorCharacter()
+FName AProjectOperatorCharacter::FirstPersonMeshComponentName(TEXT("First Person Mesh"));
+FName AProjectOperatorCharacter::FirstPersonCameraComponentName(TEXT("First Person Camera"));
+
+AProjectOperatorCharacter::AProjectOperatorCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
 {
 	// Set size for collision capsule
 	GetCapsuleComponent()->InitCapsuleSize(55.f, 96.0f);
 	
 	// Create the first person mesh that will be viewed only by this character's owner
-	FirstPersonMesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("First Person Mesh"));
-
-	FirstPersonMesh->SetupAttachment(GetMesh());
-	FirstPersonMesh->SetOnlyOwnerSee(true);
-	FirstPersonMesh->FirstPersonPrimitiveType = EFirstPersonPrimitiveType::FirstPerson;
-	FirstPersonMesh->SetCollisionProfileName(FName("NoCollision"));
-
-	// Create the Camera Component	
-	FirstPersonCameraComponent = CreateDefaultSubobject<UCameraComponent>(TEXT("First Person Camera"));
-	FirstPersonCameraComponent->SetupAttachment(FirstPersonMesh, FName("head"));
-	FirstPersonCameraComponent->SetRelativeLocationAndRotation(FVector(-2.8f, 5.89f, 0.0f), FRotator(0.0f, 90.0f, -90.0f));
-	FirstPersonCameraComponent->bUsePawnControlRotation = true;
-	FirstPersonCameraComponent->bEnableFirstPersonFieldOfView = true;
-	FirstPersonCameraComponent->bEnableFirstPersonScale = true;
-	FirstPersonCameraComponent->FirstPersonFieldOfView = 70.0f;
-	FirstPersonCameraComponent->FirstPersonScale = 0.6f;
+	FirstPersonMesh = CreateOptionalDefaultSubobject<USkeletalMeshComponent>(FirstPersonMeshComponentName);
+
+	if (FirstPersonMesh)
+	{
+		FirstPersonMesh->SetupAttachment(GetMesh());
+		FirstPersonMesh->SetOnlyOwnerSee(true);
+		FirstPersonMesh->FirstPersonPrimitiveType = EFirstPersonPrimitiveType::FirstPerson;
+		FirstPersonMesh->SetCollisionProfileName(FName("NoCollision"));
+
+		// Create the Camera Component
+		FirstPersonCameraComponent = CreateOptionalDefaultSubobject<UCameraComponent>(FirstPersonCameraComponentName);
+	}
+
+	if (FirstPersonCameraComponent)
+	{
+		FirstPersonCameraComponent->SetupAttachment(FirstPersonMesh, FName("head"));
+		FirstPersonCameraComponent->SetRelativeLocationAndRotation(FVector(-2.8f, 5.89f, 0.0f), FRotator(0.0f, 90.0f, -90.0f));
+		FirstPersonCameraComponent->bUsePawnControlRotation = true;
+		FirstPersonCameraComponent->bEnableFirstPersonFieldOfView = true;
+		FirstPersonCameraComponent->bEnableFirstPersonScale = true;
+		FirstPersonCameraComponent->FirstPersonFieldOfView = 70.0f;
+		FirstPersonCameraComponent->FirstPersonScale = 0.6f;
+	}
 
 	// configure the character comps
 	GetMesh()->SetOwnerNoSee(true);
@@ -50,7 +50,13 @@ protected:
 	class UInputAction* MouseLookAction;
 	
 public:
-	AProjectOperatorCharacter();
+	AProjectOperatorCharacter(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+	/** Name of the first person mesh. Subclasses that are never viewed in first person can skip it with DoNotCreateDefaultSubobject */
+	static FName FirstPersonMeshComponentName;
+
+	/** Name of the first person camera. Skipped along with the first person mesh it's attached to */
+	static FName FirstPersonCameraComponentName;
 
 protected:
 
@@ -84,10 +90,10 @@ protected:
 
 public:
 
-	/** Returns the first person mesh **/
+	/** Returns the first person mesh. May be null for characters that skip it **/
 	USkeletalMeshComponent* GetFirstPersonMesh() const { return FirstPersonMesh; }
 
-	/** Returns first person camera component **/
+	/** Returns first person camera component. May be null for characters that skip it **/
 	UCameraComponent* GetFirstPersonCameraComponent() const { return FirstPersonCameraComponent; }
 
 };
@@ -0,0 +1,19 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Settings/ShooterAISettings.h"
+
+const FShooterAILODSettings& UShooterAISettings::GetLODSettings(EShooterAILOD LOD) const
+{
+	switch (LOD)
+	{
+	case EShooterAILOD::High:
+		return HighLOD;
+
+	case EShooterAILOD::Medium:
+		return MediumLOD;
+
+	default:
+		return LowLOD;
+	}
+}
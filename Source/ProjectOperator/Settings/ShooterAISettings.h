@@ -0,0 +1,353 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "ShooterAISettings.generated.h"
+
+class UWorld;
+class UShooterVisibilityGrid;
+
+/**
+ * Pair of teams that are allied to each other
+ */
+USTRUCT(BlueprintType)
+struct FShooterTeamPair
+{
+	GENERATED_BODY()
+
+	/** First team */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Teams")
+	uint8 TeamA = 0;
+
+	/** Second team */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Teams")
+	uint8 TeamB = 0;
+};
+
+/**
+ * Significance buckets for shooter NPCs, from most to least relevant to players
+ */
+UENUM(BlueprintType)
+enum class EShooterAILOD : uint8
+{
+	High,
+	Medium,
+	Low
+};
+
+/**
+ * Update rates applied to NPCs in a significance bucket
+ */
+USTRUCT(BlueprintType)
+struct FShooterAILODSettings
+{
+	GENERATED_BODY()
+
+	/** Max effective distance to the nearest player to enter this bucket. Unused for the lowest bucket */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "AI LOD", meta = (ClampMin = 0.0, Units = "cm"))
+	float MaxDistance = 0.0f;
+
+	/** Tick interval for the StateTree component. Zero ticks every frame */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "AI LOD", meta = (ClampMin = 0.0, ClampMax = 5.0, Units = "s"))
+	float StateTreeTickInterval = 0.0f;
+
+	/** Interval between processing batches of perception stimuli. Zero processes every tick */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "AI LOD", meta = (ClampMin = 0.0, ClampMax = 5.0, Units = "s"))
+	float PerceptionInterval = 0.0f;
+
+	/** Tick interval for the path following component. Zero ticks every frame */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "AI LOD", meta = (ClampMin = 0.0, ClampMax = 5.0, Units = "s"))
+	float PathFollowingTickInterval = 0.0f;
+
+	/** If false, the sight sense is disabled while in this bucket */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "AI LOD")
+	bool bSightEnabled = true;
+
+	/** Interval between shooter sight updates for each NPC in this bucket. Zero updates on every sense pass */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "AI LOD", meta = (ClampMin = 0.0, ClampMax = 5.0, Units = "s", EditCondition = "bSightEnabled"))
+	float SightUpdateInterval = 0.0f;
+
+	/** If true, NPCs in this bucket skip full character movement and move along the navmesh instead */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "AI LOD")
+	bool bSimplifiedMovement = false;
+
+	/** Interval between simplified movement steps */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "AI LOD", meta = (ClampMin = 0.0, ClampMax = 1.0, Units = "s", EditCondition = "bSimplifiedMovement"))
+	float SimplifiedMovementInterval = 0.0f;
+
+	FShooterAILODSettings() = default;
+
+	FShooterAILODSettings(float InMaxDistance, float InStateTreeTickInterval, float InPerceptionInterval, float InPathFollowingTickInterval, float InSightUpdateInterval, bool bInSimplifiedMovement = false, float InSimplifiedMovementInterval = 0.0f)
+		: MaxDistance(InMaxDistance)
+		, StateTreeTickInterval(InStateTreeTickInterval)
+		, PerceptionInterval(InPerceptionInterval)
+		, PathFollowingTickInterval(InPathFollowingTickInterval)
+		, SightUpdateInterval(InSightUpdateInterval)
+		, bSimplifiedMovement(bInSimplifiedMovement)
+		, SimplifiedMovementInterval(InSimplifiedMovementInterval)
+	{}
+};
+
+/**
+ * Project-wide performance budgets for the shooter AI
+ * Accessible via Project Settings -> Game -> Shooter AI Settings
+ */
+UCLASS(Config = Game, DefaultConfig, meta = (DisplayName = "Shooter AI Settings"))
+class PROJECTOPERATOR_API UShooterAISettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	/** Max number of line of sight traces issued per frame across all AI */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Line of Sight", meta = (ClampMin = 1, ClampMax = 256))
+	int32 MaxLineOfSightTracesPerFrame = 16;
+
+	/** Age after which a cached line of sight result is refreshed */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Line of Sight", meta = (ClampMin = 0.0, ClampMax = 5.0, Units = "s"))
+	float LineOfSightRefreshInterval = 0.2f;
+
+	/** Cached line of sight results that are not queried for this long are discarded */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Line of Sight", meta = (ClampMin = 0.1, ClampMax = 30.0, Units = "s"))
+	float LineOfSightEntryLifetime = 2.0f;
+
+	/** Baked visibility grids by level. Line of sight checks between cells that can never see each other are skipped */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Line of Sight")
+	TMap<TSoftObjectPtr<UWorld>, TSoftObjectPtr<UShooterVisibilityGrid>> VisibilityGrids;
+
+	/** Update rates for NPCs close to or fighting players */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "AI LOD")
+	FShooterAILODSettings HighLOD = FShooterAILODSettings(2500.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+
+	/** Update rates for NPCs at medium range */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "AI LOD")
+	FShooterAILODSettings MediumLOD = FShooterAILODSettings(6000.0f, 0.1f, 0.25f, 0.1f, 0.25f);
+
+	/** Update rates for distant NPCs */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "AI LOD")
+	FShooterAILODSettings LowLOD = FShooterAILODSettings(0.0f, 0.5f, 1.0f, 0.25f, 1.0f, true, 0.2f);
+
+	/** Max number of NPCs allowed in the high bucket at once. The least significant ones are pushed down */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "AI LOD", meta = (ClampMin = 0, ClampMax = 256))
+	int32 MaxHighLODNPCs = 12;
+
+	/** Fraction of a bucket's distance an NPC may move past before being demoted out of it */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "AI LOD", meta = (ClampMin = 0.0, ClampMax = 1.0))
+	float LODHysteresis = 0.15f;
+
+	/** Time between significance updates */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "AI LOD", meta = (ClampMin = 0.0, ClampMax = 5.0, Units = "s"))
+	float LODUpdateInterval = 0.25f;
+
+	/** Half angle of a player's view cone. NPCs inside it count as closer */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "AI LOD", meta = (ClampMin = 0.0, ClampMax = 180.0, Units = "Degrees"))
+	float InViewConeAngle = 60.0f;
+
+	/** Distance multiplier for NPCs inside a player's view cone */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "AI LOD", meta = (ClampMin = 0.0, ClampMax = 1.0))
+	float InViewDistanceScale = 0.5f;
+
+	/** Distance multiplier for NPCs currently targeting an enemy */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "AI LOD", meta = (ClampMin = 0.0, ClampMax = 1.0))
+	float InCombatDistanceScale = 0.5f;
+
+	/** Time budget per frame for ticking shooter AI StateTrees. At least one tree is always ticked */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "StateTree Scheduling", meta = (ClampMin = 0.0, ClampMax = 16.0, Units = "ms"))
+	float StateTreeBudgetMs = 2.0f;
+
+	/** Time past its tick interval after which a deferred StateTree jumps ahead of the round robin */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "StateTree Scheduling", meta = (ClampMin = 0.0, ClampMax = 5.0, Units = "s"))
+	float StateTreeStarvationTime = 0.1f;
+
+	/** Max distance between querying NPCs for them to share an EQS query result */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "EQS", meta = (ClampMin = 0.0, Units = "cm"))
+	float EnvQueryShareRadius = 1500.0f;
+
+	/** Time a completed EQS query result can be reused by other NPCs */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "EQS", meta = (ClampMin = 0.0, ClampMax = 10.0, Units = "s"))
+	float EnvQueryResultLifetime = 1.0f;
+
+	/** Min distance between locations handed out from the same shared result, so squad members spread out */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "EQS", meta = (ClampMin = 0.0, Units = "cm"))
+	float EnvQueryClaimRadius = 200.0f;
+
+	/** Max number of EQS queries started per frame across all AI */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "EQS", meta = (ClampMin = 1, ClampMax = 64))
+	int32 MaxEnvQueryStartsPerFrame = 2;
+
+	/** Max number of EQS queries running at once across all AI */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "EQS", meta = (ClampMin = 1, ClampMax = 256))
+	int32 MaxEnvQueriesInFlight = 8;
+
+	/** Max number of items the batched visibility test traces in a single run, best scored first. Items past the cap fail the test. Zero traces every item */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "EQS", meta = (ClampMin = 0))
+	int32 MaxVisibilityTracesPerRun = 256;
+
+	/** Size of each influence map cell */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Influence Map", meta = (ClampMin = 10.0, Units = "cm"))
+	float InfluenceMapCellSize = 200.0f;
+
+	/** Number of influence map cells along each side. Rounded up to a multiple of 4 */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Influence Map", meta = (ClampMin = 4, ClampMax = 1024))
+	int32 InfluenceMapCells = 128;
+
+	/** World location of the center of the influence map */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Influence Map")
+	FVector2D InfluenceMapCenter = FVector2D::ZeroVector;
+
+	/** Time for influence to decay to half its strength */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Influence Map", meta = (ClampMin = 0.1, ClampMax = 60.0, Units = "s"))
+	float InfluenceHalfLife = 2.0f;
+
+	/** Fraction of a cell's influence that spreads to its neighbors each update */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Influence Map", meta = (ClampMin = 0.0, ClampMax = 1.0))
+	float InfluencePropagation = 0.8f;
+
+	/** Radius of influence splats, in cells */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Influence Map", meta = (ClampMin = 0, ClampMax = 32))
+	int32 InfluenceSplatRadius = 3;
+
+	/** Influence splatted at each player position every update */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Influence Map", meta = (ClampMin = 0.0))
+	float PlayerInfluence = 1.0f;
+
+	/** Influence splatted for the instigator's team at each shot or impact noise */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Influence Map", meta = (ClampMin = 0.0))
+	float ShotInfluence = 1.0f;
+
+	/** Influence splatted for every other team where a character dies */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Influence Map", meta = (ClampMin = 0.0))
+	float DeathInfluence = 2.0f;
+
+	/** Pairs of teams that are allied. Every other pair of different teams is hostile */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Teams")
+	TArray<FShooterTeamPair> AlliedTeams;
+
+	/** Time for a squad sighting to fade from its published confidence down to nothing */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Squad", meta = (ClampMin = 0.1, Units = "s"))
+	float SquadSightingLifetime = 5.0f;
+
+	/** Scale applied to the sight radius of squad followers, who rely on the squad for long range knowledge */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Squad", meta = (ClampMin = 0.0, ClampMax = 1.0))
+	float SquadFollowerSightRadiusScale = 0.5f;
+
+	/** Minimum interval between perception batches for squad followers */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Squad", meta = (ClampMin = 0.0, ClampMax = 5.0, Units = "s"))
+	float SquadFollowerPerceptionInterval = 0.5f;
+
+	/** Max distance between the goals of path requests that share a query */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Pathfinding", meta = (ClampMin = 0.0, Units = "cm"))
+	float PathShareGoalRadius = 250.0f;
+
+	/** Max distance between the starts of path requests that reuse a whole path */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Pathfinding", meta = (ClampMin = 0.0, Units = "cm"))
+	float PathShareStartRadius = 500.0f;
+
+	/** Max distance from a shared corridor for a request to path to it and follow it from there */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Pathfinding", meta = (ClampMin = 0.0, Units = "cm"))
+	float PathJoinRadius = 1000.0f;
+
+	/** Time a completed path can be reused by other NPCs */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Pathfinding", meta = (ClampMin = 0.0, ClampMax = 10.0, Units = "s"))
+	float PathResultLifetime = 2.0f;
+
+	/** Max number of async path queries started per frame across all AI */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Pathfinding", meta = (ClampMin = 1, ClampMax = 64))
+	int32 MaxPathQueryStartsPerFrame = 4;
+
+	/** Max number of async path queries running at once across all AI */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Pathfinding", meta = (ClampMin = 1, ClampMax = 256))
+	int32 MaxPathQueriesInFlight = 16;
+
+	/** If true, NPCs following a crowded shared corridor avoid each other through the crowd simulation. Disables partial corridor joins */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Pathfinding")
+	bool bEnableCrowdAvoidance = false;
+
+	/** Number of NPCs following the same corridor before they switch to crowd avoidance */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Pathfinding", meta = (ClampMin = 2, EditCondition = "bEnableCrowdAvoidance"))
+	int32 CrowdAvoidanceGroupSize = 4;
+
+	/** Interval between shooter sight sense updates */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Shooter Sight", meta = (ClampMin = 0.0, ClampMax = 1.0, Units = "s"))
+	float ShooterSightUpdateInterval = 0.1f;
+
+	/** Size of the grid cells shooter sight listeners are bucketed into */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Shooter Sight", meta = (ClampMin = 100.0, Units = "cm"))
+	float ShooterSightCellSize = 2500.0f;
+
+	/** Bots simulated as entities are promoted to full NPCs when they get this close to a player */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Hybrid LOD", meta = (ClampMin = 0.0, Units = "cm"))
+	float BotPromoteDistance = 8000.0f;
+
+	/** Out of combat NPCs managed by the hybrid LOD are demoted back to entities when they get this far from every player */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Hybrid LOD", meta = (ClampMin = 0.0, Units = "cm"))
+	float BotDemoteDistance = 10000.0f;
+
+	/** Interval between hybrid LOD promotion and demotion checks */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Hybrid LOD", meta = (ClampMin = 0.0, ClampMax = 5.0, Units = "s"))
+	float BotLODCheckInterval = 0.25f;
+
+	/** Max number of bots promoted to full NPCs per check, to spread out the spawn cost */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Hybrid LOD", meta = (ClampMin = 1))
+	int32 MaxBotPromotionsPerCheck = 4;
+
+	/** Radius around their home location that bot entities patrol */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Hybrid LOD", meta = (ClampMin = 0.0, Units = "cm"))
+	float BotPatrolRadius = 1500.0f;
+
+	/** Movement speed of bot entities */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Hybrid LOD", meta = (ClampMin = 0.0, Units = "cm/s"))
+	float BotMoveSpeed = 300.0f;
+
+	/** Bot entities hold position while the threat at their location is at least this high */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Hybrid LOD", meta = (ClampMin = 0.0, ClampMax = 1.0))
+	float BotHoldThreat = 0.5f;
+
+	/** Time the spawn director may spend spawning NPCs each frame. At least one NPC is always spawned */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Spawning", meta = (ClampMin = 0.0, Units = "ms"))
+	float SpawnBudgetMs = 2.0f;
+
+	/** Max number of NPCs the spawn director may spawn each frame */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Spawning", meta = (ClampMin = 1))
+	int32 MaxSpawnsPerFrame = 4;
+
+	/** Max number of NPC ragdolls simulating at once. The ones furthest from the players are frozen first */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Ragdolls", meta = (ClampMin = 0))
+	int32 MaxActiveRagdolls = 8;
+
+	/** Ragdolls simulate for at least this long before they can be put to sleep or frozen */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Ragdolls", meta = (ClampMin = 0.0, Units = "s"))
+	float RagdollMinSimTime = 0.5f;
+
+	/** Ragdolls are frozen after simulating this long, even if they haven't settled */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Ragdolls", meta = (ClampMin = 0.0, Units = "s"))
+	float RagdollMaxSimTime = 3.0f;
+
+	/** Ragdolls slower than this are put to sleep early, then frozen once every body is asleep */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Ragdolls", meta = (ClampMin = 0.0, Units = "cm/s"))
+	float RagdollSettleSpeed = 20.0f;
+
+	/** Number of spawn points rescored against enemy positions each frame */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Respawning", meta = (ClampMin = 1))
+	int32 SpawnPointsScoredPerFrame = 8;
+
+	/** Spawn points at least this far from every enemy are considered equally safe */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Respawning", meta = (ClampMin = 0.0, Units = "cm"))
+	float SpawnSafeDistance = 3000.0f;
+
+	/** Spawn points with any character this close are avoided, so respawns don't stack up */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Respawning", meta = (ClampMin = 0.0, Units = "cm"))
+	float SpawnBlockedRadius = 150.0f;
+
+	/** Distance taken off a spawn point's score per unit of enemy influence on it */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Respawning", meta = (ClampMin = 0.0, Units = "cm"))
+	float SpawnThreatPenalty = 1000.0f;
+
+	/** Time budget per frame for restoring actors when a round is reset in place */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Rounds", meta = (ClampMin = 0.1, Units = "ms"))
+	float RoundResetBudgetMs = 2.0f;
+
+	/** Returns the update rates for the given bucket */
+	const FShooterAILODSettings& GetLODSettings(EShooterAILOD LOD) const;
+};
@@ -0,0 +1,10 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/AISenseConfig_ShooterSight.h"
+#include "Variant_Shooter/AI/AISense_ShooterSight.h"
+
+TSubclassOf<UAISense> UAISenseConfig_ShooterSight::GetSenseImplementation() const
+{
+	return UAISense_ShooterSight::StaticClass();
+}
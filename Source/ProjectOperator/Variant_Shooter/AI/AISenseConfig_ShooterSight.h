@@ -0,0 +1,23 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Perception/AISenseConfig_Sight.h"
+#include "AISenseConfig_ShooterSight.generated.h"
+
+/**
+ *  Sight config for the shooter sight sense
+ *  Reuses the engine sight radii, view angle and affiliation filter, so code that
+ *  tunes the engine sight config at runtime works unchanged with either sense
+ */
+UCLASS(meta = (DisplayName = "AI Shooter Sight config"))
+class PROJECTOPERATOR_API UAISenseConfig_ShooterSight : public UAISenseConfig_Sight
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Returns the shooter sight sense class */
+	virtual TSubclassOf<UAISense> GetSenseImplementation() const override;
+};
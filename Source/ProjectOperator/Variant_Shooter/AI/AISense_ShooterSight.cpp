@@ -0,0 +1,315 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/AISense_ShooterSight.h"
+#include "Variant_Shooter/AI/ShooterLineOfSightSubsystem.h"
+#include "Variant_Shooter/AI/ShooterAIController.h"
+#include "Perception/AIPerceptionComponent.h"
+#include "Perception/AISenseConfig_Sight.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+#include "Settings/ShooterAISettings.h"
+#include "ProjectOperator.h"
+
+DECLARE_CYCLE_STAT(TEXT("Shooter Sight Update"), STAT_ShooterSightUpdate, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Shooter Sight Cone Tests"), STAT_ShooterSightConeTests, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Shooter Sight Occlusion Queries"), STAT_ShooterSightOcclusionQueries, STATGROUP_ShooterAI);
+
+void FShooterSightListenerBatch::Reset()
+{
+	Listeners.Reset();
+	X.Reset();
+	Y.Reset();
+	Z.Reset();
+	DirX.Reset();
+	DirY.Reset();
+	DirZ.Reset();
+	SightRadiusSq.Reset();
+	LoseSightRadiusSq.Reset();
+	CosHalfAngle.Reset();
+	CellRanges.Reset();
+	MaxRadius = 0.0f;
+}
+
+void FShooterSightListenerBatch::Add(FPerceptionListener* Listener, const FVector& Location, const FVector& Direction, float SightRadius, float LoseSightRadius, float HalfAngleDegrees)
+{
+	Listeners.Add(Listener);
+	X.Add(Location.X);
+	Y.Add(Location.Y);
+	Z.Add(Location.Z);
+	DirX.Add(Direction.X);
+	DirY.Add(Direction.Y);
+	DirZ.Add(Direction.Z);
+
+	// padding slots use a negative radius so they never pass the range test
+	SightRadiusSq.Add(SightRadius >= 0.0f ? FMath::Square(SightRadius) : -1.0f);
+	LoseSightRadiusSq.Add(LoseSightRadius >= 0.0f ? FMath::Square(LoseSightRadius) : -1.0f);
+	CosHalfAngle.Add(FMath::Cos(FMath::DegreesToRadians(HalfAngleDegrees)));
+
+	MaxRadius = FMath::Max(MaxRadius, LoseSightRadius);
+}
+
+UAISense_ShooterSight::UAISense_ShooterSight(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	// pawns register as sources as they spawn. We filter down to player pawns on update
+	bAutoRegisterAllPawnsAsSources = true;
+
+	// only notify listeners when a target is gained or lost
+	NotifyType = EAISenseNotifyType::OnPerceptionChange;
+
+	OnListenerRemovedDelegate.BindUObject(this, &UAISense_ShooterSight::OnListenerRemoved);
+}
+
+void UAISense_ShooterSight::RegisterSource(AActor& SourceActor)
+{
+	Sources.AddUnique(&SourceActor);
+}
+
+void UAISense_ShooterSight::UnregisterSource(AActor& SourceActor)
+{
+	Sources.Remove(&SourceActor);
+}
+
+float UAISense_ShooterSight::Update()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterSightUpdate);
+
+	const UShooterAISettings* Settings = GetDefault<UShooterAISettings>();
+
+	UShooterLineOfSightSubsystem* LineOfSight = UWorld::GetSubsystem<UShooterLineOfSightSubsystem>(GetWorld());
+
+	if (!LineOfSight)
+	{
+		return Settings->ShooterSightUpdateInterval;
+	}
+
+	TArray<AActor*> Targets;
+	GatherTargets(Targets);
+
+	BuildListenerBatch(Settings->ShooterSightCellSize, GetWorld()->GetTimeSeconds());
+
+	TSet<FShooterSightPair> NowSeen;
+
+	constexpr int32 Width = FShooterSightListenerBatch::Width;
+
+	for (AActor* Target : Targets)
+	{
+		const FVector TargetLocation = Target->GetActorLocation();
+		const FGenericTeamId TargetTeam = FGenericTeamId::GetTeamIdentifier(Target);
+
+		const VectorRegister4Float TX = VectorSetFloat1(TargetLocation.X);
+		const VectorRegister4Float TY = VectorSetFloat1(TargetLocation.Y);
+		const VectorRegister4Float TZ = VectorSetFloat1(TargetLocation.Z);
+
+		// only cells within reach of the farthest sighted listener can see the target
+		const FIntPoint MinCell = GetCell(TargetLocation - FVector(Batch.MaxRadius), Settings->ShooterSightCellSize);
+		const FIntPoint MaxCell = GetCell(TargetLocation + FVector(Batch.MaxRadius), Settings->ShooterSightCellSize);
+
+		for (int32 CellX = MinCell.X; CellX <= MaxCell.X; ++CellX)
+		{
+			for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; ++CellY)
+			{
+				const TPair<int32, int32>* Range = Batch.CellRanges.Find(FIntPoint(CellX, CellY));
+
+				if (!Range)
+				{
+					continue;
+				}
+
+				for (int32 Slot = Range->Key; Slot < Range->Value; Slot += Width)
+				{
+					INC_DWORD_STAT_BY(STAT_ShooterSightConeTests, Width);
+
+					const VectorRegister4Float DX = VectorSubtract(TX, VectorLoad(&Batch.X[Slot]));
+					const VectorRegister4Float DY = VectorSubtract(TY, VectorLoad(&Batch.Y[Slot]));
+					const VectorRegister4Float DZ = VectorSubtract(TZ, VectorLoad(&Batch.Z[Slot]));
+
+					const VectorRegister4Float DistanceSq = VectorMultiplyAdd(DX, DX, VectorMultiplyAdd(DY, DY, VectorMultiply(DZ, DZ)));
+					const VectorRegister4Float Dot = VectorMultiplyAdd(DX, VectorLoad(&Batch.DirX[Slot]), VectorMultiplyAdd(DY, VectorLoad(&Batch.DirY[Slot]), VectorMultiply(DZ, VectorLoad(&Batch.DirZ[Slot]))));
+
+					// the target is inside the cone if the angle to it is within the half angle
+					const VectorRegister4Float InCone = VectorCompareGE(Dot, VectorMultiply(VectorLoad(&Batch.CosHalfAngle[Slot]), VectorSqrt(DistanceSq)));
+
+					const int32 SightMask = VectorMaskBits(VectorBitwiseAnd(InCone, VectorCompareLE(DistanceSq, VectorLoad(&Batch.SightRadiusSq[Slot]))));
+					const int32 LoseSightMask = VectorMaskBits(VectorBitwiseAnd(InCone, VectorCompareLE(DistanceSq, VectorLoad(&Batch.LoseSightRadiusSq[Slot]))));
+
+					if (LoseSightMask == 0)
+					{
+						continue;
+					}
+
+					for (int32 Lane = 0; Lane < Width; ++Lane)
+					{
+						FPerceptionListener* Listener = Batch.Listeners[Slot + Lane];
+
+						if (!Listener || (LoseSightMask & (1 << Lane)) == 0)
+						{
+							continue;
+						}
+
+						const FShooterSightPair Pair { Listener->Listener, Target };
+						const bool bWasSeen = SeenPairs.Contains(Pair);
+
+						// targets already seen are kept up to the lose sight radius
+						if (!bWasSeen && (SightMask & (1 << Lane)) == 0)
+						{
+							continue;
+						}
+
+						const UAISenseConfig_Sight* SightConfig = Cast<const UAISenseConfig_Sight>(Listener->Listener->GetSenseConfig(GetSenseID()));
+
+						if (!FAISenseAffiliationFilter::ShouldSenseTeam(Listener->GetTeamIdentifier(), TargetTeam, SightConfig->DetectionByAffiliation.GetAsFlags()))
+						{
+							continue;
+						}
+
+						INC_DWORD_STAT(STAT_ShooterSightOcclusionQueries);
+
+						// read the cached verdict. Stale pairs are refreshed under the shared trace budget
+						if (!LineOfSight->QueryLineOfSight(Listener->GetBodyActor(), Target))
+						{
+							continue;
+						}
+
+						NowSeen.Add(Pair);
+
+						if (!bWasSeen)
+						{
+							Listener->RegisterStimulus(Target, FAIStimulus(*this, 1.0f, TargetLocation, Listener->CachedLocation));
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// report every target that dropped out of sight
+	AIPerception::FListenerMap& ListenersMap = *GetListeners();
+
+	for (const FShooterSightPair& Pair : SeenPairs)
+	{
+		if (NowSeen.Contains(Pair) || !Pair.Listener.IsValid() || !Pair.Target.IsValid())
+		{
+			continue;
+		}
+
+		// listeners that weren't due for an update keep seeing what they saw
+		if (SkippedListeners.Contains(Pair.Listener))
+		{
+			NowSeen.Add(Pair);
+			continue;
+		}
+
+		FPerceptionListener* Listener = ListenersMap.Find(Pair.Listener->GetListenerId());
+
+		if (Listener && Listener->HasSense(GetSenseID()))
+		{
+			Listener->RegisterStimulus(Pair.Target.Get(), FAIStimulus(*this, 0.0f, Pair.Target->GetActorLocation(), Listener->CachedLocation, FAIStimulus::SensingFailed));
+		}
+	}
+
+	SeenPairs = MoveTemp(NowSeen);
+
+	return Settings->ShooterSightUpdateInterval;
+}
+
+void UAISense_ShooterSight::OnListenerRemoved(const FPerceptionListener& Listener)
+{
+	ListenerNextUpdateTimes.Remove(Listener.Listener);
+
+	for (auto It = SeenPairs.CreateIterator(); It; ++It)
+	{
+		if (It->Listener == Listener.Listener)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void UAISense_ShooterSight::GatherTargets(TArray<AActor*>& OutTargets) const
+{
+	for (const TWeakObjectPtr<AActor>& Source : Sources)
+	{
+		const APawn* Pawn = Cast<APawn>(Source.Get());
+
+		if (Pawn && Pawn->IsPlayerControlled())
+		{
+			OutTargets.Add(Source.Get());
+		}
+	}
+}
+
+void UAISense_ShooterSight::BuildListenerBatch(float CellSize, double Now)
+{
+	Batch.Reset();
+	SkippedListeners.Reset();
+
+	// gather the listeners with this sense enabled, along with their cell
+	TArray<TPair<FIntPoint, FPerceptionListener*>> Sorted;
+
+	for (TPair<FPerceptionListenerID, FPerceptionListener>& Pair : *GetListeners())
+	{
+		FPerceptionListener& Listener = Pair.Value;
+
+		if (!Listener.HasSense(GetSenseID()) || !Listener.Listener.IsValid() || !Listener.GetBodyActor())
+		{
+			continue;
+		}
+
+		// skip listeners whose LOD bucket doesn't want an update yet
+		double& NextUpdateTime = ListenerNextUpdateTimes.FindOrAdd(Listener.Listener, 0.0);
+
+		if (Now < NextUpdateTime)
+		{
+			SkippedListeners.Add(Listener.Listener);
+			continue;
+		}
+
+		const AShooterAIController* Controller = Cast<AShooterAIController>(Listener.Listener->GetOwner());
+		NextUpdateTime = Now + (Controller ? Controller->GetSightUpdateInterval() : 0.0f);
+
+		Sorted.Emplace(GetCell(Listener.CachedLocation, CellSize), &Listener);
+	}
+
+	// group the listeners by cell
+	Sorted.Sort([](const TPair<FIntPoint, FPerceptionListener*>& A, const TPair<FIntPoint, FPerceptionListener*>& B)
+	{
+		return A.Key.X != B.Key.X ? A.Key.X < B.Key.X : A.Key.Y < B.Key.Y;
+	});
+
+	for (int32 Index = 0; Index < Sorted.Num(); ++Index)
+	{
+		const FIntPoint Cell = Sorted[Index].Key;
+		FPerceptionListener* Listener = Sorted[Index].Value;
+
+		// open a new cell run
+		if (Index == 0 || Sorted[Index - 1].Key != Cell)
+		{
+			Batch.CellRanges.Add(Cell, TPair<int32, int32>(Batch.Listeners.Num(), Batch.Listeners.Num()));
+		}
+
+		const UAISenseConfig_Sight* SightConfig = Cast<const UAISenseConfig_Sight>(Listener->Listener->GetSenseConfig(GetSenseID()));
+
+		if (SightConfig)
+		{
+			Batch.Add(Listener, Listener->CachedLocation, Listener->CachedDirection, SightConfig->SightRadius, SightConfig->LoseSightRadius, SightConfig->PeripheralVisionAngleDegrees);
+		}
+
+		// close the cell run, padded to the SIMD width
+		if (Index == Sorted.Num() - 1 || Sorted[Index + 1].Key != Cell)
+		{
+			while (Batch.Listeners.Num() % FShooterSightListenerBatch::Width != 0)
+			{
+				Batch.Add(nullptr, FVector::ZeroVector, FVector::ForwardVector, -1.0f, -1.0f, 0.0f);
+			}
+
+			Batch.CellRanges[Cell].Value = Batch.Listeners.Num();
+		}
+	}
+}
+
+FIntPoint UAISense_ShooterSight::GetCell(const FVector& Location, float CellSize)
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
@@ -0,0 +1,134 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Perception/AISense.h"
+#include "AISense_ShooterSight.generated.h"
+
+class UAIPerceptionComponent;
+struct FPerceptionListener;
+
+/**
+ *  Identifies a listener currently seeing a target
+ */
+struct FShooterSightPair
+{
+	/** Perception component doing the looking */
+	TWeakObjectPtr<UAIPerceptionComponent> Listener;
+
+	/** Actor being seen */
+	TWeakObjectPtr<AActor> Target;
+
+	bool operator==(const FShooterSightPair& Other) const
+	{
+		return Listener == Other.Listener && Target == Other.Target;
+	}
+
+	friend uint32 GetTypeHash(const FShooterSightPair& Pair)
+	{
+		return HashCombine(GetTypeHash(Pair.Listener), GetTypeHash(Pair.Target));
+	}
+};
+
+/**
+ *  Listener view cones laid out as contiguous per-field arrays for SIMD evaluation
+ *  Listeners are grouped by grid cell, and every cell run is padded to the SIMD width
+ *  with lanes that can never pass the range test
+ */
+struct FShooterSightListenerBatch
+{
+	/** Number of floats processed per SIMD operation */
+	static constexpr int32 Width = 4;
+
+	/** Listener for each slot. Null for padding slots */
+	TArray<FPerceptionListener*> Listeners;
+
+	/** Eye locations */
+	TArray<float> X;
+	TArray<float> Y;
+	TArray<float> Z;
+
+	/** View directions */
+	TArray<float> DirX;
+	TArray<float> DirY;
+	TArray<float> DirZ;
+
+	/** Squared radius to start seeing a target */
+	TArray<float> SightRadiusSq;
+
+	/** Squared radius to keep seeing a target */
+	TArray<float> LoseSightRadiusSq;
+
+	/** Cosine of the peripheral vision half angle */
+	TArray<float> CosHalfAngle;
+
+	/** Slot range for each occupied grid cell */
+	TMap<FIntPoint, TPair<int32, int32>> CellRanges;
+
+	/** Largest lose sight radius of any listener */
+	float MaxRadius = 0.0f;
+
+	/** Empties the batch, keeping the allocations */
+	void Reset();
+
+	/** Appends a slot */
+	void Add(FPerceptionListener* Listener, const FVector& Location, const FVector& Direction, float SightRadius, float LoseSightRadius, float HalfAngleDegrees);
+};
+
+/**
+ *  Sight sense tuned for a few player targets against many NPC listeners
+ *  Listeners are bucketed in a spatial grid and tested against each target one cell at a time
+ *  with SIMD view cone checks. Occlusion is resolved through the shared, budgeted line of sight cache
+ *  Results are registered as regular stimuli and reach controllers through OnTargetPerceptionUpdated
+ */
+UCLASS(ClassGroup = AI, Config = Game)
+class PROJECTOPERATOR_API UAISense_ShooterSight : public UAISense
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Registered stimuli sources. Only the player controlled pawns among them are sensed */
+	TArray<TWeakObjectPtr<AActor>> Sources;
+
+	/** Listeners currently seeing each target */
+	TSet<FShooterSightPair> SeenPairs;
+
+	/** Listener view cones, rebuilt on every update */
+	FShooterSightListenerBatch Batch;
+
+	/** Game time each listener is next due for an update, following its controller's LOD bucket */
+	TMap<TWeakObjectPtr<UAIPerceptionComponent>, double> ListenerNextUpdateTimes;
+
+	/** Listeners skipped this update because they aren't due yet. Their pairs are kept as they were */
+	TSet<TWeakObjectPtr<UAIPerceptionComponent>> SkippedListeners;
+
+public:
+
+	/** Constructor */
+	UAISense_ShooterSight(const FObjectInitializer& ObjectInitializer);
+
+	/** Adds a stimuli source */
+	virtual void RegisterSource(AActor& SourceActor) override;
+
+	/** Removes a stimuli source */
+	virtual void UnregisterSource(AActor& SourceActor) override;
+
+protected:
+
+	/** Evaluates every listener against every player target. Returns the time until the next update */
+	virtual float Update() override;
+
+	/** Drops the pairs of a removed listener */
+	void OnListenerRemoved(const FPerceptionListener& Listener);
+
+	/** Gathers the sources that are currently player controlled */
+	void GatherTargets(TArray<AActor*>& OutTargets) const;
+
+	/** Rebuilds the listener batch from the listeners due for an update, grouped by grid cell */
+	void BuildListenerBatch(float CellSize, double Now);
+
+	/** Returns the grid cell containing the given location */
+	static FIntPoint GetCell(const FVector& Location, float CellSize);
+};
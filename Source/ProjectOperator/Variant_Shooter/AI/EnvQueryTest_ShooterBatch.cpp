@@ -0,0 +1,93 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/EnvQueryTest_ShooterBatch.h"
+#include "EnvironmentQuery/Items/EnvQueryItemType_VectorBase.h"
+#include "ProjectOperator.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("EQS Batched Items"), STAT_ShooterEQSBatchedItems, STATGROUP_ShooterAI);
+
+UEnvQueryTest_ShooterBatch::UEnvQueryTest_ShooterBatch(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	Cost = EEnvTestCost::Low;
+	ValidItemType = UEnvQueryItemType_VectorBase::StaticClass();
+	SetWorkOnFloatValues(true);
+}
+
+void UEnvQueryTest_ShooterBatch::RunTest(FEnvQueryInstance& QueryInstance) const
+{
+	UObject* QueryOwner = QueryInstance.Owner.Get();
+
+	if (!QueryOwner)
+	{
+		return;
+	}
+
+	// resolve the thresholds for this query
+	FloatValueMin.BindData(QueryOwner, QueryInstance.QueryID);
+	FloatValueMax.BindData(QueryOwner, QueryInstance.QueryID);
+
+	FShooterEnvQueryItemBatch Batch;
+	GatherItems(QueryInstance, Batch);
+
+	TArray<float> Scores;
+	Scores.SetNumZeroed(Batch.NumPadded());
+
+	ScoreBatch(QueryInstance, Batch, Scores);
+
+	INC_DWORD_STAT_BY(STAT_ShooterEQSBatchedItems, Batch.Num());
+
+	ApplyScores(QueryInstance, Batch, Scores, FloatValueMin.GetValue(), FloatValueMax.GetValue());
+}
+
+void UEnvQueryTest_ShooterBatch::GatherItems(FEnvQueryInstance& QueryInstance, FShooterEnvQueryItemBatch& OutBatch) const
+{
+	OutBatch.ItemIndices.Reserve(QueryInstance.Items.Num());
+
+	for (int32 i = 0; i < QueryInstance.Items.Num(); ++i)
+	{
+		if (QueryInstance.Items[i].IsValid())
+		{
+			OutBatch.ItemIndices.Add(i);
+		}
+	}
+
+	// pad the component arrays so every SIMD load is in bounds
+	const int32 NumPadded = Align(OutBatch.Num(), FShooterEnvQueryItemBatch::Width);
+
+	OutBatch.X.SetNumZeroed(NumPadded);
+	OutBatch.Y.SetNumZeroed(NumPadded);
+	OutBatch.Z.SetNumZeroed(NumPadded);
+
+	for (int32 Slot = 0; Slot < OutBatch.Num(); ++Slot)
+	{
+		const FVector Location = GetItemLocation(QueryInstance, OutBatch.ItemIndices[Slot]);
+
+		OutBatch.X[Slot] = Location.X;
+		OutBatch.Y[Slot] = Location.Y;
+		OutBatch.Z[Slot] = Location.Z;
+	}
+}
+
+void UEnvQueryTest_ShooterBatch::ApplyScores(FEnvQueryInstance& QueryInstance, const FShooterEnvQueryItemBatch& Batch, const TArray<float>& Scores, float MinThreshold, float MaxThreshold) const
+{
+	// the whole batch is already scored, so there's nothing to gain from time slicing the write back
+	FEnvQueryInstance::ItemIterator It(this, QueryInstance);
+	It.IgnoreTimeLimit();
+
+	int32 Slot = 0;
+
+	for (; It; ++It)
+	{
+		// the iterator visits valid items in index order, same as the batch
+		while (Slot < Batch.Num() && Batch.ItemIndices[Slot] < It.GetIndex())
+		{
+			++Slot;
+		}
+
+		const float Score = Slot < Batch.Num() && Batch.ItemIndices[Slot] == It.GetIndex() ? Scores[Slot] : 0.0f;
+
+		It.SetScore(TestPurpose, FilterType, Score, MinThreshold, MaxThreshold);
+	}
+}
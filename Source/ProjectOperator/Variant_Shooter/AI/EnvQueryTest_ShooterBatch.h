@@ -0,0 +1,60 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnvironmentQuery/EnvQueryTest.h"
+#include "EnvQueryTest_ShooterBatch.generated.h"
+
+/**
+ *  Item locations laid out as contiguous per-axis arrays for SIMD scoring
+ *  Arrays are padded to a multiple of the SIMD width. Padding lanes are scored and ignored
+ */
+struct FShooterEnvQueryItemBatch
+{
+	/** Number of floats processed per SIMD operation */
+	static constexpr int32 Width = 4;
+
+	/** Query item index for each batch slot */
+	TArray<int32> ItemIndices;
+
+	/** Item location components */
+	TArray<float> X;
+	TArray<float> Y;
+	TArray<float> Z;
+
+	/** Returns the number of real items in the batch */
+	int32 Num() const { return ItemIndices.Num(); }
+
+	/** Returns the padded length of the component arrays */
+	int32 NumPadded() const { return X.Num(); }
+};
+
+/**
+ *  Base class for shooter EQS tests that score every item in one contiguous SIMD pass
+ *  instead of evaluating items one at a time through the item iterator
+ */
+UCLASS(Abstract)
+class PROJECTOPERATOR_API UEnvQueryTest_ShooterBatch : public UEnvQueryTest
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Constructor */
+	UEnvQueryTest_ShooterBatch(const FObjectInitializer& ObjectInitializer);
+
+protected:
+
+	/** Runs the test over every item */
+	virtual void RunTest(FEnvQueryInstance& QueryInstance) const override;
+
+	/** Fills OutScores with one score per padded batch slot */
+	virtual void ScoreBatch(FEnvQueryInstance& QueryInstance, const FShooterEnvQueryItemBatch& Batch, TArray<float>& OutScores) const PURE_VIRTUAL(UEnvQueryTest_ShooterBatch::ScoreBatch, );
+
+	/** Copies the location of every valid item into the batch */
+	void GatherItems(FEnvQueryInstance& QueryInstance, FShooterEnvQueryItemBatch& OutBatch) const;
+
+	/** Applies the batch scores to the items, filtering and scoring as configured */
+	void ApplyScores(FEnvQueryInstance& QueryInstance, const FShooterEnvQueryItemBatch& Batch, const TArray<float>& Scores, float MinThreshold, float MaxThreshold) const;
+};
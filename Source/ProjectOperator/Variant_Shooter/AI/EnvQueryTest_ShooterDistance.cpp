@@ -0,0 +1,61 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/EnvQueryTest_ShooterDistance.h"
+#include "EnvironmentQuery/Contexts/EnvQueryContext_Querier.h"
+#include "ProjectOperator.h"
+
+DECLARE_CYCLE_STAT(TEXT("EQS Batched Distance"), STAT_ShooterEQSDistance, STATGROUP_ShooterAI);
+
+UEnvQueryTest_ShooterDistance::UEnvQueryTest_ShooterDistance(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	DistanceTo = UEnvQueryContext_Querier::StaticClass();
+}
+
+void UEnvQueryTest_ShooterDistance::ScoreBatch(FEnvQueryInstance& QueryInstance, const FShooterEnvQueryItemBatch& Batch, TArray<float>& OutScores) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterEQSDistance);
+
+	TArray<FVector> ContextLocations;
+
+	if (!QueryInstance.PrepareContext(DistanceTo, ContextLocations) || ContextLocations.IsEmpty())
+	{
+		return;
+	}
+
+	const VectorRegister4Float ZScale = VectorSetFloat1(bWorkIn2D ? 0.0f : 1.0f);
+
+	for (int32 Slot = 0; Slot < Batch.NumPadded(); Slot += FShooterEnvQueryItemBatch::Width)
+	{
+		const VectorRegister4Float X = VectorLoad(&Batch.X[Slot]);
+		const VectorRegister4Float Y = VectorLoad(&Batch.Y[Slot]);
+		const VectorRegister4Float Z = VectorLoad(&Batch.Z[Slot]);
+
+		VectorRegister4Float MinDistSquared = VectorSetFloat1(UE_MAX_FLT);
+
+		// keep the distance to the nearest context location
+		for (const FVector& ContextLocation : ContextLocations)
+		{
+			const VectorRegister4Float DX = VectorSubtract(X, VectorSetFloat1(ContextLocation.X));
+			const VectorRegister4Float DY = VectorSubtract(Y, VectorSetFloat1(ContextLocation.Y));
+			const VectorRegister4Float DZ = VectorMultiply(VectorSubtract(Z, VectorSetFloat1(ContextLocation.Z)), ZScale);
+
+			const VectorRegister4Float DistSquared = VectorMultiplyAdd(DX, DX, VectorMultiplyAdd(DY, DY, VectorMultiply(DZ, DZ)));
+
+			MinDistSquared = VectorMin(MinDistSquared, DistSquared);
+		}
+
+		VectorStore(VectorSqrt(MinDistSquared), &OutScores[Slot]);
+	}
+}
+
+FText UEnvQueryTest_ShooterDistance::GetDescriptionTitle() const
+{
+	return FText::FromString(FString::Printf(TEXT("%s%s: to %s"), *Super::GetDescriptionTitle().ToString(), bWorkIn2D ? TEXT(" 2D") : TEXT(""), *UEnvQueryTypes::DescribeContext(DistanceTo).ToString()));
+}
+
+FText UEnvQueryTest_ShooterDistance::GetDescriptionDetails() const
+{
+	return DescribeFloatTestParams();
+}
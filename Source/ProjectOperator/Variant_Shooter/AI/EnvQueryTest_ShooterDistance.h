@@ -0,0 +1,44 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnvQueryTest_ShooterBatch.h"
+#include "EnvQueryTest_ShooterDistance.generated.h"
+
+class UEnvQueryContext;
+
+/**
+ *  Batched EQS test that scores items by distance to the nearest context location
+ */
+UCLASS(meta = (DisplayName = "Shooter Distance (Batched)"))
+class PROJECTOPERATOR_API UEnvQueryTest_ShooterDistance : public UEnvQueryTest_ShooterBatch
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Context to measure distance to */
+	UPROPERTY(EditDefaultsOnly, Category = "Distance")
+	TSubclassOf<UEnvQueryContext> DistanceTo;
+
+	/** If true, height differences are ignored */
+	UPROPERTY(EditDefaultsOnly, Category = "Distance")
+	bool bWorkIn2D = false;
+
+public:
+
+	/** Constructor */
+	UEnvQueryTest_ShooterDistance(const FObjectInitializer& ObjectInitializer);
+
+protected:
+
+	/** Scores the batch by distance */
+	virtual void ScoreBatch(FEnvQueryInstance& QueryInstance, const FShooterEnvQueryItemBatch& Batch, TArray<float>& OutScores) const override;
+
+	/** Returns the test title for the EQS editor */
+	virtual FText GetDescriptionTitle() const override;
+
+	/** Returns the test details for the EQS editor */
+	virtual FText GetDescriptionDetails() const override;
+};
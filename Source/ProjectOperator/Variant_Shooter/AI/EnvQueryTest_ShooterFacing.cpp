@@ -0,0 +1,60 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/EnvQueryTest_ShooterFacing.h"
+#include "Variant_Shooter/AI/EnvQueryContext_Target.h"
+#include "ProjectOperator.h"
+
+DECLARE_CYCLE_STAT(TEXT("EQS Batched Facing"), STAT_ShooterEQSFacing, STATGROUP_ShooterAI);
+
+UEnvQueryTest_ShooterFacing::UEnvQueryTest_ShooterFacing(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	FacingFrom = UEnvQueryContext_Target::StaticClass();
+}
+
+void UEnvQueryTest_ShooterFacing::ScoreBatch(FEnvQueryInstance& QueryInstance, const FShooterEnvQueryItemBatch& Batch, TArray<float>& OutScores) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterEQSFacing);
+
+	FVector ContextLocation;
+	FRotator ContextRotation;
+
+	if (!QueryInstance.PrepareContext(FacingFrom, ContextLocation) || !QueryInstance.PrepareContext(FacingFrom, ContextRotation))
+	{
+		return;
+	}
+
+	FVector Forward = ContextRotation.Vector();
+
+	if (bWorkIn2D)
+	{
+		Forward = Forward.GetSafeNormal2D();
+	}
+
+	const VectorRegister4Float ZScale = VectorSetFloat1(bWorkIn2D ? 0.0f : 1.0f);
+	const VectorRegister4Float Epsilon = VectorSetFloat1(UE_SMALL_NUMBER);
+
+	for (int32 Slot = 0; Slot < Batch.NumPadded(); Slot += FShooterEnvQueryItemBatch::Width)
+	{
+		const VectorRegister4Float DX = VectorSubtract(VectorLoad(&Batch.X[Slot]), VectorSetFloat1(ContextLocation.X));
+		const VectorRegister4Float DY = VectorSubtract(VectorLoad(&Batch.Y[Slot]), VectorSetFloat1(ContextLocation.Y));
+		const VectorRegister4Float DZ = VectorMultiply(VectorSubtract(VectorLoad(&Batch.Z[Slot]), VectorSetFloat1(ContextLocation.Z)), ZScale);
+
+		// dot product with the forward vector, divided by the length of the direction
+		const VectorRegister4Float Dot = VectorMultiplyAdd(DX, VectorSetFloat1(Forward.X), VectorMultiplyAdd(DY, VectorSetFloat1(Forward.Y), VectorMultiply(DZ, VectorSetFloat1(Forward.Z))));
+		const VectorRegister4Float LengthSquared = VectorMultiplyAdd(DX, DX, VectorMultiplyAdd(DY, DY, VectorMultiplyAdd(DZ, DZ, Epsilon)));
+
+		VectorStore(VectorMultiply(Dot, VectorReciprocalSqrt(LengthSquared)), &OutScores[Slot]);
+	}
+}
+
+FText UEnvQueryTest_ShooterFacing::GetDescriptionTitle() const
+{
+	return FText::FromString(FString::Printf(TEXT("%s%s: in front of %s"), *Super::GetDescriptionTitle().ToString(), bWorkIn2D ? TEXT(" 2D") : TEXT(""), *UEnvQueryTypes::DescribeContext(FacingFrom).ToString()));
+}
+
+FText UEnvQueryTest_ShooterFacing::GetDescriptionDetails() const
+{
+	return DescribeFloatTestParams();
+}
@@ -0,0 +1,45 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnvQueryTest_ShooterBatch.h"
+#include "EnvQueryTest_ShooterFacing.generated.h"
+
+class UEnvQueryContext;
+
+/**
+ *  Batched EQS test that scores items by the dot product between a context's facing and the direction to the item
+ *  1 is straight ahead of the context, -1 is straight behind it
+ */
+UCLASS(meta = (DisplayName = "Shooter Facing Dot (Batched)"))
+class PROJECTOPERATOR_API UEnvQueryTest_ShooterFacing : public UEnvQueryTest_ShooterBatch
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Context whose location and facing are used. Only its first location and rotation are used */
+	UPROPERTY(EditDefaultsOnly, Category = "Facing")
+	TSubclassOf<UEnvQueryContext> FacingFrom;
+
+	/** If true, height differences are ignored */
+	UPROPERTY(EditDefaultsOnly, Category = "Facing")
+	bool bWorkIn2D = true;
+
+public:
+
+	/** Constructor */
+	UEnvQueryTest_ShooterFacing(const FObjectInitializer& ObjectInitializer);
+
+protected:
+
+	/** Scores the batch by facing dot product */
+	virtual void ScoreBatch(FEnvQueryInstance& QueryInstance, const FShooterEnvQueryItemBatch& Batch, TArray<float>& OutScores) const override;
+
+	/** Returns the test title for the EQS editor */
+	virtual FText GetDescriptionTitle() const override;
+
+	/** Returns the test details for the EQS editor */
+	virtual FText GetDescriptionDetails() const override;
+};
@@ -0,0 +1,50 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/EnvQueryTest_ShooterHeight.h"
+#include "Variant_Shooter/AI/EnvQueryContext_Target.h"
+#include "ProjectOperator.h"
+
+DECLARE_CYCLE_STAT(TEXT("EQS Batched Height"), STAT_ShooterEQSHeight, STATGROUP_ShooterAI);
+
+UEnvQueryTest_ShooterHeight::UEnvQueryTest_ShooterHeight(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	HeightFrom = UEnvQueryContext_Target::StaticClass();
+}
+
+void UEnvQueryTest_ShooterHeight::ScoreBatch(FEnvQueryInstance& QueryInstance, const FShooterEnvQueryItemBatch& Batch, TArray<float>& OutScores) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterEQSHeight);
+
+	FVector ContextLocation;
+
+	if (!QueryInstance.PrepareContext(HeightFrom, ContextLocation))
+	{
+		return;
+	}
+
+	const VectorRegister4Float ContextZ = VectorSetFloat1(ContextLocation.Z);
+
+	for (int32 Slot = 0; Slot < Batch.NumPadded(); Slot += FShooterEnvQueryItemBatch::Width)
+	{
+		VectorRegister4Float Height = VectorSubtract(VectorLoad(&Batch.Z[Slot]), ContextZ);
+
+		if (bAbsolute)
+		{
+			Height = VectorAbs(Height);
+		}
+
+		VectorStore(Height, &OutScores[Slot]);
+	}
+}
+
+FText UEnvQueryTest_ShooterHeight::GetDescriptionTitle() const
+{
+	return FText::FromString(FString::Printf(TEXT("%s%s: from %s"), *Super::GetDescriptionTitle().ToString(), bAbsolute ? TEXT(" absolute") : TEXT(""), *UEnvQueryTypes::DescribeContext(HeightFrom).ToString()));
+}
+
+FText UEnvQueryTest_ShooterHeight::GetDescriptionDetails() const
+{
+	return DescribeFloatTestParams();
+}
@@ -0,0 +1,44 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnvQueryTest_ShooterBatch.h"
+#include "EnvQueryTest_ShooterHeight.generated.h"
+
+class UEnvQueryContext;
+
+/**
+ *  Batched EQS test that scores items by their height above a context location
+ */
+UCLASS(meta = (DisplayName = "Shooter Height (Batched)"))
+class PROJECTOPERATOR_API UEnvQueryTest_ShooterHeight : public UEnvQueryTest_ShooterBatch
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Context to measure height from. Only its first location is used */
+	UPROPERTY(EditDefaultsOnly, Category = "Height")
+	TSubclassOf<UEnvQueryContext> HeightFrom;
+
+	/** If true, items below the context score the same as items above it */
+	UPROPERTY(EditDefaultsOnly, Category = "Height")
+	bool bAbsolute = false;
+
+public:
+
+	/** Constructor */
+	UEnvQueryTest_ShooterHeight(const FObjectInitializer& ObjectInitializer);
+
+protected:
+
+	/** Scores the batch by height difference */
+	virtual void ScoreBatch(FEnvQueryInstance& QueryInstance, const FShooterEnvQueryItemBatch& Batch, TArray<float>& OutScores) const override;
+
+	/** Returns the test title for the EQS editor */
+	virtual FText GetDescriptionTitle() const override;
+
+	/** Returns the test details for the EQS editor */
+	virtual FText GetDescriptionDetails() const override;
+};
@@ -0,0 +1,42 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/EnvQueryTest_ShooterThreat.h"
+#include "Variant_Shooter/AI/ShooterInfluenceMapSubsystem.h"
+#include "GameFramework/Controller.h"
+#include "Engine/World.h"
+#include "ProjectOperator.h"
+
+DECLARE_CYCLE_STAT(TEXT("EQS Batched Threat"), STAT_ShooterEQSThreat, STATGROUP_ShooterAI);
+
+void UEnvQueryTest_ShooterThreat::ScoreBatch(FEnvQueryInstance& QueryInstance, const FShooterEnvQueryItemBatch& Batch, TArray<float>& OutScores) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterEQSThreat);
+
+	UShooterInfluenceMapSubsystem* InfluenceMap = UWorld::GetSubsystem<UShooterInfluenceMapSubsystem>(QueryInstance.World);
+
+	// queries are usually owned by the controller, so look at its pawn for the team
+	const AActor* Querier = Cast<AActor>(QueryInstance.Owner.Get());
+
+	if (const AController* Controller = Cast<AController>(Querier))
+	{
+		Querier = Controller->GetPawn();
+	}
+
+	uint8 Team;
+
+	if (!InfluenceMap || !UShooterInfluenceMapSubsystem::GetActorTeam(Querier, Team))
+	{
+		return;
+	}
+
+	for (int32 Slot = 0; Slot < Batch.Num(); ++Slot)
+	{
+		OutScores[Slot] = InfluenceMap->GetThreat(Team, FVector(Batch.X[Slot], Batch.Y[Slot], Batch.Z[Slot]));
+	}
+}
+
+FText UEnvQueryTest_ShooterThreat::GetDescriptionDetails() const
+{
+	return DescribeFloatTestParams();
+}
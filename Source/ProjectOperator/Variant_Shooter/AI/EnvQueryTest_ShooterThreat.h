@@ -0,0 +1,24 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnvQueryTest_ShooterBatch.h"
+#include "EnvQueryTest_ShooterThreat.generated.h"
+
+/**
+ *  Batched EQS test that scores items by the influence map threat to the querier's team
+ */
+UCLASS(meta = (DisplayName = "Shooter Threat (Batched)"))
+class PROJECTOPERATOR_API UEnvQueryTest_ShooterThreat : public UEnvQueryTest_ShooterBatch
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Scores the batch by threat */
+	virtual void ScoreBatch(FEnvQueryInstance& QueryInstance, const FShooterEnvQueryItemBatch& Batch, TArray<float>& OutScores) const override;
+
+	/** Returns the test details for the EQS editor */
+	virtual FText GetDescriptionDetails() const override;
+};
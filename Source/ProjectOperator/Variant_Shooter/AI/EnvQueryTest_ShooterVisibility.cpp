@@ -0,0 +1,146 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/EnvQueryTest_ShooterVisibility.h"
+#include "Variant_Shooter/AI/EnvQueryContext_Target.h"
+#include "Settings/ShooterAISettings.h"
+#include "EnvironmentQuery/Items/EnvQueryItemType_VectorBase.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "ProjectOperator.h"
+
+DECLARE_CYCLE_STAT(TEXT("EQS Batched Visibility"), STAT_ShooterEQSVisibility, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("EQS Visibility Traces"), STAT_ShooterEQSVisibilityTraces, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("EQS Visibility Traces Skipped"), STAT_ShooterEQSVisibilitySkipped, STATGROUP_ShooterAI);
+
+UEnvQueryTest_ShooterVisibility::UEnvQueryTest_ShooterVisibility(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	Cost = EEnvTestCost::High;
+	ValidItemType = UEnvQueryItemType_VectorBase::StaticClass();
+	SetWorkOnFloatValues(false);
+
+	TraceFrom = UEnvQueryContext_Target::StaticClass();
+
+	// pass items that are visible from the context by default
+	BoolValue.DefaultValue = true;
+}
+
+void UEnvQueryTest_ShooterVisibility::RunTest(FEnvQueryInstance& QueryInstance) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterEQSVisibility);
+
+	UObject* QueryOwner = QueryInstance.Owner.Get();
+	UWorld* World = QueryInstance.World;
+
+	if (!QueryOwner || !World)
+	{
+		return;
+	}
+
+	BoolValue.BindData(QueryOwner, QueryInstance.QueryID);
+	const bool bWantsVisible = BoolValue.GetValue();
+
+	TArray<AActor*> ContextActors;
+	QueryInstance.PrepareContext(TraceFrom, ContextActors);
+
+	FVector ContextLocation;
+
+	if (!QueryInstance.PrepareContext(TraceFrom, ContextLocation))
+	{
+		return;
+	}
+
+	const FVector TraceStart = ContextLocation + FVector(0.0f, 0.0f, ContextHeightOffset);
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ShooterEQSVisibility), false);
+	QueryParams.AddIgnoredActors(ContextActors);
+
+	// order the valid items by the score accumulated from earlier tests, best first
+	TArray<int32> Order;
+	Order.Reserve(QueryInstance.Items.Num());
+
+	for (int32 i = 0; i < QueryInstance.Items.Num(); ++i)
+	{
+		if (QueryInstance.Items[i].IsValid())
+		{
+			Order.Add(i);
+		}
+	}
+
+	Order.Sort([&QueryInstance](int32 A, int32 B) { return QueryInstance.Items[A].Score > QueryInstance.Items[B].Score; });
+
+	TArray<FVector> TraceEnds;
+	TraceEnds.SetNumUninitialized(Order.Num());
+
+	for (int32 Slot = 0; Slot < Order.Num(); ++Slot)
+	{
+		TraceEnds[Slot] = GetItemLocation(QueryInstance, Order[Slot]) + FVector(0.0f, 0.0f, ItemHeightOffset);
+	}
+
+	// the traces run synchronously, so cap how many a single run can do
+	const int32 MaxTraces = GetDefault<UShooterAISettings>()->MaxVisibilityTracesPerRun;
+	const int32 NumToTrace = MaxTraces > 0 ? FMath::Min(MaxTraces, Order.Num()) : Order.Num();
+
+	// per item verdicts. Items left untraced by the cap or the early out count as failing the filter
+	TArray<uint8> Passed;
+	Passed.SetNumZeroed(QueryInstance.Items.Num());
+
+	const bool bCanEarlyOut = MaxPassingItems > 0 && TestPurpose != EEnvTestPurpose::Score;
+	int32 NumPassed = 0;
+	int32 NumTraced = 0;
+
+	while (NumTraced < NumToTrace)
+	{
+		const int32 ChunkStart = NumTraced;
+		const int32 ChunkSize = FMath::Min(TraceBatchSize, NumToTrace - ChunkStart);
+
+		// scene queries take their own read lock, so the chunk can be traced across worker threads
+		ParallelFor(ChunkSize, [&](int32 ChunkIndex)
+		{
+			const int32 Slot = ChunkStart + ChunkIndex;
+			const bool bVisible = !World->LineTraceTestByChannel(TraceStart, TraceEnds[Slot], TraceChannel, QueryParams);
+
+			Passed[Order[Slot]] = bVisible == bWantsVisible;
+		});
+
+		NumTraced += ChunkSize;
+
+		if (!bCanEarlyOut)
+		{
+			continue;
+		}
+
+		for (int32 Slot = ChunkStart; Slot < NumTraced; ++Slot)
+		{
+			NumPassed += Passed[Order[Slot]];
+		}
+
+		if (NumPassed >= MaxPassingItems)
+		{
+			break;
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_ShooterEQSVisibilityTraces, NumTraced);
+	INC_DWORD_STAT_BY(STAT_ShooterEQSVisibilitySkipped, Order.Num() - NumTraced);
+
+	// write the verdicts back in one pass
+	FEnvQueryInstance::ItemIterator It(this, QueryInstance);
+	It.IgnoreTimeLimit();
+
+	for (; It; ++It)
+	{
+		It.SetScore(TestPurpose, FilterType, Passed[It.GetIndex()] != 0, true);
+	}
+}
+
+FText UEnvQueryTest_ShooterVisibility::GetDescriptionTitle() const
+{
+	return FText::FromString(FString::Printf(TEXT("%s: from %s"), *Super::GetDescriptionTitle().ToString(), *UEnvQueryTypes::DescribeContext(TraceFrom).ToString()));
+}
+
+FText UEnvQueryTest_ShooterVisibility::GetDescriptionDetails() const
+{
+	return DescribeBoolTestParams(TEXT("visible"));
+}
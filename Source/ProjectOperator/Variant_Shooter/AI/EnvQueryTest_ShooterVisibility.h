@@ -0,0 +1,63 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnvironmentQuery/EnvQueryTest.h"
+#include "Engine/EngineTypes.h"
+#include "EnvQueryTest_ShooterVisibility.generated.h"
+
+class UEnvQueryContext;
+
+/**
+ *  Batched EQS visibility test
+ *  Traces are run in parallel chunks, best scored items first,
+ *  and stop early once enough items have passed the filter or the per run trace cap in the AI settings is reached
+ */
+UCLASS(meta = (DisplayName = "Shooter Visibility (Batched)"))
+class PROJECTOPERATOR_API UEnvQueryTest_ShooterVisibility : public UEnvQueryTest
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Context to trace from. Only its first location is used */
+	UPROPERTY(EditDefaultsOnly, Category = "Trace")
+	TSubclassOf<UEnvQueryContext> TraceFrom;
+
+	/** Collision channel to trace on */
+	UPROPERTY(EditDefaultsOnly, Category = "Trace")
+	TEnumAsByte<ECollisionChannel> TraceChannel = ECC_Visibility;
+
+	/** Height offset added to the context location */
+	UPROPERTY(EditDefaultsOnly, Category = "Trace", meta = (Units = "cm"))
+	float ContextHeightOffset = 60.0f;
+
+	/** Height offset added to every item location */
+	UPROPERTY(EditDefaultsOnly, Category = "Trace", meta = (Units = "cm"))
+	float ItemHeightOffset = 50.0f;
+
+	/** Number of items traced per parallel chunk */
+	UPROPERTY(EditDefaultsOnly, Category = "Trace", meta = (ClampMin = 1, ClampMax = 256))
+	int32 TraceBatchSize = 16;
+
+	/** When filtering, stop tracing once this many items have passed. Untraced items are filtered out. Zero traces every item */
+	UPROPERTY(EditDefaultsOnly, Category = "Trace", meta = (ClampMin = 0))
+	int32 MaxPassingItems = 0;
+
+public:
+
+	/** Constructor */
+	UEnvQueryTest_ShooterVisibility(const FObjectInitializer& ObjectInitializer);
+
+protected:
+
+	/** Runs the test over every item */
+	virtual void RunTest(FEnvQueryInstance& QueryInstance) const override;
+
+	/** Returns the test title for the EQS editor */
+	virtual FText GetDescriptionTitle() const override;
+
+	/** Returns the test details for the EQS editor */
+	virtual FText GetDescriptionDetails() const override;
+};
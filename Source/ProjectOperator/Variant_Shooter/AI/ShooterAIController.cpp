@@ -3,24 +3,51 @@
 
 #include "Variant_Shooter/AI/ShooterAIController.h"
 #include "ShooterNPC.h"
+#include "ShooterAILODSubsystem.h"
+#include "ShooterStateTreeScheduler.h"
+#include "ShooterSquadSubsystem.h"
+#include "ShooterNPCMovementComponent.h"
+#include "AISenseConfig_ShooterSight.h"
 #include "Components/StateTreeAIComponent.h"
 #include "Perception/AIPerceptionComponent.h"
 #include "Navigation/PathFollowingComponent.h"
+#include "Navigation/CrowdFollowingComponent.h"
 #include "AI/Navigation/PathFollowingAgentInterface.h"
+#include "Perception/AISenseConfig_Sight.h"
+#include "Perception/AISenseConfig_Hearing.h"
+#include "Perception/AISense_Sight.h"
+#include "Engine/World.h"
+#include "Settings/ShooterAISettings.h"
 
-AShooterAIController::AShooterAIController()
+AShooterAIController::AShooterAIController(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UCrowdFollowingComponent>(TEXT("PathFollowingComponent")))
 {
+	// tick to flush the queued perception stimuli
+	PrimaryActorTick.bCanEverTick = true;
+
 	// create the StateTree component
 	StateTreeAI = CreateDefaultSubobject<UStateTreeAIComponent>(TEXT("StateTreeAI"));
 
 	// create the AI perception component. It will be configured in BP
 	AIPerception = CreateDefaultSubobject<UAIPerceptionComponent>(TEXT("AIPerception"));
 
+	// see through the batched shooter sight sense by default, so NPCs are bucketed and tested together against the players
+	UAISenseConfig_ShooterSight* ShooterSightConfig = CreateDefaultSubobject<UAISenseConfig_ShooterSight>(TEXT("ShooterSightConfig"));
+	AIPerception->ConfigureSense(*ShooterSightConfig);
+	AIPerception->SetDominantSense(ShooterSightConfig->GetSenseImplementation());
+
 	// subscribe to the AI perception delegates
 	AIPerception->OnTargetPerceptionUpdated.AddDynamic(this, &AShooterAIController::OnPerceptionUpdated);
 	AIPerception->OnTargetPerceptionForgotten.AddDynamic(this, &AShooterAIController::OnPerceptionForgotten);
 }
 
+void AShooterAIController::BeginPlay()
+{
+	Super::BeginPlay();
+
+	ReplaceEngineSight();
+}
+
 void AShooterAIController::OnPossess(APawn* InPawn)
 {
 	Super::OnPossess(InPawn);
@@ -28,11 +55,42 @@ void AShooterAIController::OnPossess(APawn* InPawn)
 	// ensure we're possessing an NPC
 	if (AShooterNPC* NPC = Cast<AShooterNPC>(InPawn))
 	{
-		// add the team tag to the pawn
-		NPC->Tags.Add(TeamTag);
+		// take on the pawn's team and only perceive its enemies
+		SetGenericTeamId(NPC->GetGenericTeamId());
+		ConfigureHostileOnlyPerception();
+
+		// follow paths normally. The path broker turns on crowd avoidance for dense groups
+		if (UCrowdFollowingComponent* CrowdFollowing = Cast<UCrowdFollowingComponent>(GetPathFollowingComponent()))
+		{
+			CrowdFollowing->SetCrowdSimulationState(ECrowdSimulationState::ObstacleOnly);
+		}
 
 		// subscribe to the pawn's OnDeath delegate
-		NPC->OnPawnDeath.AddDynamic(this, &AShooterAIController::OnPawnDeath);
+		NPC->OnPawnDeath.AddUniqueDynamic(this, &AShooterAIController::OnPawnDeath);
+
+		RegisterWithAISubsystems(NPC);
+	}
+}
+
+void AShooterAIController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UnregisterFromAISubsystems();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AShooterAIController::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// process the perception updates received since the last batch, on the interval set by our LOD bucket
+	TimeSincePerceptionFlush += DeltaTime;
+
+	if (TimeSincePerceptionFlush >= PerceptionInterval)
+	{
+		TimeSincePerceptionFlush = 0.0f;
+
+		FlushPerceptionQueue();
 	}
 }
 
@@ -41,14 +99,8 @@ void AShooterAIController::OnPawnDeath()
 	// stop movement
 	GetPathFollowingComponent()->AbortMove(*this, FPathFollowingResultFlags::UserAbort);
 
-	// stop StateTree logic
-	StateTreeAI->StopLogic(FString(""));
-
-	// unpossess the pawn
-	UnPossess();
-
-	// destroy this controller
-	Destroy();
+	// stay possessed so the NPC pool can bring us back along with the pawn, but stop thinking until then
+	SetAISuspended(true);
 }
 
 void AShooterAIController::SetCurrentTarget(AActor* Target)
@@ -61,14 +113,305 @@ void AShooterAIController::ClearCurrentTarget()
 	TargetEnemy = nullptr;
 }
 
+void AShooterAIController::ApplyAILOD(const FShooterAILODSettings& LODSettings)
+{
+	// throttle the StateTree through the scheduler if it owns our ticking
+	UShooterStateTreeScheduler* Scheduler = GetWorld()->GetSubsystem<UShooterStateTreeScheduler>();
+
+	if (!Scheduler || !Scheduler->SetTickInterval(StateTreeAI, LODSettings.StateTreeTickInterval))
+	{
+		StateTreeAI->SetComponentTickInterval(LODSettings.StateTreeTickInterval);
+	}
+
+	// throttle perception batches
+	LODPerceptionInterval = LODSettings.PerceptionInterval;
+	UpdatePerceptionInterval();
+
+	// throttle path following
+	if (UPathFollowingComponent* PathFollowing = GetPathFollowingComponent())
+	{
+		PathFollowing->SetComponentTickInterval(LODSettings.PathFollowingTickInterval);
+	}
+
+	// simplify character movement far from players
+	if (UShooterNPCMovementComponent* Movement = GetPawn() ? Cast<UShooterNPCMovementComponent>(GetPawn()->GetMovementComponent()) : nullptr)
+	{
+		Movement->SetSimplifiedMovement(LODSettings.bSimplifiedMovement, LODSettings.SimplifiedMovementInterval);
+	}
+
+	// throttle the shooter sight sense, which reads the interval for each listener on update
+	SightUpdateInterval = LODSettings.SightUpdateInterval;
+
+	// toggle sight, whichever sight sense we're configured with
+	if (UAISenseConfig_Sight* SightConfig = GetSightConfig())
+	{
+		AIPerception->SetSenseEnabled(SightConfig->GetSenseImplementation(), LODSettings.bSightEnabled);
+	}
+}
+
+void AShooterAIController::SetSquadFollower(bool bFollower)
+{
+	if (bSquadFollower == bFollower)
+	{
+		return;
+	}
+
+	bSquadFollower = bFollower;
+
+	UpdatePerceptionInterval();
+
+	// followers only need to see nearby enemies, the leader covers long range
+	if (UAISenseConfig_Sight* SightConfig = GetSightConfig())
+	{
+		// remember the configured radii the first time we scale them
+		if (BaseSightRadius < 0.0f)
+		{
+			BaseSightRadius = SightConfig->SightRadius;
+			BaseLoseSightRadius = SightConfig->LoseSightRadius;
+		}
+
+		const float Scale = bSquadFollower ? GetDefault<UShooterAISettings>()->SquadFollowerSightRadiusScale : 1.0f;
+
+		SightConfig->SightRadius = BaseSightRadius * Scale;
+		SightConfig->LoseSightRadius = BaseLoseSightRadius * Scale;
+
+		AIPerception->ConfigureSense(*SightConfig);
+	}
+}
+
+void AShooterAIController::SetAISuspended(bool bSuspended)
+{
+	if (bAISuspended == bSuspended)
+	{
+		return;
+	}
+
+	bAISuspended = bSuspended;
+
+	AShooterNPC* NPC = Cast<AShooterNPC>(GetPawn());
+
+	if (bSuspended)
+	{
+		// drop everything we were doing and knew about
+		StopMovement();
+		ClearCurrentTarget();
+		StateTreeAI->StopLogic(FString("Suspended"));
+
+		UnregisterFromAISubsystems();
+
+		StateTreeAI->SetComponentTickEnabled(false);
+		SetPerceptionEnabled(false);
+		AIPerception->ForgetAll();
+		PendingStimuli.Reset();
+
+		SetActorTickEnabled(false);
+
+	} else if (NPC) {
+
+		SetActorTickEnabled(true);
+
+		// the pawn may have been given a new team while suspended
+		SetGenericTeamId(NPC->GetGenericTeamId());
+		AIPerception->RequestStimuliListenerUpdate();
+		SetPerceptionEnabled(true);
+
+		// the scheduler takes the StateTree tick back over on registration, and the LOD subsystem reapplies our update rates
+		StateTreeAI->SetComponentTickEnabled(true);
+		RegisterWithAISubsystems(NPC);
+
+		// start the StateTree over from its root state
+		StateTreeAI->StartLogic();
+	}
+}
+
 void AShooterAIController::OnPerceptionUpdated(AActor* Actor, FAIStimulus Stimulus)
 {
-	// pass the data to the StateTree delegate hook
-	OnShooterPerceptionUpdated.ExecuteIfBound(Actor, Stimulus);
+	// collapse multiple stimuli from the same actor and sense into the most recent one, so sight lost events still get through
+	for (FShooterPerceivedStimulus& Queued : PendingStimuli)
+	{
+		if (Queued.Actor == Actor && Queued.Stimulus.Type == Stimulus.Type)
+		{
+			Queued.Stimulus = Stimulus;
+			return;
+		}
+	}
+
+	// queue the stimulus until the next tick
+	PendingStimuli.Add({ Actor, Stimulus });
 }
 
 void AShooterAIController::OnPerceptionForgotten(AActor* Actor)
 {
+	// drop any queued stimulus for the forgotten actor
+	PendingStimuli.RemoveAll([Actor](const FShooterPerceivedStimulus& Queued) { return Queued.Actor == Actor; });
+
 	// pass the data to the StateTree delegate hook
 	OnShooterPerceptionForgotten.ExecuteIfBound(Actor);
 }
+
+void AShooterAIController::FlushPerceptionQueue()
+{
+	if (PendingStimuli.IsEmpty())
+	{
+		return;
+	}
+
+	// drop stimuli from actors destroyed since they were queued
+	PendingStimuli.RemoveAll([](const FShooterPerceivedStimulus& Queued) { return !Queued.Actor.IsValid(); });
+
+	// pass the batch to the StateTree delegate hook
+	OnShooterPerceptionUpdated.ExecuteIfBound(PendingStimuli);
+
+	PendingStimuli.Reset();
+}
+
+void AShooterAIController::ConfigureHostileOnlyPerception()
+{
+	// gather the configs first, since reconfiguring a sense replaces its entry
+	TArray<UAISenseConfig*> Configs;
+
+	for (auto It = AIPerception->GetSensesConfigIterator(); It; ++It)
+	{
+		Configs.Add(*It);
+	}
+
+	for (UAISenseConfig* Config : Configs)
+	{
+		FAISenseAffiliationFilter* Filter = nullptr;
+
+		if (UAISenseConfig_Sight* SightConfig = Cast<UAISenseConfig_Sight>(Config))
+		{
+			Filter = &SightConfig->DetectionByAffiliation;
+
+		} else if (UAISenseConfig_Hearing* HearingConfig = Cast<UAISenseConfig_Hearing>(Config)) {
+
+			Filter = &HearingConfig->DetectionByAffiliation;
+		}
+
+		if (Filter)
+		{
+			Filter->bDetectEnemies = true;
+			Filter->bDetectNeutrals = false;
+			Filter->bDetectFriendlies = false;
+
+			AIPerception->ConfigureSense(*Config);
+		}
+	}
+
+	// pick up our new team on the perception system
+	AIPerception->RequestStimuliListenerUpdate();
+}
+
+void AShooterAIController::UpdatePerceptionInterval()
+{
+	// followers batch perception less often, on top of any LOD throttling
+	PerceptionInterval = bSquadFollower ? FMath::Max(LODPerceptionInterval, GetDefault<UShooterAISettings>()->SquadFollowerPerceptionInterval) : LODPerceptionInterval;
+}
+
+void AShooterAIController::ReplaceEngineSight()
+{
+	UAISenseConfig_Sight* EngineSightConfig = nullptr;
+	UAISenseConfig_ShooterSight* ShooterSightConfig = nullptr;
+
+	for (auto It = AIPerception->GetSensesConfigIterator(); It; ++It)
+	{
+		if (UAISenseConfig_ShooterSight* ShooterConfig = Cast<UAISenseConfig_ShooterSight>(*It))
+		{
+			ShooterSightConfig = ShooterConfig;
+
+		} else if (UAISenseConfig_Sight* SightConfig = Cast<UAISenseConfig_Sight>(*It)) {
+
+			EngineSightConfig = SightConfig;
+		}
+	}
+
+	if (!EngineSightConfig || !ShooterSightConfig)
+	{
+		return;
+	}
+
+	// keep the view cone tuned on the BP's engine sight config. Affiliation is set up on possession
+	ShooterSightConfig->SightRadius = EngineSightConfig->SightRadius;
+	ShooterSightConfig->LoseSightRadius = EngineSightConfig->LoseSightRadius;
+	ShooterSightConfig->PeripheralVisionAngleDegrees = EngineSightConfig->PeripheralVisionAngleDegrees;
+	ShooterSightConfig->SetMaxAge(EngineSightConfig->GetMaxAge());
+
+	AIPerception->ConfigureSense(*ShooterSightConfig);
+
+	// don't pay for the same sightings twice
+	AIPerception->SetSenseEnabled(UAISense_Sight::StaticClass(), false);
+}
+
+UAISenseConfig_Sight* AShooterAIController::GetSightConfig() const
+{
+	UAISenseConfig_Sight* EngineSightConfig = nullptr;
+
+	for (auto It = AIPerception->GetSensesConfigIterator(); It; ++It)
+	{
+		if (UAISenseConfig_ShooterSight* ShooterSightConfig = Cast<UAISenseConfig_ShooterSight>(*It))
+		{
+			return ShooterSightConfig;
+		}
+
+		if (!EngineSightConfig)
+		{
+			EngineSightConfig = Cast<UAISenseConfig_Sight>(*It);
+		}
+	}
+
+	return EngineSightConfig;
+}
+
+void AShooterAIController::RegisterWithAISubsystems(AShooterNPC* NPC)
+{
+	// let the scheduler tick our StateTree within the global AI budget
+	if (UShooterStateTreeScheduler* Scheduler = GetWorld()->GetSubsystem<UShooterStateTreeScheduler>())
+	{
+		Scheduler->RegisterStateTree(StateTreeAI);
+	}
+
+	// let the LOD subsystem manage our update rates
+	if (UShooterAILODSubsystem* LODSubsystem = GetWorld()->GetSubsystem<UShooterAILODSubsystem>())
+	{
+		LODSubsystem->RegisterController(this);
+	}
+
+	// share sightings with the rest of our squad
+	if (UShooterSquadSubsystem* SquadSubsystem = GetWorld()->GetSubsystem<UShooterSquadSubsystem>())
+	{
+		SquadSubsystem->RegisterMember(this, NPC->GetSquadName());
+	}
+}
+
+void AShooterAIController::UnregisterFromAISubsystems()
+{
+	// leave our squad so a new leader can be picked
+	if (UShooterSquadSubsystem* SquadSubsystem = GetWorld()->GetSubsystem<UShooterSquadSubsystem>())
+	{
+		SquadSubsystem->UnregisterMember(this);
+	}
+
+	// stop being managed by the LOD subsystem
+	if (UShooterAILODSubsystem* LODSubsystem = GetWorld()->GetSubsystem<UShooterAILODSubsystem>())
+	{
+		LODSubsystem->UnregisterController(this);
+	}
+
+	// stop being ticked by the scheduler
+	if (UShooterStateTreeScheduler* Scheduler = GetWorld()->GetSubsystem<UShooterStateTreeScheduler>())
+	{
+		Scheduler->UnregisterStateTree(StateTreeAI);
+	}
+}
+
+void AShooterAIController::SetPerceptionEnabled(bool bEnabled)
+{
+	for (auto It = AIPerception->GetSensesConfigIterator(); It; ++It)
+	{
+		// the engine sight sense stays off, since the shooter sight sense replaces it
+		if (*It && (*It)->GetSenseImplementation() != UAISense_Sight::StaticClass())
+		{
+			AIPerception->SetSenseEnabled((*It)->GetSenseImplementation(), bEnabled);
+		}
+	}
+}
@@ -4,13 +4,28 @@
 
 #include "CoreMinimal.h"
 #include "AIController.h"
+#include "Perception/AIPerceptionTypes.h"
 #include "ShooterAIController.generated.h"
 
 class UStateTreeAIComponent;
 class UAIPerceptionComponent;
-struct FAIStimulus;
+class UAISenseConfig_Sight;
+class AShooterNPC;
+struct FShooterAILODSettings;
 
-DECLARE_DELEGATE_TwoParams(FShooterPerceptionUpdatedDelegate, AActor*, const FAIStimulus&);
+/**
+ *  Perception stimulus queued for batched processing
+ */
+struct FShooterPerceivedStimulus
+{
+	/** Actor that caused the stimulus */
+	TWeakObjectPtr<AActor> Actor;
+
+	/** Most recent stimulus received from the actor for this sense this frame */
+	FAIStimulus Stimulus;
+};
+
+DECLARE_DELEGATE_OneParam(FShooterPerceptionUpdatedDelegate, TConstArrayView<FShooterPerceivedStimulus>);
 DECLARE_DELEGATE_OneParam(FShooterPerceptionForgottenDelegate, AActor*);
 
 /**
@@ -31,16 +46,41 @@ class PROJECTOPERATOR_API AShooterAIController : public AAIController
 
 protected:
 
-	/** Team tag for pawn friend or foe identification */
-	UPROPERTY(EditAnywhere, Category="Shooter")
+	/** Deprecated. Teams come from the pawn's team ID. Kept so existing Blueprint references still load and compile */
+	UPROPERTY(EditAnywhere, Category="Shooter", meta = (DeprecatedProperty, DeprecationMessage = "Teams come from the pawn's team ID"))
 	FName TeamTag = FName("Enemy");
 
 	/** Enemy currently being targeted */
 	TObjectPtr<AActor> TargetEnemy;
 
+	/** Stimuli received this frame, collapsed to one per actor and sense */
+	TArray<FShooterPerceivedStimulus> PendingStimuli;
+
+	/** Interval between perception batches, set by the AI LOD subsystem */
+	float PerceptionInterval = 0.0f;
+
+	/** Time accumulated since the last perception batch was flushed */
+	float TimeSincePerceptionFlush = 0.0f;
+
+	/** Perception batch interval requested by our LOD bucket */
+	float LODPerceptionInterval = 0.0f;
+
+	/** Interval between shooter sight updates requested by our LOD bucket */
+	float SightUpdateInterval = 0.0f;
+
+	/** If true, our AI is suspended because the pawn is dead or pooled */
+	bool bAISuspended = false;
+
+	/** If true, we're a squad follower and rely on the squad leader for long range sightings */
+	bool bSquadFollower = false;
+
+	/** Sight radii configured on the perception component, before any squad scaling */
+	float BaseSightRadius = -1.0f;
+	float BaseLoseSightRadius = -1.0f;
+
 public:
 
-	/** Called when an AI perception has been updated. StateTree task delegate hook */
+	/** Called once per tick with the batch of perception updates received since the last tick. StateTree task delegate hook */
 	FShooterPerceptionUpdatedDelegate OnShooterPerceptionUpdated;
 
 	/** Called when an AI perception has been forgotten. StateTree task delegate hook */
@@ -49,13 +89,22 @@ public:
 public:
 
 	/** Constructor */
-	AShooterAIController();
+	AShooterAIController(const FObjectInitializer& ObjectInitializer);
 
 protected:
 
+	/** Gameplay initialization */
+	virtual void BeginPlay() override;
+
 	/** Pawn initialization */
 	virtual void OnPossess(APawn* InPawn) override;
 
+	/** Cleanup */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Flushes the queued perception stimuli */
+	virtual void Tick(float DeltaTime) override;
+
 protected:
 
 	/** Called when the possessed pawn dies */
@@ -73,6 +122,21 @@ public:
 	/** Returns the targeted enemy */
 	AActor* GetCurrentTarget() const { return TargetEnemy; };
 
+	/** Applies the update rates for an AI level of detail bucket */
+	void ApplyAILOD(const FShooterAILODSettings& LODSettings);
+
+	/** Switches between full perception as a squad leader and reduced perception as a follower */
+	void SetSquadFollower(bool bFollower);
+
+	/** Suspends the StateTree, perception and AI subsystem registrations while the pawn is dead or pooled, or resumes them */
+	void SetAISuspended(bool bSuspended);
+
+	/** Returns true if we rely on the squad leader for long range sightings */
+	bool IsSquadFollower() const { return bSquadFollower; }
+
+	/** Returns the interval between shooter sight updates for our LOD bucket */
+	float GetSightUpdateInterval() const { return SightUpdateInterval; }
+
 protected:
 
 	/** Called when the AI perception component updates a perception on a given actor */
@@ -82,4 +146,28 @@ protected:
 	/** Called when the AI perception component forgets a given actor */
 	UFUNCTION()
 	void OnPerceptionForgotten(AActor* Actor);
+
+	/** Passes the queued stimuli to the StateTree as a single batch */
+	void FlushPerceptionQueue();
+
+	/** Restricts sight and hearing to hostile actors, so friendly stimuli are dropped by the perception system */
+	void ConfigureHostileOnlyPerception();
+
+	/** Combines the LOD and squad role perception intervals */
+	void UpdatePerceptionInterval();
+
+	/** Registers with the StateTree scheduler, AI LOD and squad subsystems */
+	void RegisterWithAISubsystems(AShooterNPC* NPC);
+
+	/** Unregisters from the StateTree scheduler, AI LOD and squad subsystems */
+	void UnregisterFromAISubsystems();
+
+	/** Enables or disables every configured sense */
+	void SetPerceptionEnabled(bool bEnabled);
+
+	/** Moves any engine sight tuning set up in BP over to the shooter sight config, and turns the engine sight sense off */
+	void ReplaceEngineSight();
+
+	/** Returns the sight config in use, preferring the shooter sight sense over the engine one */
+	UAISenseConfig_Sight* GetSightConfig() const;
 };
@@ -0,0 +1,226 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterAILODSubsystem.h"
+#include "Variant_Shooter/AI/ShooterAIController.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "ProjectOperator.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("LOD High NPCs"), STAT_ShooterLODHigh, STATGROUP_ShooterAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("LOD Medium NPCs"), STAT_ShooterLODMedium, STATGROUP_ShooterAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("LOD Low NPCs"), STAT_ShooterLODLow, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("LOD Transitions"), STAT_ShooterLODTransitions, STATGROUP_ShooterAI);
+
+bool UShooterAILODSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterAILODSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TimeUntilUpdate -= DeltaTime;
+
+	if (TimeUntilUpdate > 0.0f)
+	{
+		return;
+	}
+
+	TimeUntilUpdate = GetDefault<UShooterAISettings>()->LODUpdateInterval;
+
+	UpdateSignificance();
+}
+
+TStatId UShooterAILODSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterAILODSubsystem, STATGROUP_Tickables);
+}
+
+void UShooterAILODSubsystem::RegisterController(AShooterAIController* Controller)
+{
+	if (!IsValid(Controller))
+	{
+		return;
+	}
+
+	// ignore duplicate registrations
+	for (const FShooterAILODAgent& Agent : Agents)
+	{
+		if (Agent.Controller == Controller)
+		{
+			return;
+		}
+	}
+
+	// start at full detail so the NPC reacts normally until its first significance update
+	FShooterAILODAgent& Agent = Agents.AddDefaulted_GetRef();
+	Agent.Controller = Controller;
+	Agent.LOD = EShooterAILOD::High;
+
+	Controller->ApplyAILOD(GetDefault<UShooterAISettings>()->GetLODSettings(Agent.LOD));
+
+	// evaluate the new agent on the next tick
+	TimeUntilUpdate = 0.0f;
+}
+
+void UShooterAILODSubsystem::UnregisterController(AShooterAIController* Controller)
+{
+	Agents.RemoveAllSwap([Controller](const FShooterAILODAgent& Agent) { return Agent.Controller == Controller; });
+}
+
+EShooterAILOD UShooterAILODSubsystem::GetLOD(const AShooterAIController* Controller) const
+{
+	for (const FShooterAILODAgent& Agent : Agents)
+	{
+		if (Agent.Controller == Controller)
+		{
+			return Agent.LOD;
+		}
+	}
+
+	return EShooterAILOD::High;
+}
+
+void UShooterAILODSubsystem::UpdateSignificance()
+{
+	// drop controllers destroyed since the last update
+	Agents.RemoveAllSwap([](const FShooterAILODAgent& Agent) { return !Agent.Controller.IsValid(); });
+
+	if (Agents.IsEmpty())
+	{
+		return;
+	}
+
+	const UShooterAISettings* Settings = GetDefault<UShooterAISettings>();
+
+	// gather the view location and direction of every player with a pawn
+	TArray<TPair<FVector, FVector>> PlayerViews;
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PC = It->Get();
+
+		if (PC && PC->GetPawn())
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+			PlayerViews.Add({ ViewLocation, ViewRotation.Vector() });
+		}
+	}
+
+	// work out the bucket each agent wants to be in
+	TArray<EShooterAILOD> DesiredLODs;
+	DesiredLODs.SetNumUninitialized(Agents.Num());
+
+	TArray<int32> HighCandidates;
+
+	for (int32 i = 0; i < Agents.Num(); ++i)
+	{
+		FShooterAILODAgent& Agent = Agents[i];
+
+		// with no players around, everybody drops to the lowest bucket
+		Agent.EffectiveDistance = PlayerViews.IsEmpty() ? UE_MAX_FLT : GetEffectiveDistance(Agent.Controller.Get(), PlayerViews, Settings);
+		DesiredLODs[i] = GetDesiredLOD(Agent.EffectiveDistance, Agent.LOD, Settings);
+
+		if (DesiredLODs[i] == EShooterAILOD::High)
+		{
+			HighCandidates.Add(i);
+		}
+	}
+
+	// cap the high bucket, keeping the most significant agents
+	if (HighCandidates.Num() > Settings->MaxHighLODNPCs)
+	{
+		HighCandidates.Sort([this](int32 A, int32 B) { return Agents[A].EffectiveDistance < Agents[B].EffectiveDistance; });
+
+		for (int32 i = Settings->MaxHighLODNPCs; i < HighCandidates.Num(); ++i)
+		{
+			DesiredLODs[HighCandidates[i]] = EShooterAILOD::Medium;
+		}
+	}
+
+	// apply the update rates of agents that changed bucket
+	int32 NumPerLOD[3] = { 0, 0, 0 };
+
+	for (int32 i = 0; i < Agents.Num(); ++i)
+	{
+		FShooterAILODAgent& Agent = Agents[i];
+
+		if (Agent.LOD != DesiredLODs[i])
+		{
+			Agent.LOD = DesiredLODs[i];
+			Agent.Controller->ApplyAILOD(Settings->GetLODSettings(Agent.LOD));
+
+			INC_DWORD_STAT(STAT_ShooterLODTransitions);
+		}
+
+		++NumPerLOD[static_cast<int32>(Agent.LOD)];
+	}
+
+	SET_DWORD_STAT(STAT_ShooterLODHigh, NumPerLOD[static_cast<int32>(EShooterAILOD::High)]);
+	SET_DWORD_STAT(STAT_ShooterLODMedium, NumPerLOD[static_cast<int32>(EShooterAILOD::Medium)]);
+	SET_DWORD_STAT(STAT_ShooterLODLow, NumPerLOD[static_cast<int32>(EShooterAILOD::Low)]);
+}
+
+float UShooterAILODSubsystem::GetEffectiveDistance(const AShooterAIController* Controller, const TArray<TPair<FVector, FVector>>& PlayerViews, const UShooterAISettings* Settings)
+{
+	const APawn* Pawn = Controller->GetPawn();
+
+	if (!Pawn)
+	{
+		return UE_MAX_FLT;
+	}
+
+	const FVector NPCLocation = Pawn->GetActorLocation();
+	const float ViewConeCos = FMath::Cos(FMath::DegreesToRadians(Settings->InViewConeAngle));
+
+	float Nearest = UE_MAX_FLT;
+
+	for (const TPair<FVector, FVector>& View : PlayerViews)
+	{
+		const FVector ToNPC = NPCLocation - View.Key;
+		float Distance = ToNPC.Size();
+
+		// NPCs the player is looking at count as closer
+		if ((ToNPC.GetSafeNormal() | View.Value) >= ViewConeCos)
+		{
+			Distance *= Settings->InViewDistanceScale;
+		}
+
+		Nearest = FMath::Min(Nearest, Distance);
+	}
+
+	// NPCs in a fight count as closer
+	if (Controller->GetCurrentTarget())
+	{
+		Nearest *= Settings->InCombatDistanceScale;
+	}
+
+	return Nearest;
+}
+
+EShooterAILOD UShooterAILODSubsystem::GetDesiredLOD(float EffectiveDistance, EShooterAILOD CurrentLOD, const UShooterAISettings* Settings)
+{
+	for (EShooterAILOD LOD : { EShooterAILOD::High, EShooterAILOD::Medium })
+	{
+		float MaxDistance = Settings->GetLODSettings(LOD).MaxDistance;
+
+		// agents already at this level of detail or better only leave it once past the hysteresis margin
+		if (CurrentLOD <= LOD)
+		{
+			MaxDistance *= 1.0f + Settings->LODHysteresis;
+		}
+
+		if (EffectiveDistance <= MaxDistance)
+		{
+			return LOD;
+		}
+	}
+
+	return EShooterAILOD::Low;
+}
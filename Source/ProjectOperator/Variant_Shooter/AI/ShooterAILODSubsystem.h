@@ -0,0 +1,77 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Settings/ShooterAISettings.h"
+#include "ShooterAILODSubsystem.generated.h"
+
+class AShooterAIController;
+
+/**
+ *  Significance data tracked for a registered shooter AI controller
+ */
+struct FShooterAILODAgent
+{
+	/** Controller being managed */
+	TWeakObjectPtr<AShooterAIController> Controller;
+
+	/** Bucket the controller is currently in */
+	EShooterAILOD LOD = EShooterAILOD::High;
+
+	/** Distance to the nearest player, scaled by visibility and combat state. Lower is more significant */
+	float EffectiveDistance = 0.0f;
+};
+
+/**
+ *  Level of detail manager for the shooter AI
+ *  Periodically buckets NPCs by distance and visibility to players
+ *  and scales their StateTree, perception and path following update rates to match
+ */
+UCLASS()
+class PROJECTOPERATOR_API UShooterAILODSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Registered controllers */
+	TArray<FShooterAILODAgent> Agents;
+
+	/** Time left until the next significance update */
+	float TimeUntilUpdate = 0.0f;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Updates significance on the configured interval */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable object */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/** Starts managing the update rates of the given controller */
+	void RegisterController(AShooterAIController* Controller);
+
+	/** Stops managing the update rates of the given controller */
+	void UnregisterController(AShooterAIController* Controller);
+
+	/** Returns the bucket the given controller is in. Unregistered controllers are treated as high detail */
+	EShooterAILOD GetLOD(const AShooterAIController* Controller) const;
+
+protected:
+
+	/** Recomputes every agent's bucket and applies the update rates of those that changed */
+	void UpdateSignificance();
+
+	/** Returns the agent's distance to the nearest player, scaled by visibility and combat state */
+	static float GetEffectiveDistance(const AShooterAIController* Controller, const TArray<TPair<FVector, FVector>>& PlayerViews, const UShooterAISettings* Settings);
+
+	/** Returns the bucket for the given effective distance, applying hysteresis against the current bucket */
+	static EShooterAILOD GetDesiredLOD(float EffectiveDistance, EShooterAILOD CurrentLOD, const UShooterAISettings* Settings);
+};
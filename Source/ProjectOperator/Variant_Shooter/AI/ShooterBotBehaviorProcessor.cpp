@@ -0,0 +1,108 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterBotBehaviorProcessor.h"
+#include "Variant_Shooter/AI/ShooterBotFragments.h"
+#include "Variant_Shooter/AI/ShooterInfluenceMapSubsystem.h"
+#include "MassExecutionContext.h"
+#include "Engine/World.h"
+#include "Settings/ShooterAISettings.h"
+#include "ProjectOperator.h"
+
+DECLARE_CYCLE_STAT(TEXT("Bot Behavior"), STAT_ShooterBotBehavior, STATGROUP_ShooterAI);
+
+UShooterBotBehaviorProcessor::UShooterBotBehaviorProcessor()
+	: EntityQuery(*this)
+{
+	// the bot subsystem runs this processor itself
+	bAutoRegisterWithProcessingPhases = false;
+}
+
+void UShooterBotBehaviorProcessor::ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager)
+{
+	EntityQuery.AddRequirement<FShooterBotTransformFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FShooterBotStateFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FShooterBotBehaviorFragment>(EMassFragmentAccess::ReadWrite);
+}
+
+void UShooterBotBehaviorProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterBotBehavior);
+
+	const UShooterAISettings* Settings = GetDefault<UShooterAISettings>();
+
+	// the influence map front buffer is only swapped on the game thread, so it's safe to read from the chunk workers
+	const UShooterInfluenceMapSubsystem* InfluenceMap = UWorld::GetSubsystem<UShooterInfluenceMapSubsystem>(EntityManager.GetWorld());
+
+	const float Speed = Settings->BotMoveSpeed;
+	const float PatrolRadius = Settings->BotPatrolRadius;
+	const float HoldThreat = Settings->BotHoldThreat;
+
+	EntityQuery.ParallelForEachEntityChunk(Context, [InfluenceMap, Speed, PatrolRadius, HoldThreat](FMassExecutionContext& ChunkContext)
+	{
+		const float DeltaTime = ChunkContext.GetDeltaTimeSeconds();
+
+		const TArrayView<FShooterBotTransformFragment> Transforms = ChunkContext.GetMutableFragmentView<FShooterBotTransformFragment>();
+		const TConstArrayView<FShooterBotStateFragment> States = ChunkContext.GetFragmentView<FShooterBotStateFragment>();
+		const TArrayView<FShooterBotBehaviorFragment> Behaviors = ChunkContext.GetMutableFragmentView<FShooterBotBehaviorFragment>();
+
+		for (int32 i = 0; i < ChunkContext.GetNumEntities(); ++i)
+		{
+			FShooterBotTransformFragment& Transform = Transforms[i];
+			FShooterBotBehaviorFragment& Behavior = Behaviors[i];
+
+			// hold position while the area is contested
+			const float Threat = InfluenceMap ? InfluenceMap->GetThreat(States[i].TeamByte, Transform.Location) : 0.0f;
+
+			if (Threat >= HoldThreat)
+			{
+				Behavior.Behavior = EShooterBotBehavior::Hold;
+				continue;
+			}
+
+			switch (Behavior.Behavior)
+			{
+			case EShooterBotBehavior::Wait:
+			{
+				Behavior.TimeLeft -= DeltaTime;
+
+				if (Behavior.TimeLeft <= 0.0f)
+				{
+					// pick a new point to patrol to
+					const FVector2D Offset = FVector2D(Behavior.RandomStream.VRand()).GetSafeNormal() * Behavior.RandomStream.FRandRange(0.0f, PatrolRadius);
+
+					Behavior.Goal = Behavior.HomeLocation + FVector(Offset, 0.0f);
+					Behavior.Behavior = EShooterBotBehavior::Patrol;
+				}
+
+				break;
+			}
+
+			case EShooterBotBehavior::Hold:
+			case EShooterBotBehavior::Patrol:
+			{
+				const FVector ToGoal = Behavior.Goal - Transform.Location;
+				const float Step = Speed * DeltaTime;
+
+				if (ToGoal.SizeSquared2D() <= FMath::Square(Step))
+				{
+					// arrived, so wait a bit before moving on
+					Transform.Location = Behavior.Goal;
+					Behavior.TimeLeft = Behavior.RandomStream.FRandRange(1.0f, 4.0f);
+					Behavior.Behavior = EShooterBotBehavior::Wait;
+
+				} else {
+
+					const FVector Direction = ToGoal.GetSafeNormal2D();
+
+					Transform.Location += Direction * Step;
+					Transform.Yaw = Direction.Rotation().Yaw;
+					Behavior.Behavior = EShooterBotBehavior::Patrol;
+				}
+
+				break;
+			}
+			}
+		}
+	});
+}
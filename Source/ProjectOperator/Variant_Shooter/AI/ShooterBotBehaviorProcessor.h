@@ -0,0 +1,38 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassProcessor.h"
+#include "MassEntityQuery.h"
+#include "ShooterBotBehaviorProcessor.generated.h"
+
+/**
+ *  Runs coarse patrol and hold behavior for bots simulated as Mass entities
+ *  Chunks are processed in parallel. Bots hold position while their team's influence map reports a threat,
+ *  and otherwise wander between random points around their home location
+ *  Executed by the bot subsystem rather than the Mass processing phases
+ */
+UCLASS()
+class PROJECTOPERATOR_API UShooterBotBehaviorProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Bots with a transform, state and behavior */
+	FMassEntityQuery EntityQuery;
+
+public:
+
+	/** Constructor */
+	UShooterBotBehaviorProcessor();
+
+protected:
+
+	/** Sets up the entity query */
+	virtual void ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager) override;
+
+	/** Updates every bot */
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+};
@@ -0,0 +1,81 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "ShooterBotFragments.generated.h"
+
+/**
+ *  Coarse behavior states for bots simulated as Mass entities
+ */
+UENUM()
+enum class EShooterBotBehavior : uint8
+{
+	Patrol,
+	Wait,
+	Hold
+};
+
+/**
+ *  World location and facing of a coarse bot
+ */
+USTRUCT()
+struct PROJECTOPERATOR_API FShooterBotTransformFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	/** Capsule center */
+	FVector Location = FVector::ZeroVector;
+
+	/** Facing yaw, in degrees */
+	float Yaw = 0.0f;
+};
+
+/**
+ *  Gameplay state carried over between the coarse bot and its full NPC actor
+ */
+USTRUCT()
+struct PROJECTOPERATOR_API FShooterBotStateFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	/** Index of the NPC class in the bot subsystem's class table */
+	int32 ClassIndex = INDEX_NONE;
+
+	/** Remaining HP */
+	float HP = 0.0f;
+
+	/** HP the bot started with */
+	float MaxHP = 0.0f;
+
+	/** Team ID */
+	uint8 TeamByte = 0;
+
+	/** Squad the bot belongs to */
+	FName SquadName;
+};
+
+/**
+ *  Coarse behavior state of a bot
+ */
+USTRUCT()
+struct PROJECTOPERATOR_API FShooterBotBehaviorFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	/** Location the bot patrols around */
+	FVector HomeLocation = FVector::ZeroVector;
+
+	/** Location the bot is currently heading to */
+	FVector Goal = FVector::ZeroVector;
+
+	/** Current behavior */
+	EShooterBotBehavior Behavior = EShooterBotBehavior::Wait;
+
+	/** Time left in the current wait */
+	float TimeLeft = 0.0f;
+
+	/** Per-bot random stream, so processing order doesn't affect the outcome */
+	FRandomStream RandomStream;
+};
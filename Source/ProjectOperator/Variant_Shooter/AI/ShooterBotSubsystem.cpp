@@ -0,0 +1,364 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterBotSubsystem.h"
+#include "Variant_Shooter/AI/ShooterBotBehaviorProcessor.h"
+#include "Variant_Shooter/AI/ShooterBotFragments.h"
+#include "Variant_Shooter/AI/ShooterNPC.h"
+#include "Variant_Shooter/AI/ShooterNPCPool.h"
+#include "Variant_Shooter/AI/ShooterAIController.h"
+#include "MassEntitySubsystem.h"
+#include "MassEntityManager.h"
+#include "MassExecutor.h"
+#include "MassProcessingTypes.h"
+#include "Components/CapsuleComponent.h"
+#include "NavigationSystem.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "Settings/ShooterAISettings.h"
+#include "ProjectOperator.h"
+
+DECLARE_CYCLE_STAT(TEXT("Bot Hybrid LOD"), STAT_ShooterBotHybridLOD, STATGROUP_ShooterAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Bot Entities"), STAT_ShooterBotEntities, STATGROUP_ShooterAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Bot Actors"), STAT_ShooterBotActors, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bot Promotions"), STAT_ShooterBotPromotions, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bot Demotions"), STAT_ShooterBotDemotions, STATGROUP_ShooterAI);
+
+void UShooterBotSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// the entity subsystem needs to be up before we can create our archetype
+	Collection.InitializeDependency<UMassEntitySubsystem>();
+
+	FMassEntityManager& EntityManager = GetEntityManager();
+
+	BotArchetype = EntityManager.CreateArchetype({
+		FShooterBotTransformFragment::StaticStruct(),
+		FShooterBotStateFragment::StaticStruct(),
+		FShooterBotBehaviorFragment::StaticStruct()
+	});
+
+	BehaviorProcessor = NewObject<UShooterBotBehaviorProcessor>(this);
+	BehaviorProcessor->CallInitialize(this, EntityManager.AsShared());
+}
+
+void UShooterBotSubsystem::Deinitialize()
+{
+	// the entity subsystem may already be gone during world teardown
+	if (UMassEntitySubsystem* EntitySubsystem = GetWorld()->GetSubsystem<UMassEntitySubsystem>())
+	{
+		FMassEntityManager& EntityManager = EntitySubsystem->GetMutableEntityManager();
+
+		for (const FMassEntityHandle& Entity : Bots)
+		{
+			if (EntityManager.IsEntityValid(Entity))
+			{
+				EntityManager.DestroyEntity(Entity);
+			}
+		}
+	}
+
+	Bots.Empty();
+	PromotedNPCs.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UShooterBotSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterBotSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterBotHybridLOD);
+
+	SET_DWORD_STAT(STAT_ShooterBotEntities, Bots.Num());
+	SET_DWORD_STAT(STAT_ShooterBotActors, PromotedNPCs.Num());
+
+	// nothing to do until bots are added
+	if (Bots.IsEmpty() && PromotedNPCs.IsEmpty())
+	{
+		return;
+	}
+
+	// run the coarse simulation for every bot entity
+	if (!Bots.IsEmpty())
+	{
+		FMassProcessingContext ProcessingContext(GetEntityManager(), DeltaTime);
+		UE::Mass::Executor::Run(*BehaviorProcessor, ProcessingContext);
+	}
+
+	// promote and demote on the configured interval
+	TimeUntilLODCheck -= DeltaTime;
+
+	if (TimeUntilLODCheck <= 0.0f)
+	{
+		TimeUntilLODCheck = GetDefault<UShooterAISettings>()->BotLODCheckInterval;
+
+		UpdateHybridLOD();
+	}
+}
+
+TStatId UShooterBotSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterBotSubsystem, STATGROUP_Tickables);
+}
+
+void UShooterBotSubsystem::SpawnBot(TSubclassOf<AShooterNPC> NPCClass, const FTransform& Transform, uint8 TeamByte, FName SquadName)
+{
+	if (!NPCClass)
+	{
+		return;
+	}
+
+	// bots start with the HP set on their class
+	const float MaxHP = NPCClass->GetDefaultObject<AShooterNPC>()->CurrentHP;
+
+	const FVector Location = Transform.GetLocation();
+	const float Yaw = Transform.Rotator().Yaw;
+
+	// bots close to a player need to be fully simulated right away
+	GatherPlayerLocations();
+
+	if (GetDistanceSquaredToNearestPlayer(Location) <= FMath::Square(GetDefault<UShooterAISettings>()->BotPromoteDistance))
+	{
+		if (AShooterNPC* NPC = AcquireNPC(NPCClass, Location, Yaw, MaxHP, MaxHP, TeamByte, SquadName))
+		{
+			PromotedNPCs.Add(NPC);
+		}
+
+	} else {
+
+		CreateBotEntity(GetClassIndex(NPCClass), Location, Yaw, MaxHP, MaxHP, TeamByte, SquadName);
+	}
+}
+
+FMassEntityManager& UShooterBotSubsystem::GetEntityManager() const
+{
+	return GetWorld()->GetSubsystem<UMassEntitySubsystem>()->GetMutableEntityManager();
+}
+
+int32 UShooterBotSubsystem::GetClassIndex(TSubclassOf<AShooterNPC> NPCClass)
+{
+	return BotClasses.AddUnique(NPCClass);
+}
+
+void UShooterBotSubsystem::CreateBotEntity(int32 ClassIndex, const FVector& Location, float Yaw, float HP, float MaxHP, uint8 TeamByte, FName SquadName)
+{
+	FMassEntityManager& EntityManager = GetEntityManager();
+
+	const FMassEntityHandle Entity = EntityManager.CreateEntity(BotArchetype);
+
+	FShooterBotTransformFragment& Transform = EntityManager.GetFragmentDataChecked<FShooterBotTransformFragment>(Entity);
+	Transform.Location = Location;
+	Transform.Yaw = Yaw;
+
+	FShooterBotStateFragment& State = EntityManager.GetFragmentDataChecked<FShooterBotStateFragment>(Entity);
+	State.ClassIndex = ClassIndex;
+	State.HP = HP;
+	State.MaxHP = MaxHP;
+	State.TeamByte = TeamByte;
+	State.SquadName = SquadName;
+
+	// patrol around wherever the bot was left
+	FShooterBotBehaviorFragment& Behavior = EntityManager.GetFragmentDataChecked<FShooterBotBehaviorFragment>(Entity);
+	Behavior.HomeLocation = Location;
+	Behavior.Goal = Location;
+	Behavior.Behavior = EShooterBotBehavior::Wait;
+	Behavior.RandomStream.Initialize(GetTypeHash(Entity));
+	Behavior.TimeLeft = Behavior.RandomStream.FRandRange(0.0f, 2.0f);
+
+	Bots.Add(Entity);
+}
+
+void UShooterBotSubsystem::UpdateHybridLOD()
+{
+	const UShooterAISettings* Settings = GetDefault<UShooterAISettings>();
+
+	GatherPlayerLocations();
+
+	// demote NPCs that have left every player behind and aren't fighting
+	const float DemoteDistanceSquared = FMath::Square(Settings->BotDemoteDistance);
+
+	for (int32 i = PromotedNPCs.Num() - 1; i >= 0; --i)
+	{
+		AShooterNPC* NPC = PromotedNPCs[i].Get();
+
+		// NPCs that died or were pooled elsewhere are no longer ours to manage
+		if (!IsValid(NPC) || NPC->IsDead() || NPC->IsPooled())
+		{
+			PromotedNPCs.RemoveAtSwap(i, EAllowShrinking::No);
+			continue;
+		}
+
+		if (GetDistanceSquaredToNearestPlayer(NPC->GetActorLocation()) < DemoteDistanceSquared)
+		{
+			continue;
+		}
+
+		const AShooterAIController* AIController = Cast<AShooterAIController>(NPC->GetController());
+
+		if (AIController && AIController->GetCurrentTarget())
+		{
+			continue;
+		}
+
+		PromotedNPCs.RemoveAtSwap(i, EAllowShrinking::No);
+		DemoteNPC(NPC);
+	}
+
+	// find the entities within promotion range, nearest first
+	FMassEntityManager& EntityManager = GetEntityManager();
+
+	const float PromoteDistanceSquared = FMath::Square(Settings->BotPromoteDistance);
+
+	TArray<TPair<float, int32>> Candidates;
+
+	for (int32 i = 0; i < Bots.Num(); ++i)
+	{
+		const FShooterBotTransformFragment& Transform = EntityManager.GetFragmentDataChecked<FShooterBotTransformFragment>(Bots[i]);
+		const float DistanceSquared = GetDistanceSquaredToNearestPlayer(Transform.Location);
+
+		if (DistanceSquared <= PromoteDistanceSquared)
+		{
+			Candidates.Add({ DistanceSquared, i });
+		}
+	}
+
+	if (Candidates.IsEmpty())
+	{
+		return;
+	}
+
+	Candidates.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key < B.Key; });
+
+	// spread the spawn cost across checks
+	const int32 NumPromotions = FMath::Min(Candidates.Num(), Settings->MaxBotPromotionsPerCheck);
+
+	TArray<int32> Promoted;
+
+	for (int32 i = 0; i < NumPromotions; ++i)
+	{
+		if (PromoteBot(Bots[Candidates[i].Value]))
+		{
+			Promoted.Add(Candidates[i].Value);
+		}
+	}
+
+	// remove the promoted entities back to front so the remaining indices stay valid
+	Promoted.Sort(TGreater<int32>());
+
+	for (int32 Index : Promoted)
+	{
+		Bots.RemoveAtSwap(Index, EAllowShrinking::No);
+	}
+}
+
+bool UShooterBotSubsystem::PromoteBot(FMassEntityHandle Entity)
+{
+	FMassEntityManager& EntityManager = GetEntityManager();
+
+	const FShooterBotTransformFragment& Transform = EntityManager.GetFragmentDataChecked<FShooterBotTransformFragment>(Entity);
+	const FShooterBotStateFragment& State = EntityManager.GetFragmentDataChecked<FShooterBotStateFragment>(Entity);
+
+	if (!BotClasses.IsValidIndex(State.ClassIndex))
+	{
+		return false;
+	}
+
+	AShooterNPC* NPC = AcquireNPC(BotClasses[State.ClassIndex], Transform.Location, Transform.Yaw, State.HP, State.MaxHP, State.TeamByte, State.SquadName);
+
+	if (!NPC)
+	{
+		// keep simulating the entity and try again on the next check
+		return false;
+	}
+
+	INC_DWORD_STAT(STAT_ShooterBotPromotions);
+
+	PromotedNPCs.Add(NPC);
+
+	EntityManager.DestroyEntity(Entity);
+
+	return true;
+}
+
+void UShooterBotSubsystem::DemoteNPC(AShooterNPC* NPC)
+{
+	INC_DWORD_STAT(STAT_ShooterBotDemotions);
+
+	CreateBotEntity(GetClassIndex(NPC->GetClass()), NPC->GetActorLocation(), NPC->GetActorRotation().Yaw, NPC->CurrentHP, NPC->GetMaxHP(), NPC->GetTeamByte(), NPC->GetSquadName());
+
+	// keep the actor around for the next promotion
+	if (UShooterNPCPool* Pool = GetWorld()->GetSubsystem<UShooterNPCPool>())
+	{
+		Pool->ReleaseNPC(NPC);
+
+	} else {
+
+		NPC->Destroy();
+	}
+}
+
+AShooterNPC* UShooterBotSubsystem::AcquireNPC(TSubclassOf<AShooterNPC> NPCClass, const FVector& Location, float Yaw, float HP, float MaxHP, uint8 TeamByte, FName SquadName)
+{
+	UShooterNPCPool* Pool = GetWorld()->GetSubsystem<UShooterNPCPool>();
+
+	if (!Pool)
+	{
+		return nullptr;
+	}
+
+	// coarse movement ignores the level geometry, so put the capsule back on the navmesh
+	FVector SpawnLocation = Location;
+
+	const float HalfHeight = NPCClass->GetDefaultObject<AShooterNPC>()->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+
+	if (const UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{
+		FNavLocation Projected;
+
+		if (NavSys->ProjectPointToNavigation(Location - FVector(0.0f, 0.0f, HalfHeight), Projected, FVector(500.0f, 500.0f, 1000.0f)))
+		{
+			SpawnLocation = Projected.Location + FVector(0.0f, 0.0f, HalfHeight);
+		}
+	}
+
+	const FTransform Transform(FRotator(0.0f, Yaw, 0.0f), SpawnLocation);
+
+	return Pool->AcquireNPC(NPCClass, Transform, [HP, MaxHP, TeamByte, SquadName](AShooterNPC& NPC)
+	{
+		NPC.ApplyBotState(HP, MaxHP, TeamByte, SquadName);
+	});
+}
+
+void UShooterBotSubsystem::GatherPlayerLocations()
+{
+	PlayerLocations.Reset();
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PC = It->Get();
+
+		if (PC && PC->GetPawn())
+		{
+			PlayerLocations.Add(PC->GetPawn()->GetActorLocation());
+		}
+	}
+}
+
+float UShooterBotSubsystem::GetDistanceSquaredToNearestPlayer(const FVector& Location) const
+{
+	float BestDistanceSquared = MAX_flt;
+
+	for (const FVector& PlayerLocation : PlayerLocations)
+	{
+		BestDistanceSquared = FMath::Min(BestDistanceSquared, FVector::DistSquared(Location, PlayerLocation));
+	}
+
+	return BestDistanceSquared;
+}
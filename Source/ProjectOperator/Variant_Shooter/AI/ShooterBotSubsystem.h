@@ -0,0 +1,111 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MassEntityTypes.h"
+#include "MassArchetypeTypes.h"
+#include "Templates/SubclassOf.h"
+#include "ShooterBotSubsystem.generated.h"
+
+class AShooterNPC;
+class UShooterBotBehaviorProcessor;
+struct FMassEntityManager;
+
+/**
+ *  Hybrid level of detail for shooter bots
+ *  Bots far from every player exist only as lightweight Mass entities with a position, team, HP and coarse behavior,
+ *  simulated in parallel by the bot behavior processor. Bots that come within range of a player are promoted
+ *  to full NPC actors drawn from the NPC pool, and demoted back to entities once they're out of range and out of combat
+ */
+UCLASS()
+class PROJECTOPERATOR_API UShooterBotSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Runs the coarse bot behavior */
+	UPROPERTY()
+	TObjectPtr<UShooterBotBehaviorProcessor> BehaviorProcessor;
+
+	/** NPC classes referenced by bot entities, by class index */
+	UPROPERTY()
+	TArray<TSubclassOf<AShooterNPC>> BotClasses;
+
+	/** Archetype shared by every bot entity */
+	FMassArchetypeHandle BotArchetype;
+
+	/** Bots currently simulated as entities */
+	TArray<FMassEntityHandle> Bots;
+
+	/** Bots currently promoted to full NPC actors */
+	TArray<TWeakObjectPtr<AShooterNPC>> PromotedNPCs;
+
+	/** Locations of every player pawn, gathered for each LOD check */
+	TArray<FVector> PlayerLocations;
+
+	/** Time left until the next promotion and demotion check */
+	float TimeUntilLODCheck = 0.0f;
+
+public:
+
+	/** Subsystem initialization */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Subsystem cleanup */
+	virtual void Deinitialize() override;
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Simulates bot entities and promotes or demotes bots on the configured interval */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable object */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/**
+	 *  Adds a bot managed by the hybrid LOD
+	 *  Bots in range of a player are spawned as full actors right away. The rest start out as entities
+	 */
+	void SpawnBot(TSubclassOf<AShooterNPC> NPCClass, const FTransform& Transform, uint8 TeamByte, FName SquadName);
+
+	/** Returns the number of bots currently simulated as entities */
+	int32 GetNumEntityBots() const { return Bots.Num(); }
+
+	/** Returns the number of bots currently promoted to full actors */
+	int32 GetNumPromotedBots() const { return PromotedNPCs.Num(); }
+
+protected:
+
+	/** Returns the entity manager for this world */
+	FMassEntityManager& GetEntityManager() const;
+
+	/** Returns the class table index for the given NPC class, adding it if needed */
+	int32 GetClassIndex(TSubclassOf<AShooterNPC> NPCClass);
+
+	/** Creates a bot entity */
+	void CreateBotEntity(int32 ClassIndex, const FVector& Location, float Yaw, float HP, float MaxHP, uint8 TeamByte, FName SquadName);
+
+	/** Promotes entities near players and demotes idle NPCs far from them */
+	void UpdateHybridLOD();
+
+	/** Replaces a bot entity with a full NPC actor. Returns false if the NPC couldn't be spawned */
+	bool PromoteBot(FMassEntityHandle Entity);
+
+	/** Replaces a full NPC actor with a bot entity */
+	void DemoteNPC(AShooterNPC* NPC);
+
+	/** Spawns or reuses a full NPC actor with the given state */
+	AShooterNPC* AcquireNPC(TSubclassOf<AShooterNPC> NPCClass, const FVector& Location, float Yaw, float HP, float MaxHP, uint8 TeamByte, FName SquadName);
+
+	/** Gathers the location of every player with a pawn */
+	void GatherPlayerLocations();
+
+	/** Returns the squared distance from the location to the nearest player pawn */
+	float GetDistanceSquaredToNearestPlayer(const FVector& Location) const;
+};
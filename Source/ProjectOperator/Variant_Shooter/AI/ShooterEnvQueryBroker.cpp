@@ -0,0 +1,320 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterEnvQueryBroker.h"
+#include "Variant_Shooter/AI/ShooterAIController.h"
+#include "EnvironmentQuery/EnvQuery.h"
+#include "EnvironmentQuery/EnvQueryManager.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+#include "Settings/ShooterAISettings.h"
+#include "ProjectOperator.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("EQS Requests"), STAT_ShooterEQSRequests, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("EQS Shared Requests"), STAT_ShooterEQSShared, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("EQS Queries Started"), STAT_ShooterEQSStarted, STATGROUP_ShooterAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("EQS Queued Queries"), STAT_ShooterEQSQueued, STATGROUP_ShooterAI);
+
+bool UShooterEnvQueryBroker::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterEnvQueryBroker::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const UShooterAISettings* Settings = GetDefault<UShooterAISettings>();
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// discard results too old to share and count the queries still running
+	int32 NumInFlight = 0;
+
+	for (auto It = SharedQueries.CreateIterator(); It; ++It)
+	{
+		const FShooterSharedEnvQuery& Shared = It.Value();
+
+		if (Shared.bFinished)
+		{
+			if (Now - Shared.CompletionTime > Settings->EnvQueryResultLifetime)
+			{
+				It.RemoveCurrent();
+			}
+
+		} else if (Shared.QueryID != INDEX_NONE) {
+
+			++NumInFlight;
+		}
+	}
+
+	// start queued queries within the budget
+	UEnvQueryManager* QueryManager = UEnvQueryManager::GetCurrent(GetWorld());
+	int32 NumStarted = 0;
+	int32 Processed = 0;
+
+	while (Processed < LaunchQueue.Num() && NumStarted < Settings->MaxEnvQueryStartsPerFrame && NumInFlight < Settings->MaxEnvQueriesInFlight)
+	{
+		const int32 SharedID = LaunchQueue[Processed];
+		++Processed;
+
+		// skip queries released while queued
+		FShooterSharedEnvQuery* Shared = SharedQueries.Find(SharedID);
+
+		if (!Shared)
+		{
+			continue;
+		}
+
+		// fail queries whose querier or template are gone
+		if (!QueryManager || !Shared->Querier.IsValid() || !Shared->Template.IsValid())
+		{
+			FailRequests(SharedID);
+			SharedQueries.Remove(SharedID);
+			continue;
+		}
+
+		// run all matching so squad members can be handed different items
+		FEnvQueryRequest QueryRequest(Shared->Template.Get(), Shared->Querier.Get());
+		Shared->QueryID = QueryRequest.Execute(EEnvQueryRunMode::AllMatching, FQueryFinishedSignature::CreateUObject(this, &UShooterEnvQueryBroker::OnQueryFinished));
+
+		++NumStarted;
+		++NumInFlight;
+
+		INC_DWORD_STAT(STAT_ShooterEQSStarted);
+	}
+
+	LaunchQueue.RemoveAt(0, Processed, EAllowShrinking::No);
+
+	SET_DWORD_STAT(STAT_ShooterEQSQueued, LaunchQueue.Num());
+}
+
+TStatId UShooterEnvQueryBroker::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterEnvQueryBroker, STATGROUP_Tickables);
+}
+
+int32 UShooterEnvQueryBroker::RequestQuery(const UEnvQuery* Template, AShooterAIController* Querier)
+{
+	// ensure the template and querier are valid
+	if (!IsValid(Template) || !IsValid(Querier) || !Querier->GetPawn())
+	{
+		return INDEX_NONE;
+	}
+
+	INC_DWORD_STAT(STAT_ShooterEQSRequests);
+
+	const AActor* Target = Querier->GetCurrentTarget();
+	const FVector QuerierLocation = Querier->GetPawn()->GetActorLocation();
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// try to piggyback on an equivalent query
+	int32 SharedID = FindSharedQuery(Template, Target, QuerierLocation, Now);
+
+	if (SharedID == INDEX_NONE)
+	{
+		// queue a new query run as this querier
+		SharedID = NextSharedID++;
+
+		FShooterSharedEnvQuery& Shared = SharedQueries.Add(SharedID);
+		Shared.Template = Template;
+		Shared.Target = Target;
+		Shared.Querier = Querier;
+		Shared.QuerierLocation = QuerierLocation;
+
+		LaunchQueue.Add(SharedID);
+
+	} else {
+
+		INC_DWORD_STAT(STAT_ShooterEQSShared);
+	}
+
+	const int32 RequestID = NextRequestID++;
+
+	FShooterEnvQueryRequest& Request = Requests.Add(RequestID);
+	Request.SharedID = SharedID;
+
+	// answer right away if the shared query already finished
+	FShooterSharedEnvQuery& Shared = SharedQueries.FindChecked(SharedID);
+
+	if (Shared.bFinished)
+	{
+		ResolveRequest(Request, Shared);
+	}
+
+	return RequestID;
+}
+
+EShooterEnvQueryStatus UShooterEnvQueryBroker::GetRequestStatus(int32 RequestID, FVector& OutLocation) const
+{
+	const FShooterEnvQueryRequest* Request = Requests.Find(RequestID);
+
+	if (!Request)
+	{
+		return EShooterEnvQueryStatus::Failed;
+	}
+
+	OutLocation = Request->Location;
+	return Request->Status;
+}
+
+void UShooterEnvQueryBroker::ReleaseRequest(int32 RequestID)
+{
+	FShooterEnvQueryRequest Request;
+
+	if (!Requests.RemoveAndCopyValue(RequestID, Request))
+	{
+		return;
+	}
+
+	// keep the shared query alive if it has finished or somebody else is still waiting on it
+	const FShooterSharedEnvQuery* Shared = SharedQueries.Find(Request.SharedID);
+
+	if (!Shared || Shared->bFinished || HasPendingRequests(Request.SharedID))
+	{
+		return;
+	}
+
+	// abort the query if it's running
+	if (Shared->QueryID != INDEX_NONE)
+	{
+		if (UEnvQueryManager* QueryManager = UEnvQueryManager::GetCurrent(GetWorld()))
+		{
+			QueryManager->AbortQuery(Shared->QueryID);
+		}
+	}
+
+	LaunchQueue.Remove(Request.SharedID);
+	SharedQueries.Remove(Request.SharedID);
+}
+
+int32 UShooterEnvQueryBroker::FindSharedQuery(const UEnvQuery* Template, const AActor* Target, const FVector& QuerierLocation, double Now) const
+{
+	// without a target the context resolves to each querier, so there's nothing to share
+	if (!Target)
+	{
+		return INDEX_NONE;
+	}
+
+	const UShooterAISettings* Settings = GetDefault<UShooterAISettings>();
+	const float ShareRadiusSquared = FMath::Square(Settings->EnvQueryShareRadius);
+
+	for (const TPair<int32, FShooterSharedEnvQuery>& Pair : SharedQueries)
+	{
+		const FShooterSharedEnvQuery& Shared = Pair.Value;
+
+		if (Shared.Template != Template || Shared.Target != Target)
+		{
+			continue;
+		}
+
+		if (Shared.bFinished && Now - Shared.CompletionTime > Settings->EnvQueryResultLifetime)
+		{
+			continue;
+		}
+
+		if (FVector::DistSquared(Shared.QuerierLocation, QuerierLocation) <= ShareRadiusSquared)
+		{
+			return Pair.Key;
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+void UShooterEnvQueryBroker::OnQueryFinished(TSharedPtr<FEnvQueryResult> Result)
+{
+	if (!Result.IsValid())
+	{
+		return;
+	}
+
+	// find the shared query this result belongs to. It may have been released in the meantime
+	for (TPair<int32, FShooterSharedEnvQuery>& Pair : SharedQueries)
+	{
+		FShooterSharedEnvQuery& Shared = Pair.Value;
+
+		if (Shared.bFinished || Shared.QueryID != Result->QueryID)
+		{
+			continue;
+		}
+
+		Shared.Result = Result;
+		Shared.bFinished = true;
+		Shared.QueryID = INDEX_NONE;
+		Shared.CompletionTime = GetWorld()->GetTimeSeconds();
+
+		// answer everybody waiting on it
+		for (TPair<int32, FShooterEnvQueryRequest>& RequestPair : Requests)
+		{
+			FShooterEnvQueryRequest& Request = RequestPair.Value;
+
+			if (Request.SharedID == Pair.Key && Request.Status == EShooterEnvQueryStatus::Pending)
+			{
+				ResolveRequest(Request, Shared);
+			}
+		}
+
+		return;
+	}
+}
+
+void UShooterEnvQueryBroker::ResolveRequest(FShooterEnvQueryRequest& Request, FShooterSharedEnvQuery& Shared)
+{
+	const FEnvQueryResult* Result = Shared.Result.Get();
+
+	if (!Result || !Result->IsSuccessful() || Result->Items.IsEmpty())
+	{
+		Request.Status = EShooterEnvQueryStatus::Failed;
+		return;
+	}
+
+	const float ClaimRadiusSquared = FMath::Square(GetDefault<UShooterAISettings>()->EnvQueryClaimRadius);
+
+	// items are sorted by score, so take the best one no squad member has claimed yet
+	int32 PickedIndex = 0;
+
+	for (int32 i = 0; i < Result->Items.Num(); ++i)
+	{
+		const FVector ItemLocation = Result->GetItemAsLocation(i);
+
+		const bool bClaimed = Shared.ClaimedLocations.ContainsByPredicate([&ItemLocation, ClaimRadiusSquared](const FVector& Claimed)
+		{
+			return FVector::DistSquared(Claimed, ItemLocation) < ClaimRadiusSquared;
+		});
+
+		if (!bClaimed)
+		{
+			PickedIndex = i;
+			break;
+		}
+	}
+
+	Request.Location = Result->GetItemAsLocation(PickedIndex);
+	Request.Status = EShooterEnvQueryStatus::Succeeded;
+
+	Shared.ClaimedLocations.Add(Request.Location);
+}
+
+void UShooterEnvQueryBroker::FailRequests(int32 SharedID)
+{
+	for (TPair<int32, FShooterEnvQueryRequest>& Pair : Requests)
+	{
+		if (Pair.Value.SharedID == SharedID)
+		{
+			Pair.Value.Status = EShooterEnvQueryStatus::Failed;
+		}
+	}
+}
+
+bool UShooterEnvQueryBroker::HasPendingRequests(int32 SharedID) const
+{
+	for (const TPair<int32, FShooterEnvQueryRequest>& Pair : Requests)
+	{
+		if (Pair.Value.SharedID == SharedID && Pair.Value.Status == EShooterEnvQueryStatus::Pending)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,139 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EnvironmentQuery/EnvQueryTypes.h"
+#include "ShooterEnvQueryBroker.generated.h"
+
+class UEnvQuery;
+class AShooterAIController;
+
+/**
+ *  Status of a brokered EQS request
+ */
+enum class EShooterEnvQueryStatus : uint8
+{
+	Pending,
+	Succeeded,
+	Failed
+};
+
+/**
+ *  EQS query run once on behalf of every nearby NPC asking the same question about the same target
+ */
+struct FShooterSharedEnvQuery
+{
+	/** Query template being run */
+	TWeakObjectPtr<const UEnvQuery> Template;
+
+	/** Target provided to the query through the Target context */
+	TWeakObjectPtr<const AActor> Target;
+
+	/** Controller the query is run as */
+	TWeakObjectPtr<AShooterAIController> Querier;
+
+	/** Querier location when the query was requested */
+	FVector QuerierLocation = FVector::ZeroVector;
+
+	/** EQS manager ID while running */
+	int32 QueryID = INDEX_NONE;
+
+	/** Scored items, once finished */
+	TSharedPtr<FEnvQueryResult> Result;
+
+	/** Locations already handed out to requesters */
+	TArray<FVector> ClaimedLocations;
+
+	/** Game time the query finished at */
+	double CompletionTime = 0.0;
+
+	/** True once the query has finished */
+	bool bFinished = false;
+};
+
+/**
+ *  Single NPC's request for a brokered EQS query
+ */
+struct FShooterEnvQueryRequest
+{
+	/** Shared query answering this request */
+	int32 SharedID = INDEX_NONE;
+
+	/** Current status */
+	EShooterEnvQueryStatus Status = EShooterEnvQueryStatus::Pending;
+
+	/** Location picked for this requester */
+	FVector Location = FVector::ZeroVector;
+};
+
+/**
+ *  Squad-shared EQS query broker for the shooter AI
+ *  Equivalent queries from nearby NPCs against the same target share a single run and its scored items
+ *  Queries are started under a global per-frame and in flight budget
+ */
+UCLASS()
+class PROJECTOPERATOR_API UShooterEnvQueryBroker : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Shared queries, by shared ID */
+	TMap<int32, FShooterSharedEnvQuery> SharedQueries;
+
+	/** Shared queries waiting to be started, in request order */
+	TArray<int32> LaunchQueue;
+
+	/** Requests, by request ID */
+	TMap<int32, FShooterEnvQueryRequest> Requests;
+
+	/** ID to assign to the next shared query */
+	int32 NextSharedID = 0;
+
+	/** ID to assign to the next request */
+	int32 NextRequestID = 0;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Starts queued queries within the budget and discards expired results */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable object */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/**
+	 *  Requests a location from the given query template, run as the given controller
+	 *  Returns the request ID, or INDEX_NONE if the request is invalid
+	 */
+	int32 RequestQuery(const UEnvQuery* Template, AShooterAIController* Querier);
+
+	/** Returns the status of a request and, once it has succeeded, the location picked for it */
+	EShooterEnvQueryStatus GetRequestStatus(int32 RequestID, FVector& OutLocation) const;
+
+	/** Discards a request. Shared queries nobody is waiting on anymore are aborted */
+	void ReleaseRequest(int32 RequestID);
+
+protected:
+
+	/** Returns the ID of a shared query that can answer the request, or INDEX_NONE */
+	int32 FindSharedQuery(const UEnvQuery* Template, const AActor* Target, const FVector& QuerierLocation, double Now) const;
+
+	/** Handles EQS query completion */
+	void OnQueryFinished(TSharedPtr<FEnvQueryResult> Result);
+
+	/** Picks a location for the request from the shared query's items, avoiding those already claimed */
+	void ResolveRequest(FShooterEnvQueryRequest& Request, FShooterSharedEnvQuery& Shared);
+
+	/** Fails every request waiting on the given shared query */
+	void FailRequests(int32 SharedID);
+
+	/** Returns true if any pending request is waiting on the given shared query */
+	bool HasPendingRequests(int32 SharedID) const;
+};
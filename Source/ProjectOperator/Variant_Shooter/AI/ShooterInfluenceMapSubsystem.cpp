@@ -0,0 +1,311 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterInfluenceMapSubsystem.h"
+#include "Variant_Shooter/ShooterTeams.h"
+#include "Variant_Shooter/AI/ShooterNPC.h"
+#include "GenericTeamAgentInterface.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Settings/ShooterAISettings.h"
+#include "ProjectOperator.h"
+
+DECLARE_CYCLE_STAT(TEXT("Influence Map Update"), STAT_ShooterInfluenceUpdate, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Influence Map Splats"), STAT_ShooterInfluenceSplats, STATGROUP_ShooterAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Influence Map Layers"), STAT_ShooterInfluenceLayers, STATGROUP_ShooterAI);
+
+void UShooterInfluenceMapSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const UShooterAISettings* Settings = GetDefault<UShooterAISettings>();
+
+	// keep rows a multiple of the vector width, with room on both sides for the neighbor loads
+	NumCells = Align(Settings->InfluenceMapCells, 4);
+	RowStride = NumCells + 8;
+	LayerSize = RowStride * (NumCells + 2);
+
+	CellSize = Settings->InfluenceMapCellSize;
+	Origin = Settings->InfluenceMapCenter - FVector2D(NumCells * CellSize * 0.5f);
+
+	for (int32& Layer : TeamLayers)
+	{
+		Layer = INDEX_NONE;
+	}
+}
+
+void UShooterInfluenceMapSubsystem::Deinitialize()
+{
+	// the background update reads and writes our buffers
+	UpdateTask.Wait();
+
+	Super::Deinitialize();
+}
+
+bool UShooterInfluenceMapSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterInfluenceMapSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	PendingDeltaTime += DeltaTime;
+
+	// let the previous update finish. Splats keep queueing in the meantime
+	if (!UpdateTask.IsCompleted())
+	{
+		return;
+	}
+
+	// publish the previous update's result
+	if (UpdateTask.IsValid())
+	{
+		Swap(FrontBuffer, BackBuffer);
+		UpdateTask = UE::Tasks::FTask();
+	}
+
+	const UShooterAISettings* Settings = GetDefault<UShooterAISettings>();
+
+	// splat every player's position
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APawn* Pawn = It->Get() ? It->Get()->GetPawn() : nullptr;
+		uint8 Team;
+
+		if (Pawn && GetActorTeam(Pawn, Team))
+		{
+			PendingSplats.Add({ Team, false, Pawn->GetActorLocation(), Settings->PlayerInfluence });
+		}
+	}
+
+	// resolve the splats to layers and cells. Layers can only be added while no update is running
+	struct FResolvedSplat
+	{
+		int32 Layer;
+		int32 X;
+		int32 Y;
+		float Strength;
+	};
+
+	TArray<FResolvedSplat> Splats;
+	Splats.Reserve(PendingSplats.Num());
+
+	for (const FShooterInfluenceSplat& Splat : PendingSplats)
+	{
+		const FVector2D Local = (FVector2D(Splat.Location) - Origin) / CellSize;
+		const int32 X = FMath::FloorToInt32(Local.X);
+		const int32 Y = FMath::FloorToInt32(Local.Y);
+
+		if (X < 0 || Y < 0 || X >= NumCells || Y >= NumCells)
+		{
+			continue;
+		}
+
+		if (Splat.bHostileTeams)
+		{
+			for (int32 Layer = 0; Layer < LayerTeams.Num(); ++Layer)
+			{
+				if (FShooterTeamAttitudes::IsHostile(LayerTeams[Layer], Splat.Team))
+				{
+					Splats.Add({ Layer, X, Y, Splat.Strength });
+				}
+			}
+
+		} else {
+
+			Splats.Add({ FindOrAddLayer(Splat.Team), X, Y, Splat.Strength });
+		}
+	}
+
+	PendingSplats.Reset();
+
+	INC_DWORD_STAT_BY(STAT_ShooterInfluenceSplats, Splats.Num());
+	SET_DWORD_STAT(STAT_ShooterInfluenceLayers, LayerTeams.Num());
+
+	if (LayerTeams.IsEmpty())
+	{
+		return;
+	}
+
+	// convert the half life into a decay factor for the time since the last update
+	const float Decay = FMath::Exp2(-PendingDeltaTime / Settings->InfluenceHalfLife);
+	const float Falloff = Settings->InfluencePropagation;
+	const int32 Radius = Settings->InfluenceSplatRadius;
+	const int32 NumLayers = LayerTeams.Num();
+
+	PendingDeltaTime = 0.0f;
+
+	// decay, propagate and splat into the back buffer on a worker thread
+	UpdateTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, Splats = MoveTemp(Splats), Decay, Falloff, Radius, NumLayers]()
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ShooterInfluenceUpdate);
+
+		for (int32 Layer = 0; Layer < NumLayers; ++Layer)
+		{
+			PropagateLayer(FrontBuffer.GetData() + Layer * LayerSize, BackBuffer.GetData() + Layer * LayerSize, NumCells, RowStride, Decay, Falloff);
+		}
+
+		for (const FResolvedSplat& Splat : Splats)
+		{
+			ApplySplat(BackBuffer.GetData() + Splat.Layer * LayerSize, NumCells, RowStride, Splat.X, Splat.Y, Radius, Splat.Strength);
+		}
+	});
+}
+
+TStatId UShooterInfluenceMapSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterInfluenceMapSubsystem, STATGROUP_Tickables);
+}
+
+float UShooterInfluenceMapSubsystem::GetInfluence(uint8 Team, const FVector& Location) const
+{
+	const int32 Layer = TeamLayers[Team];
+	const int32 Cell = GetCellIndex(Location);
+
+	if (Layer == INDEX_NONE || Cell == INDEX_NONE)
+	{
+		return 0.0f;
+	}
+
+	return FrontBuffer[Layer * LayerSize + Cell];
+}
+
+float UShooterInfluenceMapSubsystem::GetThreat(uint8 Team, const FVector& Location) const
+{
+	const int32 Cell = GetCellIndex(Location);
+
+	if (Cell == INDEX_NONE)
+	{
+		return 0.0f;
+	}
+
+	float Threat = 0.0f;
+
+	for (int32 Layer = 0; Layer < LayerTeams.Num(); ++Layer)
+	{
+		if (FShooterTeamAttitudes::IsHostile(LayerTeams[Layer], Team))
+		{
+			Threat += FrontBuffer[Layer * LayerSize + Cell];
+		}
+	}
+
+	return Threat;
+}
+
+void UShooterInfluenceMapSubsystem::ReportNoise(const AActor* Instigator, const FVector& Location)
+{
+	uint8 Team;
+
+	if (GetActorTeam(Instigator, Team))
+	{
+		PendingSplats.Add({ Team, false, Location, GetDefault<UShooterAISettings>()->ShotInfluence });
+	}
+}
+
+void UShooterInfluenceMapSubsystem::ReportDeath(const AActor* Victim)
+{
+	uint8 Team;
+
+	// the victim's enemies made this place deadly for its team
+	if (GetActorTeam(Victim, Team))
+	{
+		PendingSplats.Add({ Team, true, Victim->GetActorLocation(), GetDefault<UShooterAISettings>()->DeathInfluence });
+	}
+}
+
+bool UShooterInfluenceMapSubsystem::GetActorTeam(const AActor* Actor, uint8& OutTeam)
+{
+	// pooled NPCs have no presence on the map
+	if (AShooterNPC::IsPooledNPC(Actor))
+	{
+		return false;
+	}
+
+	const FGenericTeamId TeamId = FGenericTeamId::GetTeamIdentifier(Actor);
+
+	if (TeamId == FGenericTeamId::NoTeam)
+	{
+		return false;
+	}
+
+	OutTeam = TeamId.GetId();
+	return true;
+}
+
+int32 UShooterInfluenceMapSubsystem::GetCellIndex(const FVector& Location) const
+{
+	const FVector2D Local = (FVector2D(Location) - Origin) / CellSize;
+	const int32 X = FMath::FloorToInt32(Local.X);
+	const int32 Y = FMath::FloorToInt32(Local.Y);
+
+	if (X < 0 || Y < 0 || X >= NumCells || Y >= NumCells)
+	{
+		return INDEX_NONE;
+	}
+
+	// skip the padding row and the leading padding of the row
+	return (Y + 1) * RowStride + 4 + X;
+}
+
+int32 UShooterInfluenceMapSubsystem::FindOrAddLayer(uint8 Team)
+{
+	if (TeamLayers[Team] == INDEX_NONE)
+	{
+		TeamLayers[Team] = LayerTeams.Add(Team);
+
+		// padding stays zero forever, so the kernels never need bounds checks
+		FrontBuffer.AddZeroed(LayerSize);
+		BackBuffer.AddZeroed(LayerSize);
+	}
+
+	return TeamLayers[Team];
+}
+
+void UShooterInfluenceMapSubsystem::PropagateLayer(const float* Source, float* Destination, int32 NumCells, int32 RowStride, float Decay, float Falloff)
+{
+	const VectorRegister4Float DecayVector = VectorSetFloat1(Decay);
+	const VectorRegister4Float FalloffVector = VectorSetFloat1(Falloff);
+
+	for (int32 Y = 0; Y < NumCells; ++Y)
+	{
+		const int32 RowStart = (Y + 1) * RowStride + 4;
+
+		for (int32 X = 0; X < NumCells; X += 4)
+		{
+			const int32 i = RowStart + X;
+
+			const VectorRegister4Float Center = VectorLoad(Source + i);
+			const VectorRegister4Float Left = VectorLoad(Source + i - 1);
+			const VectorRegister4Float Right = VectorLoad(Source + i + 1);
+			const VectorRegister4Float Up = VectorLoad(Source + i - RowStride);
+			const VectorRegister4Float Down = VectorLoad(Source + i + RowStride);
+
+			// spread the strongest neighbor into the cell, then decay everything
+			const VectorRegister4Float Neighbors = VectorMultiply(VectorMax(VectorMax(Left, Right), VectorMax(Up, Down)), FalloffVector);
+
+			VectorStore(VectorMultiply(VectorMax(Center, Neighbors), DecayVector), Destination + i);
+		}
+	}
+}
+
+void UShooterInfluenceMapSubsystem::ApplySplat(float* Layer, int32 NumCells, int32 RowStride, int32 CenterX, int32 CenterY, int32 Radius, float Strength)
+{
+	for (int32 Y = FMath::Max(0, CenterY - Radius); Y <= FMath::Min(NumCells - 1, CenterY + Radius); ++Y)
+	{
+		for (int32 X = FMath::Max(0, CenterX - Radius); X <= FMath::Min(NumCells - 1, CenterX + Radius); ++X)
+		{
+			const float Distance = FMath::Sqrt(static_cast<float>(FMath::Square(X - CenterX) + FMath::Square(Y - CenterY)));
+
+			if (Distance > Radius)
+			{
+				continue;
+			}
+
+			// fall off linearly towards the edge of the splat
+			float& Cell = Layer[(Y + 1) * RowStride + 4 + X];
+			Cell = FMath::Max(Cell, Strength * (1.0f - Distance / (Radius + 1)));
+		}
+	}
+}
@@ -0,0 +1,124 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tasks/Task.h"
+#include "ShooterInfluenceMapSubsystem.generated.h"
+
+/**
+ *  Influence to add to the map on the next update
+ */
+struct FShooterInfluenceSplat
+{
+	/** Team the influence belongs to */
+	uint8 Team = 0;
+
+	/** If true, the influence is added to every team hostile to this one instead */
+	bool bHostileTeams = false;
+
+	/** World location of the splat */
+	FVector Location = FVector::ZeroVector;
+
+	/** Influence at the center of the splat */
+	float Strength = 0.0f;
+};
+
+/**
+ *  Team-keyed 2D influence map for the shooter AI
+ *  Players, shots and deaths are splatted into one layer per team
+ *  Layers are decayed and propagated on a background task with 4-wide vector kernels,
+ *  while the game thread reads the last completed result through O(1) lookups
+ */
+UCLASS()
+class PROJECTOPERATOR_API UShooterInfluenceMapSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Team of each layer, in layer order */
+	TArray<uint8> LayerTeams;
+
+	/** Layer index for each team, or INDEX_NONE */
+	TStaticArray<int32, 256> TeamLayers;
+
+	/** Last completed influence values for all layers. Read by the game thread */
+	TArray<float> FrontBuffer;
+
+	/** Influence values being computed by the background task */
+	TArray<float> BackBuffer;
+
+	/** Splats waiting for the next update */
+	TArray<FShooterInfluenceSplat> PendingSplats;
+
+	/** Background update in flight */
+	UE::Tasks::FTask UpdateTask;
+
+	/** Time accumulated since the last update was launched */
+	float PendingDeltaTime = 0.0f;
+
+	/** Number of cells along each side */
+	int32 NumCells = 0;
+
+	/** Floats per row, including padding on both sides for the neighbor loads */
+	int32 RowStride = 0;
+
+	/** Floats per layer, including the padding rows */
+	int32 LayerSize = 0;
+
+	/** World location of the minimum corner of the map */
+	FVector2D Origin = FVector2D::ZeroVector;
+
+	/** Size of each cell */
+	float CellSize = 0.0f;
+
+public:
+
+	/** Subsystem initialization */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Subsystem cleanup */
+	virtual void Deinitialize() override;
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Collects splats and launches the next background update once the previous one is done */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable object */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/** Returns the influence of the given team at a location */
+	float GetInfluence(uint8 Team, const FVector& Location) const;
+
+	/** Returns the combined influence of every team hostile to the given one at a location */
+	float GetThreat(uint8 Team, const FVector& Location) const;
+
+	/** Records a shot or impact noise made by the instigator */
+	void ReportNoise(const AActor* Instigator, const FVector& Location);
+
+	/** Records a character death */
+	void ReportDeath(const AActor* Victim);
+
+	/** Returns the team of an actor through its team agent interface. Returns false for actors without a team */
+	static bool GetActorTeam(const AActor* Actor, uint8& OutTeam);
+
+protected:
+
+	/** Returns the index of the cell containing the location, or INDEX_NONE if it's outside the map */
+	int32 GetCellIndex(const FVector& Location) const;
+
+	/** Returns the layer index for a team, adding a layer if needed */
+	int32 FindOrAddLayer(uint8 Team);
+
+	/** Decays and propagates a source layer into a destination layer */
+	static void PropagateLayer(const float* Source, float* Destination, int32 NumCells, int32 RowStride, float Decay, float Falloff);
+
+	/** Adds a splat to a layer */
+	static void ApplySplat(float* Layer, int32 NumCells, int32 RowStride, int32 CenterX, int32 CenterY, int32 Radius, float Strength);
+};
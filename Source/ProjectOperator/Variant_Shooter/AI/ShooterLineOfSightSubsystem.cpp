@@ -0,0 +1,525 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterLineOfSightSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Camera/CameraComponent.h"
+#include "ProjectOperatorCharacter.h"
+#include "Settings/ShooterAISettings.h"
+#include "ShooterVisibilityGrid.h"
+#include "ShooterNPC.h"
+#include "ProjectOperator.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("LOS Async Traces"), STAT_ShooterLOSAsyncTraces, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("LOS Sync Traces"), STAT_ShooterLOSSyncTraces, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("LOS Queries"), STAT_ShooterLOSQueries, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("LOS Grid Rejections"), STAT_ShooterLOSGridRejections, STATGROUP_ShooterAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("LOS Queued Refreshes"), STAT_ShooterLOSQueued, STATGROUP_ShooterAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("LOS Cached Pairs"), STAT_ShooterLOSEntries, STATGROUP_ShooterAI);
+
+void UShooterLineOfSightSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// bind the async trace delegate
+	TraceDelegate.BindUObject(this, &UShooterLineOfSightSubsystem::OnTraceCompleted);
+}
+
+void UShooterLineOfSightSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// find the grid baked for this level. PIE worlds carry a prefix on their package name
+	const FString MapName = UWorld::RemovePIEPrefix(InWorld.GetOutermost()->GetName());
+
+	for (const TPair<TSoftObjectPtr<UWorld>, TSoftObjectPtr<UShooterVisibilityGrid>>& Pair : GetDefault<UShooterAISettings>()->VisibilityGrids)
+	{
+		if (Pair.Key.ToSoftObjectPath().GetLongPackageName() == MapName)
+		{
+			VisibilityGrid = Pair.Value.LoadSynchronous();
+			break;
+		}
+	}
+}
+
+bool UShooterLineOfSightSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterLineOfSightSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// drop entries nobody is interested in anymore
+	PruneEntries(Now);
+
+	// issue as many queued refreshes as the remaining frame budget allows
+	int32 Processed = 0;
+
+	while (Processed < RefreshQueue.Num() && ConsumeTraceBudget(0) > 0)
+	{
+		const FShooterLineOfSightKey& Key = RefreshQueue[Processed];
+		++Processed;
+
+		// skip entries that were pruned or whose actors are gone
+		const FShooterLineOfSightEntry* Entry = Entries.Find(Key);
+
+		if (!Entry || !Key.Observer.IsValid() || !Key.Target.IsValid())
+		{
+			continue;
+		}
+
+		ConsumeTraceBudget(1);
+		IssueTrace(Key, *Entry);
+	}
+
+	RefreshQueue.RemoveAt(0, Processed, EAllowShrinking::No);
+
+	SET_DWORD_STAT(STAT_ShooterLOSQueued, RefreshQueue.Num());
+	SET_DWORD_STAT(STAT_ShooterLOSEntries, Entries.Num());
+}
+
+TStatId UShooterLineOfSightSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterLineOfSightSubsystem, STATGROUP_Tickables);
+}
+
+bool UShooterLineOfSightSubsystem::QueryLineOfSight(const AActor* Observer, const AActor* Target, int32 NumVerticalChecks /*= 1*/, bool bResolveUnknownNow /*= false*/)
+{
+	// ensure both actors are valid. Pooled NPCs can't be seen even though they have no collision to block the trace
+	if (!IsValid(Observer) || !IsValid(Target) || AShooterNPC::IsPooledNPC(Target))
+	{
+		return false;
+	}
+
+	INC_DWORD_STAT(STAT_ShooterLOSQueries);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	const FShooterLineOfSightKey Key { Observer, Target };
+	FShooterLineOfSightEntry& Entry = Entries.FindOrAdd(Key);
+
+	// keep the entry alive and use the finest vertical resolution anyone has asked for
+	Entry.LastQueryTime = Now;
+	Entry.NumVerticalChecks = FMath::Max(Entry.NumVerticalChecks, NumVerticalChecks);
+
+	// pairs in cells that can never see each other don't need a trace
+	if (!Entry.bRefreshPending && !MayBeVisible(GetObserverEyeLocation(Observer), Target->GetActorLocation()))
+	{
+		INC_DWORD_STAT(STAT_ShooterLOSGridRejections);
+
+		CompleteEntry(Key, Entry, false);
+		return false;
+	}
+
+	// resolve unknown pairs right away if the caller can't wait for the async refresh, as long as the budget allows.
+	// Otherwise they fall through to the regular refresh queue
+	bool bHasLineOfSight = false;
+
+	if (!Entry.bIsKnown && bResolveUnknownNow && TraceNow(Key, Entry, bHasLineOfSight))
+	{
+		CompleteEntry(Key, Entry, bHasLineOfSight);
+		return bHasLineOfSight;
+	}
+
+	// queue a refresh if the verdict is unknown or stale
+	const float RefreshInterval = GetDefault<UShooterAISettings>()->LineOfSightRefreshInterval;
+
+	if (!Entry.bIsKnown || Now - Entry.LastUpdateTime > RefreshInterval)
+	{
+		QueueRefresh(Key, Entry);
+	}
+
+	return Entry.bHasLineOfSight;
+}
+
+EShooterLineOfSight UShooterLineOfSightSubsystem::QueryLineOfSightNow(const AActor* Observer, const AActor* Target, int32 NumVerticalChecks /*= 1*/)
+{
+	const bool bHasLineOfSight = QueryLineOfSight(Observer, Target, NumVerticalChecks, true);
+
+	// invalid pairs don't get an entry, and are never visible
+	const FShooterLineOfSightEntry* Entry = Entries.Find(FShooterLineOfSightKey { Observer, Target });
+
+	if (Entry && !Entry->bIsKnown)
+	{
+		return EShooterLineOfSight::Unknown;
+	}
+
+	return bHasLineOfSight ? EShooterLineOfSight::Visible : EShooterLineOfSight::Blocked;
+}
+
+void UShooterLineOfSightSubsystem::RequestLineOfSightBatch(const AActor* Observer, const TArray<AActor*>& Targets, FShooterLineOfSightBatchDelegate OnCompleted)
+{
+	const uint32 BatchID = NextBatchID++;
+
+	FShooterLineOfSightBatch& Batch = Batches.Add(BatchID);
+	Batch.Results.Init(false, Targets.Num());
+	Batch.OnCompleted = MoveTemp(OnCompleted);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const float RefreshInterval = GetDefault<UShooterAISettings>()->LineOfSightRefreshInterval;
+
+	const FVector Start = IsValid(Observer) ? GetObserverEyeLocation(Observer) : FVector::ZeroVector;
+
+	// grid rejections are cached once the batch is set up, since that may complete other batches waiting on them
+	TArray<FShooterLineOfSightKey> Rejected;
+
+	for (int32 i = 0; i < Targets.Num(); ++i)
+	{
+		const FShooterLineOfSightKey& Key = Batch.Keys.Add_GetRef({ Observer, Targets[i] });
+
+		// invalid pairs and pooled NPCs never have line of sight
+		if (!IsValid(Observer) || !IsValid(Targets[i]) || AShooterNPC::IsPooledNPC(Targets[i]))
+		{
+			continue;
+		}
+
+		// cache every batched verdict, so later queries for the same pair are free
+		FShooterLineOfSightEntry& Entry = Entries.FindOrAdd(Key);
+		Entry.LastQueryTime = Now;
+
+		// use the cached verdict if it's still fresh
+		if (Entry.bIsKnown && Now - Entry.LastUpdateTime <= RefreshInterval)
+		{
+			Batch.Results[i] = Entry.bHasLineOfSight;
+			continue;
+		}
+
+		// skip the trace for cells that can never see each other
+		if (!MayBeVisible(Start, Targets[i]->GetActorLocation()))
+		{
+			INC_DWORD_STAT(STAT_ShooterLOSGridRejections);
+
+			Rejected.Add(Key);
+			continue;
+		}
+
+		// wait for the refresh if the pair is already being traced, or if we're out of trace budget this frame
+		if (Entry.bRefreshPending || ConsumeTraceBudget(0) <= 0)
+		{
+			QueueRefresh(Key, Entry);
+
+			WaitingBatchTargets.Add(Key, TPair<uint32, int32>(BatchID, i));
+			++Batch.PendingTraces;
+			continue;
+		}
+
+		// batched traces are issued together and count towards the frame budget
+		ConsumeTraceBudget(1);
+		INC_DWORD_STAT(STAT_ShooterLOSAsyncTraces);
+
+		const uint32 TraceID = NextTraceID++;
+		InFlightBatchTraces.Add(TraceID, TPair<uint32, int32>(BatchID, i));
+		++Batch.PendingTraces;
+
+		GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start, GetCheckLocation(Targets[i], 0, 1), ECC_Visibility, MakeQueryParams(Key), FCollisionResponseParams::DefaultResponseParam, &TraceDelegate, TraceID);
+	}
+
+	// complete right away if every verdict was cached
+	if (Batch.PendingTraces == 0)
+	{
+		FShooterLineOfSightBatch CompletedBatch;
+		Batches.RemoveAndCopyValue(BatchID, CompletedBatch);
+
+		CompletedBatch.OnCompleted.ExecuteIfBound(CompletedBatch.Results);
+	}
+
+	for (const FShooterLineOfSightKey& Key : Rejected)
+	{
+		if (FShooterLineOfSightEntry* Entry = Entries.Find(Key))
+		{
+			CompleteEntry(Key, *Entry, false);
+		}
+	}
+}
+
+bool UShooterLineOfSightSubsystem::MayBeVisible(const FVector& From, const FVector& To) const
+{
+	return !VisibilityGrid || VisibilityGrid->MayBeVisible(From, To);
+}
+
+FVector UShooterLineOfSightSubsystem::GetObserverEyeLocation(const AActor* Observer)
+{
+	// characters with a first person camera look from it
+	if (const AProjectOperatorCharacter* Character = Cast<AProjectOperatorCharacter>(Observer))
+	{
+		if (const UCameraComponent* Camera = Character->GetFirstPersonCameraComponent())
+		{
+			return Camera->GetComponentLocation();
+		}
+	}
+
+	// anything else, NPCs included, uses its eyes viewpoint
+	FVector EyeLocation;
+	FRotator EyeRotation;
+	Observer->GetActorEyesViewPoint(EyeLocation, EyeRotation);
+
+	return EyeLocation;
+}
+
+FVector UShooterLineOfSightSubsystem::GetCheckLocation(const AActor* Target, int32 CheckIndex, int32 NumVerticalChecks)
+{
+	// get the target's bounding box
+	FVector CenterOfMass, Extent;
+	Target->GetActorBounds(true, CenterOfMass, Extent, false);
+
+	// a single check aims at the center of the bounds
+	if (NumVerticalChecks <= 1)
+	{
+		return CenterOfMass;
+	}
+
+	// spread the checks from the top of the bounds downwards
+	const float ExtentZOffset = Extent.Z * 2.0f / NumVerticalChecks;
+
+	return CenterOfMass + FVector(0.0f, 0.0f, Extent.Z - ExtentZOffset * CheckIndex);
+}
+
+int32 UShooterLineOfSightSubsystem::GetNumTraces(int32 NumVerticalChecks)
+{
+	// the bottom check is skipped since it would usually hit the floor
+	return FMath::Max(1, NumVerticalChecks - 1);
+}
+
+FCollisionQueryParams UShooterLineOfSightSubsystem::MakeQueryParams(const FShooterLineOfSightKey& Key)
+{
+	// ignore the observer and target. We want an unobstructed trace not counting them
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ShooterLineOfSight), false);
+	QueryParams.AddIgnoredActor(Key.Observer.Get());
+	QueryParams.AddIgnoredActor(Key.Target.Get());
+
+	return QueryParams;
+}
+
+int32 UShooterLineOfSightSubsystem::ConsumeTraceBudget(int32 NumTraces)
+{
+	// reset the budget on a new frame
+	if (BudgetFrame != GFrameCounter)
+	{
+		BudgetFrame = GFrameCounter;
+		TracesThisFrame = 0;
+	}
+
+	TracesThisFrame += NumTraces;
+
+	return GetDefault<UShooterAISettings>()->MaxLineOfSightTracesPerFrame - TracesThisFrame;
+}
+
+bool UShooterLineOfSightSubsystem::TraceNow(const FShooterLineOfSightKey& Key, const FShooterLineOfSightEntry& Entry, bool& bOutHasLineOfSight)
+{
+	const FVector Start = GetObserverEyeLocation(Key.Observer.Get());
+	const FCollisionQueryParams QueryParams = MakeQueryParams(Key);
+
+	FHitResult OutHit;
+
+	const int32 NumTraces = GetNumTraces(Entry.NumVerticalChecks);
+
+	for (int32 i = 0; i < NumTraces; ++i)
+	{
+		// synchronous traces are capped by the frame budget too
+		if (ConsumeTraceBudget(0) <= 0)
+		{
+			return false;
+		}
+
+		ConsumeTraceBudget(1);
+		INC_DWORD_STAT(STAT_ShooterLOSSyncTraces);
+
+		const FVector End = GetCheckLocation(Key.Target.Get(), i, Entry.NumVerticalChecks);
+
+		// we only need one unobstructed trace, so terminate early
+		if (!GetWorld()->LineTraceSingleByChannel(OutHit, Start, End, ECC_Visibility, QueryParams))
+		{
+			bOutHasLineOfSight = true;
+			return true;
+		}
+	}
+
+	// no line of sight found
+	bOutHasLineOfSight = false;
+	return true;
+}
+
+void UShooterLineOfSightSubsystem::IssueTrace(const FShooterLineOfSightKey& Key, const FShooterLineOfSightEntry& Entry)
+{
+	const FVector Start = GetObserverEyeLocation(Key.Observer.Get());
+	const FVector End = GetCheckLocation(Key.Target.Get(), Entry.CheckIndex, Entry.NumVerticalChecks);
+
+	// remember which entry this trace belongs to
+	const uint32 TraceID = NextTraceID++;
+	InFlightTraces.Add(TraceID, Key);
+
+	INC_DWORD_STAT(STAT_ShooterLOSAsyncTraces);
+
+	GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start, End, ECC_Visibility, MakeQueryParams(Key), FCollisionResponseParams::DefaultResponseParam, &TraceDelegate, TraceID);
+}
+
+void UShooterLineOfSightSubsystem::OnTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum)
+{
+	// is the trace unobstructed?
+	const bool bBlocked = Datum.OutHits.Num() > 0 && Datum.OutHits[0].bBlockingHit;
+
+	// is this trace part of a batched request?
+	TPair<uint32, int32> BatchTrace;
+
+	if (InFlightBatchTraces.RemoveAndCopyValue(Datum.UserData, BatchTrace))
+	{
+		OnBatchTraceCompleted(BatchTrace.Key, BatchTrace.Value, !bBlocked);
+		return;
+	}
+
+	// find the entry this trace belongs to
+	FShooterLineOfSightKey Key;
+
+	if (!InFlightTraces.RemoveAndCopyValue(Datum.UserData, Key))
+	{
+		return;
+	}
+
+	FShooterLineOfSightEntry* Entry = Entries.Find(Key);
+
+	if (!Entry)
+	{
+		return;
+	}
+
+	if (!bBlocked)
+	{
+		// we only need one unobstructed trace
+		CompleteEntry(Key, *Entry, true);
+
+	} else if (Entry->CheckIndex + 1 < GetNumTraces(Entry->NumVerticalChecks)) {
+
+		// try the next vertical check ahead of other refreshes
+		++Entry->CheckIndex;
+		RefreshQueue.Insert(Key, 0);
+
+	} else {
+
+		// no line of sight found
+		CompleteEntry(Key, *Entry, false);
+	}
+}
+
+void UShooterLineOfSightSubsystem::OnBatchTraceCompleted(uint32 BatchID, int32 TargetIndex, bool bHasLineOfSight)
+{
+	const FShooterLineOfSightBatch* Batch = Batches.Find(BatchID);
+
+	if (!Batch)
+	{
+		return;
+	}
+
+	const FShooterLineOfSightKey Key = Batch->Keys[TargetIndex];
+
+	// cache the verdict for everybody else
+	if (FShooterLineOfSightEntry* Entry = Entries.Find(Key))
+	{
+		if (bHasLineOfSight || GetNumTraces(Entry->NumVerticalChecks) <= 1)
+		{
+			// an unobstructed center trace is a valid verdict for any number of vertical checks, and a blocked one is for a single check
+			CompleteEntry(Key, *Entry, bHasLineOfSight);
+
+		} else {
+
+			// a blocked center trace doesn't rule out the other vertical checks, so trace them through a regular refresh
+			QueueRefresh(Key, *Entry);
+		}
+	}
+
+	ResolveBatchTarget(BatchID, TargetIndex, bHasLineOfSight);
+}
+
+void UShooterLineOfSightSubsystem::ResolveBatchTarget(uint32 BatchID, int32 TargetIndex, bool bHasLineOfSight)
+{
+	FShooterLineOfSightBatch* Batch = Batches.Find(BatchID);
+
+	if (!Batch)
+	{
+		return;
+	}
+
+	Batch->Results[TargetIndex] = bHasLineOfSight;
+
+	// have all the verdicts for this batch come in?
+	if (--Batch->PendingTraces == 0)
+	{
+		FShooterLineOfSightBatch CompletedBatch;
+		Batches.RemoveAndCopyValue(BatchID, CompletedBatch);
+
+		CompletedBatch.OnCompleted.ExecuteIfBound(CompletedBatch.Results);
+	}
+}
+
+void UShooterLineOfSightSubsystem::QueueRefresh(const FShooterLineOfSightKey& Key, FShooterLineOfSightEntry& Entry)
+{
+	if (Entry.bRefreshPending)
+	{
+		return;
+	}
+
+	Entry.bRefreshPending = true;
+
+	// unknown pairs jump the queue so new sightings are picked up quickly
+	if (Entry.bIsKnown)
+	{
+		RefreshQueue.Add(Key);
+
+	} else {
+
+		RefreshQueue.Insert(Key, 0);
+	}
+}
+
+void UShooterLineOfSightSubsystem::CompleteEntry(const FShooterLineOfSightKey& Key, FShooterLineOfSightEntry& Entry, bool bHasLineOfSight)
+{
+	Entry.bHasLineOfSight = bHasLineOfSight;
+	Entry.bIsKnown = true;
+	Entry.bRefreshPending = false;
+	Entry.CheckIndex = 0;
+	Entry.LastUpdateTime = GetWorld()->GetTimeSeconds();
+
+	ResolveWaitingBatchTargets(Key, bHasLineOfSight);
+}
+
+void UShooterLineOfSightSubsystem::ResolveWaitingBatchTargets(const FShooterLineOfSightKey& Key, bool bHasLineOfSight)
+{
+	// copy the waiting targets out first, since completing a batch may start new ones
+	TArray<TPair<uint32, int32>> Waiting;
+	WaitingBatchTargets.MultiFind(Key, Waiting);
+
+	if (Waiting.IsEmpty())
+	{
+		return;
+	}
+
+	WaitingBatchTargets.Remove(Key);
+
+	for (const TPair<uint32, int32>& Target : Waiting)
+	{
+		ResolveBatchTarget(Target.Key, Target.Value, bHasLineOfSight);
+	}
+}
+
+void UShooterLineOfSightSubsystem::PruneEntries(double Now)
+{
+	const float Lifetime = GetDefault<UShooterAISettings>()->LineOfSightEntryLifetime;
+
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().Observer.IsValid() || !It.Key().Target.IsValid() || Now - It.Value().LastQueryTime > Lifetime)
+		{
+			// don't leave any batch hanging on the discarded refresh
+			const FShooterLineOfSightKey Key = It.Key();
+			const bool bHasLineOfSight = It.Value().bHasLineOfSight && Key.Observer.IsValid() && Key.Target.IsValid();
+
+			It.RemoveCurrent();
+
+			ResolveWaitingBatchTargets(Key, bHasLineOfSight);
+		}
+	}
+}
@@ -0,0 +1,226 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "ShooterLineOfSightSubsystem.generated.h"
+
+class UShooterVisibilityGrid;
+
+/**
+ *  Line of sight verdict that may not be available yet
+ */
+enum class EShooterLineOfSight : uint8
+{
+	Blocked,
+	Visible,
+	Unknown
+};
+
+/** Called with one line of sight verdict per target of a batched request */
+DECLARE_DELEGATE_OneParam(FShooterLineOfSightBatchDelegate, const TArray<bool>&);
+
+/**
+ *  Identifies a cached observer to target line of sight result
+ */
+struct FShooterLineOfSightKey
+{
+	/** Actor doing the looking */
+	TWeakObjectPtr<const AActor> Observer;
+
+	/** Actor being looked at */
+	TWeakObjectPtr<const AActor> Target;
+
+	bool operator==(const FShooterLineOfSightKey& Other) const
+	{
+		return Observer == Other.Observer && Target == Other.Target;
+	}
+
+	friend uint32 GetTypeHash(const FShooterLineOfSightKey& Key)
+	{
+		return HashCombine(GetTypeHash(Key.Observer), GetTypeHash(Key.Target));
+	}
+};
+
+/**
+ *  Cached line of sight verdict between an observer and a target
+ */
+struct FShooterLineOfSightEntry
+{
+	/** Last known verdict */
+	bool bHasLineOfSight = false;
+
+	/** True once at least one refresh has completed */
+	bool bIsKnown = false;
+
+	/** True while the entry is queued for a refresh or has a trace in flight */
+	bool bRefreshPending = false;
+
+	/** Number of vertical checks to spread across the target bounds */
+	int32 NumVerticalChecks = 1;
+
+	/** Index of the vertical check currently being traced */
+	int32 CheckIndex = 0;
+
+	/** Game time of the last completed refresh */
+	double LastUpdateTime = 0.0;
+
+	/** Game time of the last query. Entries that stop being queried are discarded */
+	double LastQueryTime = 0.0;
+};
+
+/**
+ *  Batched line of sight request waiting for its async traces
+ */
+struct FShooterLineOfSightBatch
+{
+	/** Pairs being checked */
+	TArray<FShooterLineOfSightKey> Keys;
+
+	/** Verdicts, in the same order as the keys */
+	TArray<bool> Results;
+
+	/** Number of verdicts still outstanding, either traced by the batch or waiting on a queued refresh */
+	int32 PendingTraces = 0;
+
+	/** Delegate to call once every verdict is in */
+	FShooterLineOfSightBatchDelegate OnCompleted;
+};
+
+/**
+ *  Shared line of sight cache for the shooter AI
+ *  Conditions and perception tasks read cached verdicts instantly
+ *  Stale verdicts are refreshed through async traces under a global per-frame budget
+ */
+UCLASS()
+class PROJECTOPERATOR_API UShooterLineOfSightSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Baked visibility grid for the current level, if any */
+	UPROPERTY()
+	TObjectPtr<UShooterVisibilityGrid> VisibilityGrid;
+
+	/** Cached verdicts by observer and target */
+	TMap<FShooterLineOfSightKey, FShooterLineOfSightEntry> Entries;
+
+	/** Entries waiting for a trace, in refresh order */
+	TArray<FShooterLineOfSightKey> RefreshQueue;
+
+	/** Entries with an async trace in flight, by trace ID */
+	TMap<uint32, FShooterLineOfSightKey> InFlightTraces;
+
+	/** Batched requests waiting for traces, by batch ID */
+	TMap<uint32, FShooterLineOfSightBatch> Batches;
+
+	/** Batch ID and target index for batched traces in flight, by trace ID */
+	TMap<uint32, TPair<uint32, int32>> InFlightBatchTraces;
+
+	/** Batch ID and target index for batch targets waiting on an entry refresh, by entry */
+	TMultiMap<FShooterLineOfSightKey, TPair<uint32, int32>> WaitingBatchTargets;
+
+	/** ID to assign to the next batched request */
+	uint32 NextBatchID = 0;
+
+	/** ID to assign to the next async trace */
+	uint32 NextTraceID = 0;
+
+	/** Delegate bound to async trace completion */
+	FTraceDelegate TraceDelegate;
+
+	/** Frame the trace budget was last reset on */
+	uint64 BudgetFrame = 0;
+
+	/** Number of traces already spent this frame */
+	int32 TracesThisFrame = 0;
+
+public:
+
+	/** Subsystem initialization */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Loads the baked visibility grid for this level */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Prunes stale entries and issues queued traces within the frame budget */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable object */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/**
+	 *  Returns the cached line of sight verdict from the observer to the target
+	 *  Stale or unknown verdicts are queued for an async refresh
+	 *  @param NumVerticalChecks number of checks to spread vertically across the target bounds
+	 *  @param bResolveUnknownNow if true, a pair that has never been traced is resolved synchronously while the frame budget allows
+	 */
+	bool QueryLineOfSight(const AActor* Observer, const AActor* Target, int32 NumVerticalChecks = 1, bool bResolveUnknownNow = false);
+
+	/**
+	 *  Same as QueryLineOfSight with bResolveUnknownNow, but reports pairs that couldn't be traced
+	 *  within the frame budget as unknown instead of blocked. They're queued for an async refresh
+	 */
+	EShooterLineOfSight QueryLineOfSightNow(const AActor* Observer, const AActor* Target, int32 NumVerticalChecks = 1);
+
+	/**
+	 *  Checks line of sight from the observer to several targets with a single batch of async traces
+	 *  Fresh cached verdicts are used directly. The delegate may be called before this returns if no traces are needed
+	 */
+	void RequestLineOfSightBatch(const AActor* Observer, const TArray<AActor*>& Targets, FShooterLineOfSightBatchDelegate OnCompleted);
+
+	/** Returns false only if the baked visibility grid says the two locations can never see each other */
+	bool MayBeVisible(const FVector& From, const FVector& To) const;
+
+	/** Returns the location line of sight checks start from for the given observer */
+	static FVector GetObserverEyeLocation(const AActor* Observer);
+
+protected:
+
+	/** Returns the end location of the given vertical check on the target */
+	static FVector GetCheckLocation(const AActor* Target, int32 CheckIndex, int32 NumVerticalChecks);
+
+	/** Returns the number of traces needed to cover the given number of vertical checks */
+	static int32 GetNumTraces(int32 NumVerticalChecks);
+
+	/** Builds the query params shared by sync and async traces */
+	static FCollisionQueryParams MakeQueryParams(const FShooterLineOfSightKey& Key);
+
+	/** Spends trace budget for the current frame. Returns the remaining budget */
+	int32 ConsumeTraceBudget(int32 NumTraces);
+
+	/** Resolves all vertical checks for an entry synchronously. Returns false without a verdict if the frame budget runs out first */
+	bool TraceNow(const FShooterLineOfSightKey& Key, const FShooterLineOfSightEntry& Entry, bool& bOutHasLineOfSight);
+
+	/** Issues an async trace for the entry's current vertical check */
+	void IssueTrace(const FShooterLineOfSightKey& Key, const FShooterLineOfSightEntry& Entry);
+
+	/** Handles async trace results */
+	void OnTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum);
+
+	/** Handles async trace results belonging to a batched request */
+	void OnBatchTraceCompleted(uint32 BatchID, int32 TargetIndex, bool bHasLineOfSight);
+
+	/** Stores a verdict for one target of a batched request, completing the batch once every verdict is in */
+	void ResolveBatchTarget(uint32 BatchID, int32 TargetIndex, bool bHasLineOfSight);
+
+	/** Queues a refresh for the entry, unless one is already pending */
+	void QueueRefresh(const FShooterLineOfSightKey& Key, FShooterLineOfSightEntry& Entry);
+
+	/** Stores a completed verdict on the entry and passes it to any batch waiting on it */
+	void CompleteEntry(const FShooterLineOfSightKey& Key, FShooterLineOfSightEntry& Entry, bool bHasLineOfSight);
+
+	/** Passes a verdict to every batch target waiting on the entry */
+	void ResolveWaitingBatchTargets(const FShooterLineOfSightKey& Key, bool bHasLineOfSight);
+
+	/** Discards entries whose actors are gone or which are no longer queried */
+	void PruneEntries(double Now);
+};
@@ -4,18 +4,54 @@
 #include "Variant_Shooter/AI/ShooterNPC.h"
 #include "ShooterWeapon.h"
 #include "Components/SkeletalMeshComponent.h"
-#include "Camera/CameraComponent.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Engine/World.h"
 #include "ShooterGameMode.h"
 #include "Components/CapsuleComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "TimerManager.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "ShooterInfluenceMapSubsystem.h"
+#include "ShooterNPCMovementComponent.h"
+#include "ShooterAIController.h"
+#include "ShooterNPCPool.h"
+#include "ShooterRagdollSubsystem.h"
+#include "Components/PoseableMeshComponent.h"
+#include "Perception/AIPerceptionSystem.h"
+#include "Perception/AISense_Sight.h"
+#include "AISense_ShooterSight.h"
+
+AShooterNPC::AShooterNPC(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer
+		.SetDefaultSubobjectClass<UShooterNPCMovementComponent>(ACharacter::CharacterMovementComponentName)
+		.DoNotCreateDefaultSubobject(AProjectOperatorCharacter::FirstPersonMeshComponentName)
+		.DoNotCreateDefaultSubobject(AProjectOperatorCharacter::FirstPersonCameraComponentName))
+{
+}
+
+void AShooterNPC::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	// the starting HP is our max, unless it was already set up before spawning
+	if (MaxHP <= 0.0f)
+	{
+		MaxHP = CurrentHP;
+	}
+}
 
 void AShooterNPC::BeginPlay()
 {
 	Super::BeginPlay();
 
+	// initialize the replicated state
+	UpdateCombatState();
+
+	// remember how the mesh is set up so it can be restored after a ragdoll death
+	MeshRelativeTransform = GetMesh()->GetRelativeTransform();
+	MeshCollisionProfile = GetMesh()->GetCollisionProfileName();
+
 	// spawn the weapon
 	FActorSpawnParameters SpawnParams;
 	SpawnParams.Owner = this;
@@ -33,6 +69,27 @@ void AShooterNPC::EndPlay(const EEndPlayReason::Type EndPlayReason)
 	GetWorld()->GetTimerManager().ClearTimer(DeathTimer);
 }
 
+void AShooterNPC::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// combat state is relevant to every client for remote visuals
+	FDoRepLifetimeParams CombatParams;
+	CombatParams.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterNPC, CombatState, CombatParams);
+}
+
+FVector AShooterNPC::GetPawnViewLocation() const
+{
+	// look from the eye socket if the mesh has one
+	if (GetMesh()->DoesSocketExist(EyeSocket))
+	{
+		return GetMesh()->GetSocketLocation(EyeSocket);
+	}
+
+	return GetActorTransform().TransformPosition(EyeOffset);
+}
+
 float AShooterNPC::TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
 	// ignore if already dead
@@ -50,6 +107,9 @@ float AShooterNPC::TakeDamage(float Damage, struct FDamageEvent const& DamageEve
 		Die();
 	}
 
+	// replicate the new HP
+	UpdateCombatState();
+
 	return Damage;
 }
 
@@ -60,9 +120,9 @@ void AShooterNPC::AttachWeaponMeshes(AShooterWeapon* WeaponToAttach)
 	// attach the weapon actor
 	WeaponToAttach->AttachToActor(this, AttachmentRule);
 
-	// attach the weapon meshes
-	WeaponToAttach->GetFirstPersonMesh()->AttachToComponent(GetFirstPersonMesh(), AttachmentRule, FirstPersonWeaponSocket);
-	WeaponToAttach->GetThirdPersonMesh()->AttachToComponent(GetMesh(), AttachmentRule, FirstPersonWeaponSocket);
+	// attach the third person mesh. Nobody ever sees an NPC in first person
+	WeaponToAttach->DisableFirstPersonMesh();
+	WeaponToAttach->GetThirdPersonMesh()->AttachToComponent(GetMesh(), AttachmentRule, ThirdPersonWeaponSocket);
 }
 
 void AShooterNPC::PlayFiringMontage(UAnimMontage* Montage)
@@ -82,8 +142,8 @@ void AShooterNPC::UpdateWeaponHUD(int32 CurrentAmmo, int32 MagazineSize)
 
 FVector AShooterNPC::GetWeaponTargetLocation()
 {
-	// start aiming from the camera location
-	const FVector AimSource = GetFirstPersonCameraComponent()->GetComponentLocation();
+	// start aiming from the eyes
+	const FVector AimSource = GetPawnViewLocation();
 
 	FVector AimDir, AimTarget = FVector::ZeroVector;
 
@@ -103,8 +163,8 @@ FVector AShooterNPC::GetWeaponTargetLocation()
 		
 	} else {
 
-		// no aim target, so just use the camera facing
-		AimDir = UKismetMathLibrary::RandomUnitVectorInConeInDegrees(GetFirstPersonCameraComponent()->GetForwardVector(), AimVarianceHalfAngle);
+		// no aim target, so just use the view facing
+		AimDir = UKismetMathLibrary::RandomUnitVectorInConeInDegrees(GetViewRotation().Vector(), AimVarianceHalfAngle);
 
 	}
 
@@ -165,25 +225,268 @@ void AShooterNPC::Die()
 		GM->IncrementTeamScore(TeamByte);
 	}
 
-	// disable capsule collision
-	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	// mark the death on the AI influence map
+	if (UShooterInfluenceMapSubsystem* InfluenceMap = GetWorld()->GetSubsystem<UShooterInfluenceMapSubsystem>())
+	{
+		InfluenceMap->ReportDeath(this);
+	}
+
+	// let the controller suspend its AI. This also hands our squad's lead to a living member
+	OnPawnDeath.Broadcast();
 
 	// stop movement
 	GetCharacterMovement()->StopMovementImmediately();
 	GetCharacterMovement()->StopActiveMovement();
 
+	// switch to ragdoll
+	StartRagdoll();
+
+	// schedule actor destruction
+	GetWorld()->GetTimerManager().SetTimer(DeathTimer, this, &AShooterNPC::DeferredDestruction, DeferredDestructionTime, false);
+}
+
+void AShooterNPC::DeferredDestruction()
+{
+	// keep the actor, its controller and its weapon around for the next spawn
+	if (UShooterNPCPool* Pool = GetWorld()->GetSubsystem<UShooterNPCPool>())
+	{
+		Pool->ReleaseNPC(this);
+
+	} else {
+
+		// no pool, so tear down the controller along with us
+		if (AController* OwningController = GetController())
+		{
+			OwningController->Destroy();
+		}
+
+		Destroy();
+	}
+}
+
+void AShooterNPC::StartRagdoll()
+{
+	// disable capsule collision
+	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
 	// enable ragdoll physics on the third person mesh
 	GetMesh()->SetCollisionProfileName(RagdollCollisionProfile);
 	GetMesh()->SetSimulatePhysics(true);
 	GetMesh()->SetPhysicsBlendWeight(1.0f);
 
-	// schedule actor destruction
-	GetWorld()->GetTimerManager().SetTimer(DeathTimer, this, &AShooterNPC::DeferredDestruction, DeferredDestructionTime, false);
+	// let the ragdoll budget decide how long we get to simulate
+	if (UShooterRagdollSubsystem* Ragdolls = GetWorld()->GetSubsystem<UShooterRagdollSubsystem>())
+	{
+		Ragdolls->AddRagdoll(this);
+	}
 }
 
-void AShooterNPC::DeferredDestruction()
+void AShooterNPC::FreezeRagdoll()
+{
+	USkeletalMeshComponent* RagdollMesh = GetMesh();
+
+	// create the snapshot component the first time we need it. It's kept for later deaths if we're pooled
+	if (!RagdollSnapshot)
+	{
+		RagdollSnapshot = NewObject<UPoseableMeshComponent>(this, TEXT("RagdollSnapshot"));
+		RagdollSnapshot->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		RagdollSnapshot->SetUsingAbsoluteLocation(true);
+		RagdollSnapshot->SetUsingAbsoluteRotation(true);
+		RagdollSnapshot->RegisterComponent();
+	}
+
+	// copy the current ragdoll pose and materials
+	RagdollSnapshot->SetSkinnedAssetAndUpdate(RagdollMesh->GetSkinnedAsset());
+
+	for (int32 i = 0; i < RagdollMesh->GetNumMaterials(); ++i)
+	{
+		RagdollSnapshot->SetMaterial(i, RagdollMesh->GetMaterial(i));
+	}
+
+	RagdollSnapshot->SetWorldTransform(RagdollMesh->GetComponentTransform());
+	RagdollSnapshot->CopyPoseFromSkeletalComponent(RagdollMesh);
+	RagdollSnapshot->SetVisibility(true);
+
+	// stop simulating and swap the mesh for the snapshot
+	RagdollMesh->SetSimulatePhysics(false);
+	RagdollMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	RagdollMesh->SetVisibility(false);
+	RagdollMesh->SetComponentTickEnabled(false);
+}
+
+void AShooterNPC::StopRagdoll()
+{
+	if (UShooterRagdollSubsystem* Ragdolls = GetWorld()->GetSubsystem<UShooterRagdollSubsystem>())
+	{
+		Ragdolls->RemoveRagdoll(this);
+	}
+
+	// swap the snapshot back for the live mesh
+	if (RagdollSnapshot)
+	{
+		RagdollSnapshot->SetVisibility(false);
+	}
+
+	GetMesh()->SetVisibility(true);
+	GetMesh()->SetComponentTickEnabled(true);
+
+	// disable ragdoll physics on the third person mesh
+	GetMesh()->SetSimulatePhysics(false);
+	GetMesh()->SetPhysicsBlendWeight(0.0f);
+	GetMesh()->SetCollisionProfileName(MeshCollisionProfile);
+
+	// simulating physics detaches the mesh, so put it back on the capsule
+	GetMesh()->AttachToComponent(GetCapsuleComponent(), FAttachmentTransformRules::SnapToTargetNotIncludingScale);
+	GetMesh()->SetRelativeTransform(MeshRelativeTransform);
+
+	// re-enable capsule collision
+	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+}
+
+void AShooterNPC::ResetForRespawn()
 {
-	Destroy();
+	GetWorld()->GetTimerManager().ClearTimer(DeathTimer);
+
+	CurrentAimTarget = nullptr;
+	CurrentHP = MaxHP;
+
+	// undo the death
+	if (bIsDead)
+	{
+		bIsDead = false;
+
+		StopRagdoll();
+
+		GetCharacterMovement()->SetMovementMode(MOVE_Walking);
+	}
+
+	// start over with a full magazine
+	if (Weapon)
+	{
+		Weapon->ResetAmmo();
+	}
+
+	// replicate the revived state
+	UpdateCombatState();
+}
+
+void AShooterNPC::ApplyBotState(float InCurrentHP, float InMaxHP, uint8 InTeamByte, FName InSquadName)
+{
+	CurrentHP = InCurrentHP;
+	MaxHP = InMaxHP;
+	TeamByte = InTeamByte;
+	SquadName = InSquadName;
+
+	// replicate the new HP and team
+	UpdateCombatState();
+}
+
+void AShooterNPC::SetPooled(bool bPooled)
+{
+	if (bIsPooled == bPooled)
+	{
+		return;
+	}
+
+	bIsPooled = bPooled;
+
+	// stop whatever we were doing
+	if (bPooled)
+	{
+		if (bIsShooting)
+		{
+			StopShooting();
+		}
+
+		GetCharacterMovement()->StopMovementImmediately();
+		GetCharacterMovement()->StopActiveMovement();
+
+		// get back to a fresh state while nobody can see us
+		ResetForRespawn();
+	}
+
+	// pooled NPCs neither render, collide nor tick
+	SetActorHiddenInGame(bPooled);
+	SetActorEnableCollision(!bPooled);
+	SetActorTickEnabled(!bPooled);
+	GetCharacterMovement()->SetComponentTickEnabled(!bPooled);
+	GetMesh()->SetComponentTickEnabled(!bPooled);
+
+	// put the weapon to sleep along with us
+	if (Weapon)
+	{
+		if (bPooled)
+		{
+			Weapon->DeactivateWeapon();
+
+		} else {
+
+			Weapon->ActivateWeapon();
+		}
+	}
+
+	// suspend or resume the AI
+	if (AShooterAIController* AIController = Cast<AShooterAIController>(GetController()))
+	{
+		AIController->SetAISuspended(bPooled);
+	}
+
+	// stop being a sight stimulus while pooled, since we're invisible but still standing where we died
+	if (bPooled)
+	{
+		if (UAIPerceptionSystem* PerceptionSystem = UAIPerceptionSystem::GetCurrent(GetWorld()))
+		{
+			PerceptionSystem->UnregisterSource(*this);
+		}
+
+	} else {
+
+		UAIPerceptionSystem::RegisterPerceptionStimuliSource(this, UAISense_Sight::StaticClass(), this);
+		UAIPerceptionSystem::RegisterPerceptionStimuliSource(this, UAISense_ShooterSight::StaticClass(), this);
+	}
+}
+
+void AShooterNPC::UpdateCombatState()
+{
+	// only the server writes the replicated state
+	if (!HasAuthority())
+	{
+		return;
+	}
+
+	CombatState.SetHP(CurrentHP, MaxHP);
+	CombatState.TeamByte = TeamByte;
+	CombatState.bIsDead = bIsDead;
+
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterNPC, CombatState, this);
+}
+
+void AShooterNPC::OnRep_CombatState(const FShooterCombatState& OldCombatState)
+{
+	// mirror the replicated HP locally, once we know what the percentage is of
+	if (MaxHP > 0.0f)
+	{
+		CurrentHP = CombatState.GetHPPercent() * MaxHP;
+	}
+
+	// mirror the replicated team, so team attitudes are right on clients
+	TeamByte = CombatState.TeamByte;
+
+	// have we just died?
+	if (CombatState.bIsDead && !OldCombatState.bIsDead)
+	{
+		bIsDead = true;
+
+		// play the ragdoll death on this client
+		StartRagdoll();
+
+	} else if (!CombatState.bIsDead && OldCombatState.bIsDead) {
+
+		// we've been reset for respawn
+		bIsDead = false;
+
+		StopRagdoll();
+	}
 }
 
 void AShooterNPC::StartShooting(AActor* ActorToShoot)
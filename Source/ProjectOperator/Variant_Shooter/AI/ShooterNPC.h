@@ -5,19 +5,23 @@
 #include "CoreMinimal.h"
 #include "ProjectOperatorCharacter.h"
 #include "ShooterWeaponHolder.h"
+#include "ShooterCombatState.h"
+#include "GenericTeamAgentInterface.h"
 #include "ShooterNPC.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FPawnDeathDelegate);
 
 class AShooterWeapon;
+class UPoseableMeshComponent;
 
 /**
  *  A simple AI-controlled shooter game NPC
  *  Executes its behavior through a StateTree managed by its AI Controller
  *  Holds and manages a weapon
+ *  Skips the first person mesh and camera, and aims from an eye socket on the third person mesh instead
  */
 UCLASS(abstract)
-class PROJECTOPERATOR_API AShooterNPC : public AProjectOperatorCharacter, public IShooterWeaponHolder
+class PROJECTOPERATOR_API AShooterNPC : public AProjectOperatorCharacter, public IShooterWeaponHolder, public IGenericTeamAgentInterface
 {
 	GENERATED_BODY()
 
@@ -29,11 +33,18 @@ public:
 
 protected:
 
+	/** HP at the start of play. Used to quantize the replicated HP */
+	float MaxHP = 0.0f;
+
+	/** Quantized HP, team and death state replicated to all clients */
+	UPROPERTY(ReplicatedUsing=OnRep_CombatState)
+	FShooterCombatState CombatState;
+
 	/** Name of the collision profile to use during ragdoll death */
 	UPROPERTY(EditAnywhere, Category="Damage")
 	FName RagdollCollisionProfile = FName("Ragdoll");
 
-	/** Time to wait after death before destroying this actor */
+	/** Time to wait after death before returning this actor to the NPC pool */
 	UPROPERTY(EditAnywhere, Category="Damage")
 	float DeferredDestructionTime = 5.0f;
 
@@ -41,6 +52,10 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Team")
 	uint8 TeamByte = 1;
 
+	/** Squad this NPC shares sightings with. NPCs with no squad perceive on their own */
+	UPROPERTY(EditAnywhere, Category="Team")
+	FName SquadName;
+
 	/** Pointer to the equipped weapon */
 	TObjectPtr<AShooterWeapon> Weapon;
 
@@ -48,14 +63,18 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Weapon")
 	TSubclassOf<AShooterWeapon> WeaponClass;
 
-	/** Name of the first person mesh weapon socket */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category ="Weapons")
-	FName FirstPersonWeaponSocket = FName("HandGrip_R");
-
 	/** Name of the third person mesh weapon socket */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category ="Weapons")
 	FName ThirdPersonWeaponSocket = FName("HandGrip_R");
 
+	/** Socket on the third person mesh that aim and line of sight traces start from */
+	UPROPERTY(EditAnywhere, Category="Aim")
+	FName EyeSocket = FName("head");
+
+	/** Eye location relative to the actor, used if the third person mesh has no eye socket */
+	UPROPERTY(EditAnywhere, Category="Aim")
+	FVector EyeOffset = FVector(0.0f, 0.0f, 64.0f);
+
 	/** Max range for aiming calculations */
 	UPROPERTY(EditAnywhere, Category="Aim")
 	float AimRange = 10000.0f;
@@ -81,27 +100,90 @@ protected:
 	/** If true, this character has already died */
 	bool bIsDead = false;
 
-	/** Deferred destruction on death timer */
+	/** If true, this character is inactive in the NPC pool */
+	bool bIsPooled = false;
+
+	/** Deferred corpse release on death timer */
 	FTimerHandle DeathTimer;
 
+	/** Static copy of the ragdoll pose, shown in place of the third person mesh once the ragdoll is frozen */
+	UPROPERTY(Transient)
+	TObjectPtr<UPoseableMeshComponent> RagdollSnapshot;
+
+	/** Third person mesh placement and collision before any ragdoll death, restored on respawn */
+	FTransform MeshRelativeTransform;
+	FName MeshCollisionProfile;
+
 public:
 
 	/** Delegate called when this NPC dies */
 	FPawnDeathDelegate OnPawnDeath;
 
+public:
+
+	/** Constructor */
+	AShooterNPC(const FObjectInitializer& ObjectInitializer);
+
 protected:
 
 	/** Gameplay initialization */
 	virtual void BeginPlay() override;
 
+	/** Sets up the max HP before any replicated state can arrive */
+	virtual void PostInitializeComponents() override;
+
 	/** Gameplay cleanup */
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
+	/** Sets up replicated properties */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 public:
 
+	/** Returns the eye socket location, since NPCs have no first person camera */
+	virtual FVector GetPawnViewLocation() const override;
+
 	/** Handle incoming damage */
 	virtual float TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
 
+	/** Returns the team ID for this character */
+	uint8 GetTeamByte() const { return TeamByte; }
+
+	/** Returns the squad this NPC belongs to */
+	FName GetSquadName() const { return SquadName; }
+
+	/** Returns the HP this NPC started with */
+	float GetMaxHP() const { return MaxHP; }
+
+	/** Sets the HP, team and squad of this NPC, e.g. when it's brought in from the hybrid LOD or the pool */
+	void ApplyBotState(float InCurrentHP, float InMaxHP, uint8 InTeamByte, FName InSquadName);
+
+	/** Deactivates this NPC and its controller while pooled, or reactivates them */
+	void SetPooled(bool bPooled);
+
+	/** Returns true if this NPC is inactive in the NPC pool */
+	bool IsPooled() const { return bIsPooled; }
+
+	/** Returns true if the actor is an NPC sitting inactive in the NPC pool. Pooled NPCs shouldn't be seen, targeted or counted */
+	static bool IsPooledNPC(const AActor* Actor)
+	{
+		const AShooterNPC* NPC = Cast<AShooterNPC>(Actor);
+		return NPC && NPC->IsPooled();
+	}
+
+	/** Returns true if this NPC has died */
+	bool IsDead() const { return bIsDead; }
+
+	/** Stops simulating the ragdoll and holds its current pose with a static snapshot. Called by the ragdoll budget */
+	void FreezeRagdoll();
+
+	//~Begin IGenericTeamAgentInterface interface
+
+	/** Returns the team ID used for AI attitude checks */
+	virtual FGenericTeamId GetGenericTeamId() const override { return FGenericTeamId(TeamByte); }
+
+	//~End IGenericTeamAgentInterface interface
+
 public:
 
 	//~Begin IShooterWeaponHolder interface
@@ -140,9 +222,25 @@ protected:
 	/** Called when HP is depleted and the character should die */
 	void Die();
 
-	/** Called after death to destroy the actor */
+	/** Called after death to return the actor to the NPC pool */
 	void DeferredDestruction();
 
+	/** Disables the capsule and switches the third person mesh to ragdoll physics */
+	void StartRagdoll();
+
+	/** Re-enables the capsule and snaps the third person mesh back after a ragdoll death */
+	void StopRagdoll();
+
+	/** Restores HP, ammo and the alive state so the NPC can be reused from the pool */
+	void ResetForRespawn();
+
+	/** Copies the current HP, team and death state into the replicated combat state */
+	void UpdateCombatState();
+
+	/** Plays death visuals on clients from the replicated combat state */
+	UFUNCTION()
+	void OnRep_CombatState(const FShooterCombatState& OldCombatState);
+
 public:
 
 	/** Signals this character to start shooting at the passed actor */
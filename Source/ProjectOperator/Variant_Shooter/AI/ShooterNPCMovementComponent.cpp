@@ -0,0 +1,161 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterNPCMovementComponent.h"
+#include "GameFramework/Character.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "NavigationSystem.h"
+#include "Engine/World.h"
+#include "ProjectOperator.h"
+
+DECLARE_CYCLE_STAT(TEXT("NPC Simplified Movement"), STAT_ShooterSimplifiedMovement, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("NPC Simplified Movement Steps"), STAT_ShooterSimplifiedSteps, STATGROUP_ShooterAI);
+
+void UShooterNPCMovementComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	// only the authority simplifies. Remote proxies are already cheap and smoothed
+	if (!bSimplifiedMovement || !CharacterOwner || !CharacterOwner->HasAuthority())
+	{
+		Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+		return;
+	}
+
+	// skip the character movement tick entirely
+	UActorComponent::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterSimplifiedMovement);
+
+	TimeSinceSimplifiedStep += DeltaTime;
+
+	if (TimeSinceSimplifiedStep >= SimplifiedStepInterval)
+	{
+		SimplifiedMoveStep(TimeSinceSimplifiedStep);
+		TimeSinceSimplifiedStep = 0.0f;
+	}
+
+	UpdateMeshSmoothing(DeltaTime);
+}
+
+void UShooterNPCMovementComponent::SetSimplifiedMovement(bool bEnable, float StepInterval)
+{
+	SimplifiedStepInterval = StepInterval;
+
+	if (bSimplifiedMovement == bEnable)
+	{
+		return;
+	}
+
+	bSimplifiedMovement = bEnable;
+	TimeSinceSimplifiedStep = 0.0f;
+
+	ResetMeshSmoothing();
+
+	// dedicated servers have no mesh to smooth, so they can skip the ticks between steps
+	if (GetNetMode() == NM_DedicatedServer)
+	{
+		SetComponentTickInterval(bSimplifiedMovement ? SimplifiedStepInterval : 0.0f);
+	}
+
+	// resume full simulation from a valid floor so there's no pop or fall on promotion
+	if (!bSimplifiedMovement && UpdatedComponent)
+	{
+		FindFloor(UpdatedComponent->GetComponentLocation(), CurrentFloor, false);
+
+		if (CurrentFloor.IsWalkableFloor())
+		{
+			SetMovementMode(MOVE_Walking);
+			AdjustFloorHeight();
+
+		} else {
+
+			SetMovementMode(MOVE_Falling);
+		}
+	}
+}
+
+void UShooterNPCMovementComponent::SimplifiedMoveStep(float DeltaTime)
+{
+	INC_DWORD_STAT(STAT_ShooterSimplifiedSteps);
+
+	if (!UpdatedComponent || DeltaTime <= 0.0f)
+	{
+		return;
+	}
+
+	// follow the velocity requested by path following, with no acceleration or braking
+	// the request stays valid until path following stops the move, since it may tick less often than we step
+	const FVector InputVector = ConsumeInputVector();
+	Velocity = bHasRequestedVelocity ? RequestedVelocity : InputVector * GetMaxSpeed();
+	Velocity.Z = 0.0f;
+	Velocity = Velocity.GetClampedToMaxSize(GetMaxSpeed());
+
+	if (Velocity.IsNearlyZero())
+	{
+		return;
+	}
+
+	const FVector OldLocation = UpdatedComponent->GetComponentLocation();
+	FVector NewLocation = OldLocation + Velocity * DeltaTime;
+
+	// snap to the navmesh instead of sweeping for the floor
+	const float HalfHeight = CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+
+	if (const UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{
+		FNavLocation Projected;
+
+		if (!NavSys->ProjectPointToNavigation(NewLocation - FVector(0.0f, 0.0f, HalfHeight), Projected, FVector(GetNavAgentPropertiesRef().AgentRadius, GetNavAgentPropertiesRef().AgentRadius, NavProjectionHalfHeight), &GetNavAgentPropertiesRef()))
+		{
+			// stop at the edge of the navmesh
+			Velocity = FVector::ZeroVector;
+			return;
+		}
+
+		NewLocation = Projected.Location + FVector(0.0f, 0.0f, HalfHeight);
+	}
+
+	// face the direction of travel
+	FRotator NewRotation = UpdatedComponent->GetComponentRotation();
+
+	if (bOrientRotationToMovement)
+	{
+		NewRotation = FMath::RInterpTo(NewRotation, Velocity.Rotation(), DeltaTime, RotationRate.Yaw / 90.0f);
+		NewRotation.Pitch = 0.0f;
+		NewRotation.Roll = 0.0f;
+	}
+
+	UpdatedComponent->SetWorldLocationAndRotation(NewLocation, NewRotation, false, nullptr, ETeleportType::None);
+
+	// keep the mesh where it was and let it catch up over the frames until the next step
+	MeshSmoothingOffset += OldLocation - NewLocation;
+
+	UpdateComponentVelocity();
+}
+
+void UShooterNPCMovementComponent::UpdateMeshSmoothing(float DeltaTime)
+{
+	USkeletalMeshComponent* Mesh = CharacterOwner->GetMesh();
+
+	if (!Mesh || GetNetMode() == NM_DedicatedServer)
+	{
+		return;
+	}
+
+	// close the gap by the end of the next step
+	const float Alpha = SimplifiedStepInterval > 0.0f ? FMath::Clamp(DeltaTime / SimplifiedStepInterval, 0.0f, 1.0f) : 1.0f;
+	MeshSmoothingOffset *= 1.0f - Alpha;
+
+	const FVector LocalOffset = UpdatedComponent->GetComponentTransform().InverseTransformVectorNoScale(MeshSmoothingOffset);
+	Mesh->SetRelativeLocation(CharacterOwner->GetBaseTranslationOffset() + LocalOffset, false, nullptr, ETeleportType::TeleportPhysics);
+}
+
+void UShooterNPCMovementComponent::ResetMeshSmoothing()
+{
+	MeshSmoothingOffset = FVector::ZeroVector;
+
+	if (CharacterOwner && CharacterOwner->GetMesh())
+	{
+		CharacterOwner->GetMesh()->SetRelativeLocation(CharacterOwner->GetBaseTranslationOffset());
+	}
+}
@@ -0,0 +1,62 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "ShooterNPCMovementComponent.generated.h"
+
+/**
+ *  Character movement for shooter NPCs with a simplified movement LOD
+ *  While simplified, the authority skips floor sweeps, step ups and physics interaction,
+ *  and instead moves the capsule along the requested path velocity projected onto the navmesh at a reduced rate.
+ *  The mesh is interpolated between simplified steps so the reduced rate isn't visible
+ */
+UCLASS()
+class PROJECTOPERATOR_API UShooterNPCMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Vertical half extent used to project simplified moves onto the navmesh */
+	UPROPERTY(EditAnywhere, Category="Simplified Movement", meta = (ClampMin = 0, Units = "cm"))
+	float NavProjectionHalfHeight = 250.0f;
+
+	/** If true, movement is currently simplified */
+	bool bSimplifiedMovement = false;
+
+	/** Interval between simplified movement steps */
+	float SimplifiedStepInterval = 0.0f;
+
+	/** Time accumulated since the last simplified step */
+	float TimeSinceSimplifiedStep = 0.0f;
+
+	/** World space offset of the mesh from its rest position, decayed between simplified steps */
+	FVector MeshSmoothingOffset = FVector::ZeroVector;
+
+public:
+
+	/** Runs either full character movement or a simplified step */
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/**
+	 *  Switches between full and simplified movement
+	 *  @param StepInterval interval between simplified movement steps
+	 */
+	void SetSimplifiedMovement(bool bEnable, float StepInterval);
+
+	/** Returns true if movement is currently simplified */
+	bool IsSimplifiedMovement() const { return bSimplifiedMovement; }
+
+protected:
+
+	/** Moves the capsule along the requested velocity, snapped to the navmesh */
+	void SimplifiedMoveStep(float DeltaTime);
+
+	/** Eases the mesh toward the capsule */
+	void UpdateMeshSmoothing(float DeltaTime);
+
+	/** Returns the mesh to its rest position */
+	void ResetMeshSmoothing();
+};
@@ -0,0 +1,90 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterNPCPool.h"
+#include "Variant_Shooter/AI/ShooterNPC.h"
+#include "Engine/World.h"
+#include "ProjectOperator.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("NPC Pool Reuses"), STAT_ShooterNPCPoolReuses, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("NPC Pool Spawns"), STAT_ShooterNPCPoolSpawns, STATGROUP_ShooterAI);
+
+bool UShooterNPCPool::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+AShooterNPC* UShooterNPCPool::AcquireNPC(TSubclassOf<AShooterNPC> NPCClass, const FTransform& Transform, TFunctionRef<void(AShooterNPC&)> InitFunc)
+{
+	if (!NPCClass)
+	{
+		return nullptr;
+	}
+
+	// reuse a pooled NPC if we have one
+	if (FShooterNPCPoolEntry* Entry = Pools.Find(NPCClass))
+	{
+		while (!Entry->NPCs.IsEmpty())
+		{
+			AShooterNPC* NPC = Entry->NPCs.Pop(EAllowShrinking::No);
+
+			// skip NPCs destroyed while pooled
+			if (!IsValid(NPC))
+			{
+				continue;
+			}
+
+			INC_DWORD_STAT(STAT_ShooterNPCPoolReuses);
+
+			NPC->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+
+			InitFunc(*NPC);
+
+			NPC->SetPooled(false);
+
+			return NPC;
+		}
+	}
+
+	// spawn a new one, deferred so it's initialized before BeginPlay
+	INC_DWORD_STAT(STAT_ShooterNPCPoolSpawns);
+
+	AShooterNPC* NPC = GetWorld()->SpawnActorDeferred<AShooterNPC>(NPCClass, Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+
+	if (!NPC)
+	{
+		return nullptr;
+	}
+
+	InitFunc(*NPC);
+
+	NPC->FinishSpawning(Transform);
+
+	// ensure the NPC has a controller even if it's not set to auto possess when spawned
+	if (!NPC->GetController())
+	{
+		NPC->SpawnDefaultController();
+	}
+
+	return NPC;
+}
+
+void UShooterNPCPool::ReleaseNPC(AShooterNPC* NPC)
+{
+	if (!IsValid(NPC))
+	{
+		return;
+	}
+
+	NPC->SetPooled(true);
+
+	Pools.FindOrAdd(NPC->GetClass()).NPCs.AddUnique(NPC);
+
+	OnNPCReleased.Broadcast(NPC);
+}
+
+int32 UShooterNPCPool::GetNumPooled(TSubclassOf<AShooterNPC> NPCClass) const
+{
+	const FShooterNPCPoolEntry* Entry = Pools.Find(NPCClass);
+	return Entry ? Entry->NPCs.Num() : 0;
+}
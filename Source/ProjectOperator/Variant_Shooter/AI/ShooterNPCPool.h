@@ -0,0 +1,67 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Templates/SubclassOf.h"
+#include "ShooterNPCPool.generated.h"
+
+class AShooterNPC;
+
+/** Called when an NPC is released to the pool */
+DECLARE_MULTICAST_DELEGATE_OneParam(FShooterNPCReleasedDelegate, AShooterNPC*);
+
+/**
+ *  Inactive NPCs of a single class
+ */
+USTRUCT()
+struct FShooterNPCPoolEntry
+{
+	GENERATED_BODY()
+
+	/** Pooled NPCs, ready to be reused */
+	UPROPERTY()
+	TArray<TObjectPtr<AShooterNPC>> NPCs;
+};
+
+/**
+ *  Pool of inactive shooter NPCs
+ *  Pooled NPCs keep their controller, weapon and components, so reusing them costs
+ *  a teleport and a reset instead of spawning and initializing a new set of actors
+ */
+UCLASS()
+class PROJECTOPERATOR_API UShooterNPCPool : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Inactive NPCs, by class */
+	UPROPERTY()
+	TMap<TSubclassOf<AShooterNPC>, FShooterNPCPoolEntry> Pools;
+
+public:
+
+	/** Called whenever an NPC is released. Anyone holding on to an NPC should let go of it, since the pool may hand it to somebody else */
+	FShooterNPCReleasedDelegate OnNPCReleased;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+public:
+
+	/**
+	 *  Returns an active NPC of the given class at the given transform, reusing a pooled one if possible
+	 *  @param InitFunc called on the NPC before it's activated, so its state is in place when its controller starts
+	 */
+	AShooterNPC* AcquireNPC(TSubclassOf<AShooterNPC> NPCClass, const FTransform& Transform, TFunctionRef<void(AShooterNPC&)> InitFunc);
+
+	/** Deactivates the NPC and keeps it for reuse */
+	void ReleaseNPC(AShooterNPC* NPC);
+
+	/** Returns the number of pooled NPCs of the given class */
+	int32 GetNumPooled(TSubclassOf<AShooterNPC> NPCClass) const;
+};
@@ -0,0 +1,493 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterPathBroker.h"
+#include "Variant_Shooter/AI/ShooterAIController.h"
+#include "Variant_Shooter/AI/ShooterAILODSubsystem.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "NavMesh/NavMeshPath.h"
+#include "NavFilters/NavigationQueryFilter.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+#include "Settings/ShooterAISettings.h"
+#include "ProjectOperator.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Path Requests"), STAT_ShooterPathRequests, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Path Shared Requests"), STAT_ShooterPathShared, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Path Joined Requests"), STAT_ShooterPathJoined, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Path Queries Started"), STAT_ShooterPathStarted, STATGROUP_ShooterAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Path Queued Queries"), STAT_ShooterPathQueued, STATGROUP_ShooterAI);
+
+bool UShooterPathBroker::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterPathBroker::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const UShooterAISettings* Settings = GetDefault<UShooterAISettings>();
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// discard paths too old to share and count the queries still running
+	int32 NumInFlight = 0;
+
+	for (auto It = SharedPaths.CreateIterator(); It; ++It)
+	{
+		const FShooterSharedPath& Shared = It.Value();
+
+		if (Shared.bFinished)
+		{
+			if (Now - Shared.CompletionTime > Settings->PathResultLifetime && !HasPendingRequests(It.Key()))
+			{
+				It.RemoveCurrent();
+			}
+
+		} else if (Shared.QueryID != INVALID_NAVQUERYID) {
+
+			++NumInFlight;
+		}
+	}
+
+	// serve the most significant NPCs first
+	if (const UShooterAILODSubsystem* LODSubsystem = GetWorld()->GetSubsystem<UShooterAILODSubsystem>())
+	{
+		LaunchQueue.StableSort([this, LODSubsystem](int32 A, int32 B)
+		{
+			const FShooterSharedPath* SharedA = SharedPaths.Find(A);
+			const FShooterSharedPath* SharedB = SharedPaths.Find(B);
+
+			const EShooterAILOD LODA = SharedA ? LODSubsystem->GetLOD(SharedA->Querier.Get()) : EShooterAILOD::Low;
+			const EShooterAILOD LODB = SharedB ? LODSubsystem->GetLOD(SharedB->Querier.Get()) : EShooterAILOD::Low;
+
+			return LODA < LODB;
+		});
+	}
+
+	// start queued queries within the budget
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	int32 NumStarted = 0;
+	int32 Processed = 0;
+
+	while (Processed < LaunchQueue.Num() && NumStarted < Settings->MaxPathQueryStartsPerFrame && NumInFlight < Settings->MaxPathQueriesInFlight)
+	{
+		const int32 SharedID = LaunchQueue[Processed];
+		++Processed;
+
+		// skip queries released while queued
+		FShooterSharedPath* Shared = SharedPaths.Find(SharedID);
+
+		if (!Shared)
+		{
+			continue;
+		}
+
+		AShooterAIController* Querier = Shared->Querier.Get();
+		const ANavigationData* NavData = (NavSys && Querier) ? NavSys->GetNavDataForProps(Querier->GetNavAgentPropertiesRef(), Shared->Start) : nullptr;
+
+		// fail queries whose querier or navigation data are gone
+		if (!NavData)
+		{
+			Shared->bFinished = true;
+			Shared->CompletionTime = Now;
+			ResolvePendingRequests();
+			continue;
+		}
+
+		FPathFindingQuery Query(Querier, *NavData, Shared->Start, Shared->Goal, UNavigationQueryFilter::GetQueryFilter(*NavData, Querier, Querier->GetDefaultNavigationFilterClass()));
+
+		Shared->QueryID = NavSys->FindPathAsync(Querier->GetNavAgentPropertiesRef(), Query, FNavPathQueryDelegate::CreateUObject(this, &UShooterPathBroker::OnPathFound));
+
+		++NumStarted;
+		++NumInFlight;
+
+		INC_DWORD_STAT(STAT_ShooterPathStarted);
+	}
+
+	LaunchQueue.RemoveAt(0, Processed, EAllowShrinking::No);
+
+	SET_DWORD_STAT(STAT_ShooterPathQueued, LaunchQueue.Num());
+}
+
+TStatId UShooterPathBroker::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterPathBroker, STATGROUP_Tickables);
+}
+
+int32 UShooterPathBroker::RequestPath(AShooterAIController* Requester, const FVector& Goal, float AcceptanceRadius)
+{
+	// ensure the requester is valid
+	if (!IsValid(Requester) || !Requester->GetPawn())
+	{
+		return INDEX_NONE;
+	}
+
+	INC_DWORD_STAT(STAT_ShooterPathRequests);
+
+	const FVector Start = Requester->GetPawn()->GetActorLocation();
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// joined corridors are point only paths, which the crowd simulation can't follow
+	const bool bAllowJoin = !GetDefault<UShooterAISettings>()->bEnableCrowdAvoidance;
+
+	FShooterPathRequest Request;
+	Request.Requester = Requester;
+	Request.Goal = Goal;
+	Request.AcceptanceRadius = AcceptanceRadius;
+
+	// try to piggyback on a path toward the same goal
+	int32 JoinIndex = INDEX_NONE;
+	Request.SharedID = FindSharedPath(Start, Goal, bAllowJoin, Now, JoinIndex);
+
+	if (Request.SharedID == INDEX_NONE)
+	{
+		Request.SharedID = QueueQuery(Requester, Start, Goal, false);
+
+	} else if (JoinIndex != INDEX_NONE) {
+
+		// only path to the corridor, and follow it from there
+		const FShooterSharedPath& Shared = SharedPaths.FindChecked(Request.SharedID);
+
+		Request.JoinIndex = JoinIndex;
+		Request.JoinID = QueueQuery(Requester, Start, Shared.Path->GetPathPoints()[JoinIndex].Location, true);
+
+		INC_DWORD_STAT(STAT_ShooterPathJoined);
+
+	} else {
+
+		INC_DWORD_STAT(STAT_ShooterPathShared);
+	}
+
+	const int32 RequestID = NextRequestID++;
+
+	// answer right away if the shared path is already available
+	ResolveRequest(Requests.Add(RequestID, Request));
+
+	return RequestID;
+}
+
+EShooterPathStatus UShooterPathBroker::GetRequestStatus(int32 RequestID, FNavPathSharedPtr& OutPath) const
+{
+	const FShooterPathRequest* Request = Requests.Find(RequestID);
+
+	if (!Request)
+	{
+		return EShooterPathStatus::Failed;
+	}
+
+	OutPath = Request->Path;
+	return Request->Status;
+}
+
+void UShooterPathBroker::ApplyCrowdAvoidance(int32 RequestID) const
+{
+	const FShooterPathRequest* Request = Requests.Find(RequestID);
+
+	if (Request && GetDefault<UShooterAISettings>()->bEnableCrowdAvoidance)
+	{
+		SetCrowdSimulationState(Request->Requester.Get(), GetCrowdSimulationState(Request->SharedID));
+	}
+}
+
+void UShooterPathBroker::ReleaseRequest(int32 RequestID)
+{
+	FShooterPathRequest Request;
+
+	if (!Requests.RemoveAndCopyValue(RequestID, Request))
+	{
+		return;
+	}
+
+	// go back to plain path following once we're done with the corridor, and let the rest of the group know it got smaller
+	if (GetDefault<UShooterAISettings>()->bEnableCrowdAvoidance)
+	{
+		SetCrowdSimulationState(Request.Requester.Get(), ECrowdSimulationState::ObstacleOnly);
+		UpdateCrowdAvoidance(Request.SharedID);
+	}
+
+	// drop the queries nobody else is waiting on
+	for (const int32 SharedID : { Request.SharedID, Request.JoinID, Request.TailID })
+	{
+		const FShooterSharedPath* Shared = SharedPaths.Find(SharedID);
+
+		if (!Shared || Shared->bFinished || HasPendingRequests(SharedID))
+		{
+			continue;
+		}
+
+		// abort the query if it's running
+		if (Shared->QueryID != INVALID_NAVQUERYID)
+		{
+			if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+			{
+				NavSys->AbortAsyncFindPathRequest(Shared->QueryID);
+			}
+		}
+
+		LaunchQueue.Remove(SharedID);
+		SharedPaths.Remove(SharedID);
+	}
+}
+
+int32 UShooterPathBroker::QueueQuery(AShooterAIController* Querier, const FVector& Start, const FVector& Goal, bool bJoin)
+{
+	const int32 SharedID = NextSharedID++;
+
+	FShooterSharedPath& Shared = SharedPaths.Add(SharedID);
+	Shared.Querier = Querier;
+	Shared.Start = Start;
+	Shared.Goal = Goal;
+	Shared.bJoin = bJoin;
+
+	LaunchQueue.Add(SharedID);
+
+	return SharedID;
+}
+
+int32 UShooterPathBroker::FindSharedPath(const FVector& Start, const FVector& Goal, bool bAllowJoin, double Now, int32& OutJoinIndex) const
+{
+	const UShooterAISettings* Settings = GetDefault<UShooterAISettings>();
+	const float GoalRadiusSquared = FMath::Square(Settings->PathShareGoalRadius);
+	const float StartRadiusSquared = FMath::Square(Settings->PathShareStartRadius);
+	const float JoinRadiusSquared = FMath::Square(Settings->PathJoinRadius);
+
+	int32 BestJoinID = INDEX_NONE;
+	float BestJoinDistanceSquared = JoinRadiusSquared;
+
+	for (const TPair<int32, FShooterSharedPath>& Pair : SharedPaths)
+	{
+		const FShooterSharedPath& Shared = Pair.Value;
+
+		if (Shared.bJoin || FVector::DistSquared(Shared.Goal, Goal) > GoalRadiusSquared)
+		{
+			continue;
+		}
+
+		if (Shared.bFinished && (!Shared.Path.IsValid() || Now - Shared.CompletionTime > Settings->PathResultLifetime))
+		{
+			continue;
+		}
+
+		// starting close together, so the whole path can be reused
+		if (FVector::DistSquared(Shared.Start, Start) <= StartRadiusSquared)
+		{
+			OutJoinIndex = INDEX_NONE;
+			return Pair.Key;
+		}
+
+		// otherwise look for the closest corridor point to join, past the start of the path
+		if (!bAllowJoin || !Shared.bFinished)
+		{
+			continue;
+		}
+
+		const TArray<FNavPathPoint>& Points = Shared.Path->GetPathPoints();
+
+		for (int32 i = 1; i < Points.Num() - 1; ++i)
+		{
+			const float DistanceSquared = FVector::DistSquared(Points[i].Location, Start);
+
+			if (DistanceSquared < BestJoinDistanceSquared)
+			{
+				BestJoinDistanceSquared = DistanceSquared;
+				BestJoinID = Pair.Key;
+				OutJoinIndex = i;
+			}
+		}
+	}
+
+	return BestJoinID;
+}
+
+void UShooterPathBroker::OnPathFound(uint32 QueryID, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path)
+{
+	// find the shared path this result belongs to. It may have been released in the meantime
+	for (TPair<int32, FShooterSharedPath>& Pair : SharedPaths)
+	{
+		FShooterSharedPath& Shared = Pair.Value;
+
+		if (Shared.QueryID != QueryID)
+		{
+			continue;
+		}
+
+		Shared.Path = (Result == ENavigationQueryResult::Success && Path.IsValid() && Path->IsValid()) ? Path : nullptr;
+		Shared.bFinished = true;
+		Shared.QueryID = INVALID_NAVQUERYID;
+		Shared.CompletionTime = GetWorld()->GetTimeSeconds();
+
+		break;
+	}
+
+	ResolvePendingRequests();
+}
+
+void UShooterPathBroker::ResolvePendingRequests()
+{
+	// answer everybody whose queries are now all finished
+	for (TPair<int32, FShooterPathRequest>& Pair : Requests)
+	{
+		if (Pair.Value.Status == EShooterPathStatus::Pending)
+		{
+			ResolveRequest(Pair.Value);
+		}
+	}
+}
+
+void UShooterPathBroker::ResolveRequest(FShooterPathRequest& Request)
+{
+	const FShooterSharedPath* Shared = SharedPaths.Find(Request.SharedID);
+	const FShooterSharedPath* Join = SharedPaths.Find(Request.JoinID);
+	const FShooterSharedPath* Tail = SharedPaths.Find(Request.TailID);
+
+	// wait for every query we depend on
+	if ((Shared && !Shared->bFinished) || (Join && !Join->bFinished) || (Tail && !Tail->bFinished))
+	{
+		return;
+	}
+
+	AShooterAIController* Requester = Request.Requester.Get();
+
+	if (!Requester || !Shared || !Shared->Path.IsValid() || Shared->Path->GetPathPoints().IsEmpty()
+		|| (Request.JoinID != INDEX_NONE && (!Join || !Join->Path.IsValid()))
+		|| (Request.TailID != INDEX_NONE && (!Tail || !Tail->Path.IsValid())))
+	{
+		Request.Status = EShooterPathStatus::Failed;
+		return;
+	}
+
+	// a path shared from somebody else's goal may stop short of ours
+	const FVector CorridorEnd = Shared->Path->GetPathPoints().Last().Location;
+
+	if (Request.TailID == INDEX_NONE && Shared->Goal != Request.Goal && FVector::DistSquared(CorridorEnd, Request.Goal) > FMath::Square(Request.AcceptanceRadius))
+	{
+		if (GetDefault<UShooterAISettings>()->bEnableCrowdAvoidance)
+		{
+			// the crowd simulation can't follow spliced point only paths, so query our own path instead
+			APawn* Pawn = Requester->GetPawn();
+
+			if (!Pawn)
+			{
+				Request.Status = EShooterPathStatus::Failed;
+				return;
+			}
+
+			Request.SharedID = QueueQuery(Requester, Pawn->GetActorLocation(), Request.Goal, false);
+			Request.JoinID = INDEX_NONE;
+
+		} else {
+
+			// path the last leg from the end of the corridor to our own goal
+			Request.TailID = QueueQuery(Requester, CorridorEnd, Request.Goal, true);
+		}
+
+		return;
+	}
+
+	if (Join || Tail)
+	{
+		// splice the join path, the rest of the corridor and the tail together
+		TArray<FVector> Points;
+
+		if (Join)
+		{
+			for (const FNavPathPoint& Point : Join->Path->GetPathPoints())
+			{
+				Points.Add(Point.Location);
+			}
+		}
+
+		const TArray<FNavPathPoint>& Corridor = Shared->Path->GetPathPoints();
+
+		for (int32 i = Join ? Request.JoinIndex + 1 : 0; i < Corridor.Num(); ++i)
+		{
+			Points.Add(Corridor[i].Location);
+		}
+
+		// the tail starts where the corridor ends
+		if (Tail)
+		{
+			const TArray<FNavPathPoint>& TailPoints = Tail->Path->GetPathPoints();
+
+			for (int32 i = 1; i < TailPoints.Num(); ++i)
+			{
+				Points.Add(TailPoints[i].Location);
+			}
+		}
+
+		Request.Path = MakeShared<FNavigationPath>(Points);
+
+	} else if (const FNavMeshPath* NavMeshPath = Shared->Path->CastPath<FNavMeshPath>()) {
+
+		// copy the path so each follower can observe and update its own
+		Request.Path = MakeShared<FNavMeshPath>(*NavMeshPath);
+
+	} else {
+
+		Request.Path = MakeShared<FNavigationPath>(*Shared->Path);
+	}
+
+	Request.Status = EShooterPathStatus::Succeeded;
+
+	// the group may have just grown dense enough for crowd avoidance
+	if (GetDefault<UShooterAISettings>()->bEnableCrowdAvoidance)
+	{
+		UpdateCrowdAvoidance(Request.SharedID);
+	}
+}
+
+ECrowdSimulationState UShooterPathBroker::GetCrowdSimulationState(int32 SharedID) const
+{
+	// count the NPCs following the same corridor
+	int32 GroupSize = 0;
+
+	for (const TPair<int32, FShooterPathRequest>& Pair : Requests)
+	{
+		if (Pair.Value.SharedID == SharedID && Pair.Value.Status == EShooterPathStatus::Succeeded)
+		{
+			++GroupSize;
+		}
+	}
+
+	// dense groups avoid each other through the crowd simulation. Everybody else stays a static obstacle
+	return GroupSize >= GetDefault<UShooterAISettings>()->CrowdAvoidanceGroupSize ? ECrowdSimulationState::Enabled : ECrowdSimulationState::ObstacleOnly;
+}
+
+void UShooterPathBroker::UpdateCrowdAvoidance(int32 SharedID) const
+{
+	const ECrowdSimulationState State = GetCrowdSimulationState(SharedID);
+
+	// members already moving keep their state until their next move, since it can't be switched mid move
+	for (const TPair<int32, FShooterPathRequest>& Pair : Requests)
+	{
+		if (Pair.Value.SharedID == SharedID && Pair.Value.Status == EShooterPathStatus::Succeeded)
+		{
+			SetCrowdSimulationState(Pair.Value.Requester.Get(), State);
+		}
+	}
+}
+
+void UShooterPathBroker::SetCrowdSimulationState(const AShooterAIController* Controller, ECrowdSimulationState State)
+{
+	UCrowdFollowingComponent* CrowdFollowing = Controller ? Cast<UCrowdFollowingComponent>(Controller->GetPathFollowingComponent()) : nullptr;
+
+	if (CrowdFollowing && CrowdFollowing->GetStatus() == EPathFollowingStatus::Idle)
+	{
+		CrowdFollowing->SetCrowdSimulationState(State);
+	}
+}
+
+bool UShooterPathBroker::HasPendingRequests(int32 SharedID) const
+{
+	for (const TPair<int32, FShooterPathRequest>& Pair : Requests)
+	{
+		if ((Pair.Value.SharedID == SharedID || Pair.Value.JoinID == SharedID || Pair.Value.TailID == SharedID) && Pair.Value.Status == EShooterPathStatus::Pending)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
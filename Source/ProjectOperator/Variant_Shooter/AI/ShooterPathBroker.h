@@ -0,0 +1,174 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "Navigation/CrowdFollowingComponent.h"
+#include "ShooterPathBroker.generated.h"
+
+class AShooterAIController;
+
+/**
+ *  Status of a brokered path request
+ */
+enum class EShooterPathStatus : uint8
+{
+	Pending,
+	Succeeded,
+	Failed
+};
+
+/**
+ *  Path query run once on behalf of every nearby NPC heading to roughly the same goal
+ */
+struct FShooterSharedPath
+{
+	/** Controller the query is run as */
+	TWeakObjectPtr<AShooterAIController> Querier;
+
+	/** Start of the query */
+	FVector Start = FVector::ZeroVector;
+
+	/** Goal of the query */
+	FVector Goal = FVector::ZeroVector;
+
+	/** Async query ID while running */
+	uint32 QueryID = INVALID_NAVQUERYID;
+
+	/** Resulting path, if the query succeeded */
+	FNavPathSharedPtr Path;
+
+	/** Game time the query finished at */
+	double CompletionTime = 0.0;
+
+	/** True once the query has finished */
+	bool bFinished = false;
+
+	/** True if this query only links a single requester to another shared path, so it can't be shared itself */
+	bool bJoin = false;
+};
+
+/**
+ *  Single NPC's request for a brokered path
+ */
+struct FShooterPathRequest
+{
+	/** Requesting controller */
+	TWeakObjectPtr<AShooterAIController> Requester;
+
+	/** Requester's own goal, which may differ from the goal of the shared path */
+	FVector Goal = FVector::ZeroVector;
+
+	/** Distance from the goal the requester is happy to stop at */
+	float AcceptanceRadius = 0.0f;
+
+	/** Shared path leading to the goal */
+	int32 SharedID = INDEX_NONE;
+
+	/** Shared path linking the requester to the corridor, if the corridor is only partially shared */
+	int32 JoinID = INDEX_NONE;
+
+	/** Corridor point index the join path leads to */
+	int32 JoinIndex = INDEX_NONE;
+
+	/** Shared path linking the end of the corridor to the requester's own goal, if the corridor ends too far from it */
+	int32 TailID = INDEX_NONE;
+
+	/** Current status */
+	EShooterPathStatus Status = EShooterPathStatus::Pending;
+
+	/** Path built for this requester */
+	FNavPathSharedPtr Path;
+};
+
+/**
+ *  Shared async path request broker for the shooter AI
+ *  Requests toward goals close to each other reuse a single navmesh query, either whole when
+ *  the requesters start close together or partially by joining the existing corridor
+ *  Queries run asynchronously on the navigation system's worker threads under a global per-frame and in flight budget
+ */
+UCLASS()
+class PROJECTOPERATOR_API UShooterPathBroker : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Shared path queries, by shared ID */
+	TMap<int32, FShooterSharedPath> SharedPaths;
+
+	/** Shared path queries waiting to be started */
+	TArray<int32> LaunchQueue;
+
+	/** Requests, by request ID */
+	TMap<int32, FShooterPathRequest> Requests;
+
+	/** ID to assign to the next shared path */
+	int32 NextSharedID = 0;
+
+	/** ID to assign to the next request */
+	int32 NextRequestID = 0;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Starts queued queries within the budget and discards expired paths */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable object */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/**
+	 *  Requests a path from the requester's pawn to the goal
+	 *  Returns the request ID, or INDEX_NONE if the request is invalid
+	 *  @param AcceptanceRadius shared paths ending further than this from the goal are extended to it
+	 */
+	int32 RequestPath(AShooterAIController* Requester, const FVector& Goal, float AcceptanceRadius);
+
+	/** Returns the status of a request and, once it has succeeded, the path built for it */
+	EShooterPathStatus GetRequestStatus(int32 RequestID, FNavPathSharedPtr& OutPath) const;
+
+	/** Switches the requester to the crowd simulation state for its corridor group. Call right before starting the move, since it's ignored while moving */
+	void ApplyCrowdAvoidance(int32 RequestID) const;
+
+	/** Discards a request. Shared queries nobody is waiting on anymore are aborted */
+	void ReleaseRequest(int32 RequestID);
+
+protected:
+
+	/** Queues a new path query. Returns its shared ID */
+	int32 QueueQuery(AShooterAIController* Querier, const FVector& Start, const FVector& Goal, bool bJoin);
+
+	/**
+	 *  Finds a shared path toward the goal
+	 *  @param OutJoinIndex set to the corridor point to join if the requester starts too far away to reuse the whole path
+	 */
+	int32 FindSharedPath(const FVector& Start, const FVector& Goal, bool bAllowJoin, double Now, int32& OutJoinIndex) const;
+
+	/** Handles async path query completion */
+	void OnPathFound(uint32 QueryID, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path);
+
+	/** Resolves every pending request whose queries have all finished */
+	void ResolvePendingRequests();
+
+	/** Builds the requester's path once every query it depends on has finished */
+	void ResolveRequest(FShooterPathRequest& Request);
+
+	/** Returns crowd simulation for dense corridor groups, and plain path following with static obstacles otherwise */
+	ECrowdSimulationState GetCrowdSimulationState(int32 SharedID) const;
+
+	/** Applies the corridor group's crowd simulation state to every member that isn't moving */
+	void UpdateCrowdAvoidance(int32 SharedID) const;
+
+	/** Sets the crowd simulation state on the controller's path following. Ignored while it's moving */
+	static void SetCrowdSimulationState(const AShooterAIController* Controller, ECrowdSimulationState State);
+
+	/** Returns true if any pending request is waiting on the given shared path */
+	bool HasPendingRequests(int32 SharedID) const;
+};
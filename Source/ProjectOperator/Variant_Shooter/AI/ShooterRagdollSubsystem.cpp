@@ -0,0 +1,144 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterRagdollSubsystem.h"
+#include "Variant_Shooter/AI/ShooterNPC.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "Settings/ShooterAISettings.h"
+#include "ProjectOperator.h"
+
+DECLARE_CYCLE_STAT(TEXT("Ragdoll Budget"), STAT_ShooterRagdollBudget, STATGROUP_ShooterAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active Ragdolls"), STAT_ShooterActiveRagdolls, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Ragdolls Frozen"), STAT_ShooterRagdollsFrozen, STATGROUP_ShooterAI);
+
+bool UShooterRagdollSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterRagdollSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterRagdollBudget);
+
+	// drop ragdolls whose NPC is gone
+	ActiveRagdolls.RemoveAll([](const FShooterActiveRagdoll& Ragdoll) { return !Ragdoll.NPC.IsValid(); });
+
+	SET_DWORD_STAT(STAT_ShooterActiveRagdolls, ActiveRagdolls.Num());
+
+	if (ActiveRagdolls.IsEmpty())
+	{
+		return;
+	}
+
+	const UShooterAISettings* Settings = GetDefault<UShooterAISettings>();
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// sleep settled ragdolls and freeze the ones that are asleep or out of time
+	for (int32 i = ActiveRagdolls.Num() - 1; i >= 0; --i)
+	{
+		FShooterActiveRagdoll& Ragdoll = ActiveRagdolls[i];
+		AShooterNPC* NPC = Ragdoll.NPC.Get();
+		USkeletalMeshComponent* Mesh = NPC->GetMesh();
+
+		const double SimTime = Now - Ragdoll.StartTime;
+
+		// give the ragdoll a moment to react to the killing blow
+		if (SimTime < Settings->RagdollMinSimTime)
+		{
+			continue;
+		}
+
+		if (SimTime >= Settings->RagdollMaxSimTime || (Ragdoll.bSleeping && !Mesh->IsAnyRigidBodyAwake()))
+		{
+			INC_DWORD_STAT(STAT_ShooterRagdollsFrozen);
+
+			NPC->FreezeRagdoll();
+			ActiveRagdolls.RemoveAtSwap(i, EAllowShrinking::No);
+			continue;
+		}
+
+		// put slow ragdolls to sleep instead of waiting for the solver to do it
+		if (!Ragdoll.bSleeping && Mesh->GetPhysicsLinearVelocity().SizeSquared() <= FMath::Square(Settings->RagdollSettleSpeed))
+		{
+			Mesh->PutAllRigidBodiesToSleep();
+			Ragdoll.bSleeping = true;
+		}
+	}
+
+	// over the cap, so freeze the ragdolls furthest from the players first
+	const int32 NumOverCap = ActiveRagdolls.Num() - Settings->MaxActiveRagdolls;
+
+	if (NumOverCap > 0)
+	{
+		GatherViewLocations();
+
+		ActiveRagdolls.Sort([this](const FShooterActiveRagdoll& A, const FShooterActiveRagdoll& B)
+		{
+			return GetDistanceSquaredToNearestView(A.NPC->GetMesh()->GetComponentLocation()) > GetDistanceSquaredToNearestView(B.NPC->GetMesh()->GetComponentLocation());
+		});
+
+		for (int32 i = 0; i < NumOverCap; ++i)
+		{
+			INC_DWORD_STAT(STAT_ShooterRagdollsFrozen);
+
+			ActiveRagdolls[i].NPC->FreezeRagdoll();
+		}
+
+		ActiveRagdolls.RemoveAt(0, NumOverCap, EAllowShrinking::No);
+	}
+}
+
+TStatId UShooterRagdollSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterRagdollSubsystem, STATGROUP_Tickables);
+}
+
+void UShooterRagdollSubsystem::AddRagdoll(AShooterNPC* NPC)
+{
+	RemoveRagdoll(NPC);
+
+	FShooterActiveRagdoll& Ragdoll = ActiveRagdolls.AddDefaulted_GetRef();
+	Ragdoll.NPC = NPC;
+	Ragdoll.StartTime = GetWorld()->GetTimeSeconds();
+}
+
+void UShooterRagdollSubsystem::RemoveRagdoll(AShooterNPC* NPC)
+{
+	ActiveRagdolls.RemoveAll([NPC](const FShooterActiveRagdoll& Ragdoll) { return Ragdoll.NPC == NPC; });
+}
+
+void UShooterRagdollSubsystem::GatherViewLocations()
+{
+	ViewLocations.Reset();
+
+	// only local player controllers are iterated on clients, which is what we want
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PC = It->Get();
+
+		if (PC && PC->GetPawn())
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+			ViewLocations.Add(ViewLocation);
+		}
+	}
+}
+
+float UShooterRagdollSubsystem::GetDistanceSquaredToNearestView(const FVector& Location) const
+{
+	float BestDistanceSquared = MAX_flt;
+
+	for (const FVector& ViewLocation : ViewLocations)
+	{
+		BestDistanceSquared = FMath::Min(BestDistanceSquared, FVector::DistSquared(Location, ViewLocation));
+	}
+
+	return BestDistanceSquared;
+}
@@ -0,0 +1,73 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterRagdollSubsystem.generated.h"
+
+class AShooterNPC;
+
+/**
+ *  A ragdoll currently simulating physics
+ */
+struct FShooterActiveRagdoll
+{
+	/** NPC playing the ragdoll death */
+	TWeakObjectPtr<AShooterNPC> NPC;
+
+	/** Game time the ragdoll started simulating */
+	double StartTime = 0.0;
+
+	/** If true, the bodies have settled and were put to sleep early */
+	bool bSleeping = false;
+};
+
+/**
+ *  Bounds the physics cost of shooter NPC ragdoll deaths
+ *  Caps the number of concurrently simulated ragdolls, freezing the ones furthest from the players first.
+ *  Ragdolls that slow down are put to sleep early, and frozen into a static pose snapshot once asleep or out of time
+ */
+UCLASS()
+class PROJECTOPERATOR_API UShooterRagdollSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Ragdolls currently simulating */
+	TArray<FShooterActiveRagdoll> ActiveRagdolls;
+
+	/** View locations of the local players, or every player on a server */
+	TArray<FVector> ViewLocations;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Sleeps, freezes and culls ragdolls */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable object */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/** Starts tracking a ragdoll that has just started simulating */
+	void AddRagdoll(AShooterNPC* NPC);
+
+	/** Stops tracking a ragdoll, e.g. when the NPC is reset for respawn */
+	void RemoveRagdoll(AShooterNPC* NPC);
+
+	/** Returns the number of ragdolls currently simulating */
+	int32 GetNumActiveRagdolls() const { return ActiveRagdolls.Num(); }
+
+protected:
+
+	/** Gathers the locations ragdoll distances are measured from */
+	void GatherViewLocations();
+
+	/** Returns the squared distance from the location to the nearest view location */
+	float GetDistanceSquaredToNearestView(const FVector& Location) const;
+};
@@ -0,0 +1,195 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterSpawnDirector.h"
+#include "Variant_Shooter/AI/ShooterNPC.h"
+#include "Variant_Shooter/AI/ShooterBotSubsystem.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/World.h"
+#include "Settings/ShooterAISettings.h"
+#include "ProjectOperator.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spawn Director"), STAT_ShooterSpawnDirector, STATGROUP_ShooterAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pending NPC Spawns"), STAT_ShooterPendingSpawns, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("NPC Spawns"), STAT_ShooterSpawns, STATGROUP_ShooterAI);
+
+bool UShooterSpawnDirector::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterSpawnDirector::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterSpawnDirector);
+
+	SET_DWORD_STAT(STAT_ShooterPendingSpawns, PendingSpawns.Num());
+
+	if (PendingSpawns.IsEmpty())
+	{
+		return;
+	}
+
+	const UShooterAISettings* Settings = GetDefault<UShooterAISettings>();
+
+	const double StartTime = FPlatformTime::Seconds();
+	const double BudgetSeconds = Settings->SpawnBudgetMs * 0.001;
+
+	int32 NumSpawned = 0;
+	int32 WriteIndex = 0;
+
+	for (int32 ReadIndex = 0; ReadIndex < PendingSpawns.Num(); ++ReadIndex)
+	{
+		const FShooterPendingSpawn& PendingSpawn = PendingSpawns[ReadIndex];
+
+		// always spawn at least one NPC per frame so the queue keeps moving
+		const bool bWithinBudget = NumSpawned == 0 || (NumSpawned < Settings->MaxSpawnsPerFrame && FPlatformTime::Seconds() - StartTime < BudgetSeconds);
+
+		// spawns waiting on their class load don't hold up the rest of the queue
+		UClass* LoadedClass = bWithinBudget ? PendingSpawn.NPCClass.Get() : nullptr;
+
+		if (LoadedClass)
+		{
+			Spawn(PendingSpawn, LoadedClass);
+			++NumSpawned;
+
+		} else if (HasClassLoadFailed(PendingSpawn.NPCClass)) {
+
+			// the class will never load, so drop the spawn instead of waiting on it forever
+			continue;
+
+		} else {
+
+			// keep it for a later frame, preserving the queue order
+			if (WriteIndex != ReadIndex)
+			{
+				PendingSpawns[WriteIndex] = MoveTemp(PendingSpawns[ReadIndex]);
+			}
+
+			++WriteIndex;
+		}
+	}
+
+	PendingSpawns.SetNum(WriteIndex, EAllowShrinking::No);
+
+	INC_DWORD_STAT_BY(STAT_ShooterSpawns, NumSpawned);
+}
+
+TStatId UShooterSpawnDirector::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterSpawnDirector, STATGROUP_Tickables);
+}
+
+void UShooterSpawnDirector::PreloadWave(const FShooterSpawnWave& Wave)
+{
+	for (const FShooterSpawnWaveEntry& Entry : Wave.Entries)
+	{
+		RequestClassLoad(Entry.NPCClass);
+	}
+}
+
+void UShooterSpawnDirector::QueueWave(const FShooterSpawnWave& Wave)
+{
+	// only the server spawns NPCs
+	if (GetWorld()->GetNetMode() == NM_Client || Wave.SpawnTransforms.IsEmpty())
+	{
+		return;
+	}
+
+	PreloadWave(Wave);
+
+	int32 TransformIndex = 0;
+
+	for (const FShooterSpawnWaveEntry& Entry : Wave.Entries)
+	{
+		if (Entry.NPCClass.IsNull())
+		{
+			continue;
+		}
+
+		for (int32 i = 0; i < Entry.Count; ++i)
+		{
+			FShooterPendingSpawn& PendingSpawn = PendingSpawns.AddDefaulted_GetRef();
+			PendingSpawn.NPCClass = Entry.NPCClass;
+			PendingSpawn.Transform = Wave.SpawnTransforms[TransformIndex];
+			PendingSpawn.TeamByte = Entry.TeamByte;
+			PendingSpawn.SquadName = Entry.SquadName;
+
+			TransformIndex = (TransformIndex + 1) % Wave.SpawnTransforms.Num();
+		}
+	}
+}
+
+bool UShooterSpawnDirector::IsWaveLoaded(const FShooterSpawnWave& Wave) const
+{
+	for (const FShooterSpawnWaveEntry& Entry : Wave.Entries)
+	{
+		if (!Entry.NPCClass.IsNull() && !Entry.NPCClass.Get())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void UShooterSpawnDirector::RequestClassLoad(const TSoftClassPtr<AShooterNPC>& NPCClass)
+{
+	if (NPCClass.IsNull())
+	{
+		return;
+	}
+
+	const FSoftObjectPath& ClassPath = NPCClass.ToSoftObjectPath();
+
+	// already loaded or loading
+	if (LoadHandles.Contains(ClassPath))
+	{
+		return;
+	}
+
+	// the weapon and animation classes are hard references on the NPC class, so they come in with the same load
+	LoadHandles.Add(ClassPath, UAssetManager::GetStreamableManager().RequestAsyncLoad(ClassPath));
+}
+
+bool UShooterSpawnDirector::HasClassLoadFailed(const TSoftClassPtr<AShooterNPC>& NPCClass)
+{
+	const FSoftObjectPath& ClassPath = NPCClass.ToSoftObjectPath();
+	const TSharedPtr<FStreamableHandle>* Handle = LoadHandles.Find(ClassPath);
+
+	// the failure was already reported for an earlier spawn
+	if (!Handle)
+	{
+		return true;
+	}
+
+	// still loading
+	if (Handle->IsValid() && !(*Handle)->HasLoadCompleted() && !(*Handle)->WasCanceled())
+	{
+		return false;
+	}
+
+	// the load is done, so we either have an NPC class or never will
+	if (NPCClass.Get())
+	{
+		return false;
+	}
+
+	UE_LOG(LogProjectOperator, Warning, TEXT("Spawn director: couldn't load NPC class %s. Dropping its pending spawns"), *ClassPath.ToString());
+
+	// forget the load so a later wave can try again
+	LoadHandles.Remove(ClassPath);
+
+	return true;
+}
+
+void UShooterSpawnDirector::Spawn(const FShooterPendingSpawn& PendingSpawn, TSubclassOf<AShooterNPC> NPCClass)
+{
+	// let the hybrid LOD decide between an entity and a full, preferably pooled, actor
+	if (UShooterBotSubsystem* BotSubsystem = GetWorld()->GetSubsystem<UShooterBotSubsystem>())
+	{
+		BotSubsystem->SpawnBot(NPCClass, PendingSpawn.Transform, PendingSpawn.TeamByte, PendingSpawn.SquadName);
+	}
+}
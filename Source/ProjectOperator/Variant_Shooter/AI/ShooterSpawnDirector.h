@@ -0,0 +1,131 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/SoftObjectPtr.h"
+#include "ShooterSpawnDirector.generated.h"
+
+class AShooterNPC;
+struct FStreamableHandle;
+
+/**
+ *  A group of identical NPCs within a spawn wave
+ */
+USTRUCT(BlueprintType)
+struct FShooterSpawnWaveEntry
+{
+	GENERATED_BODY()
+
+	/** NPC class to spawn. Loaded asynchronously along with the weapon and animation classes it references */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawning")
+	TSoftClassPtr<AShooterNPC> NPCClass;
+
+	/** Number of NPCs to spawn */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawning", meta = (ClampMin = 0))
+	int32 Count = 1;
+
+	/** Team to assign to the spawned NPCs */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawning")
+	uint8 TeamByte = 1;
+
+	/** Squad to assign to the spawned NPCs */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawning")
+	FName SquadName;
+};
+
+/**
+ *  A set of NPCs to bring into the level together
+ */
+USTRUCT(BlueprintType)
+struct FShooterSpawnWave
+{
+	GENERATED_BODY()
+
+	/** NPCs to spawn */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawning")
+	TArray<FShooterSpawnWaveEntry> Entries;
+
+	/** Transforms to spawn at. NPCs cycle through them in order */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawning")
+	TArray<FTransform> SpawnTransforms;
+};
+
+/**
+ *  A single NPC waiting to be spawned
+ */
+struct FShooterPendingSpawn
+{
+	/** NPC class to spawn */
+	TSoftClassPtr<AShooterNPC> NPCClass;
+
+	/** Where to spawn */
+	FTransform Transform;
+
+	/** Team to assign */
+	uint8 TeamByte = 0;
+
+	/** Squad to assign */
+	FName SquadName;
+};
+
+/**
+ *  Spreads NPC spawn waves across frames
+ *  NPC classes are loaded asynchronously ahead of time, and queued spawns are only started once their class is in memory.
+ *  Each frame spawns as many NPCs as fit within a millisecond budget and a spawn cap.
+ *  Spawns go through the hybrid LOD, so distant NPCs start out as entities and nearby ones reuse pooled actors when possible
+ */
+UCLASS()
+class PROJECTOPERATOR_API UShooterSpawnDirector : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Spawns waiting for their class to load or for frame budget, in order */
+	TArray<FShooterPendingSpawn> PendingSpawns;
+
+	/** Async load handles, kept so loaded classes stay resident. By class path */
+	TMap<FSoftObjectPath, TSharedPtr<FStreamableHandle>> LoadHandles;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Spawns queued NPCs within the frame budget */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable object */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/** Starts loading the classes used by the wave, so a later QueueWave can spawn right away */
+	UFUNCTION(BlueprintCallable, Category = "Spawning")
+	void PreloadWave(const FShooterSpawnWave& Wave);
+
+	/** Queues every NPC in the wave for spawning, loading their classes first if needed */
+	UFUNCTION(BlueprintCallable, Category = "Spawning")
+	void QueueWave(const FShooterSpawnWave& Wave);
+
+	/** Returns true if every class used by the wave is loaded */
+	UFUNCTION(BlueprintPure, Category = "Spawning")
+	bool IsWaveLoaded(const FShooterSpawnWave& Wave) const;
+
+	/** Returns the number of NPCs still waiting to spawn */
+	UFUNCTION(BlueprintPure, Category = "Spawning")
+	int32 GetNumPendingSpawns() const { return PendingSpawns.Num(); }
+
+protected:
+
+	/** Requests an async load of the class if it's not loaded or loading already */
+	void RequestClassLoad(const TSoftClassPtr<AShooterNPC>& NPCClass);
+
+	/** Returns true if the class load finished without an NPC class. Logs the failure and forgets the load the first time */
+	bool HasClassLoadFailed(const TSoftClassPtr<AShooterNPC>& NPCClass);
+
+	/** Spawns a single NPC through the hybrid LOD */
+	void Spawn(const FShooterPendingSpawn& PendingSpawn, TSubclassOf<AShooterNPC> NPCClass);
+};
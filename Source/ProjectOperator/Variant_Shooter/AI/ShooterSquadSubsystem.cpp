@@ -0,0 +1,181 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterSquadSubsystem.h"
+#include "Variant_Shooter/AI/ShooterAIController.h"
+#include "Variant_Shooter/AI/ShooterNPC.h"
+#include "Engine/World.h"
+#include "Settings/ShooterAISettings.h"
+#include "ProjectOperator.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Squad Sightings Published"), STAT_ShooterSquadPublished, STATGROUP_ShooterAI);
+
+bool UShooterSquadSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterSquadSubsystem::RegisterMember(AShooterAIController* Controller, FName SquadName)
+{
+	if (!IsValid(Controller) || SquadName.IsNone())
+	{
+		return;
+	}
+
+	FShooterSquad& Squad = Squads.FindOrAdd(SquadName);
+	Squad.Members.AddUnique(Controller);
+
+	ApplyRoles(Squad);
+}
+
+void UShooterSquadSubsystem::UnregisterMember(AShooterAIController* Controller)
+{
+	FName SquadName;
+	FShooterSquad* Squad = FindSquad(Controller, &SquadName);
+
+	if (!Squad)
+	{
+		return;
+	}
+
+	Squad->Members.Remove(Controller);
+
+	// go back to full perception on our own
+	if (IsValid(Controller))
+	{
+		Controller->SetSquadFollower(false);
+	}
+
+	// drop the squad once everybody is gone
+	if (Squad->Members.IsEmpty())
+	{
+		Squads.Remove(SquadName);
+		return;
+	}
+
+	// the leader may have changed
+	ApplyRoles(*Squad);
+}
+
+void UShooterSquadSubsystem::PublishSighting(const AShooterAIController* Controller, AActor* Target, const FVector& Location, float Confidence)
+{
+	FShooterSquad* Squad = FindSquad(Controller);
+
+	if (!Squad || !IsValid(Target))
+	{
+		return;
+	}
+
+	INC_DWORD_STAT(STAT_ShooterSquadPublished);
+
+	// replace the previous sighting of the same target
+	FShooterSquadSighting* Sighting = Squad->Sightings.FindByPredicate([Target](const FShooterSquadSighting& Existing) { return Existing.Target == Target; });
+
+	if (!Sighting)
+	{
+		Sighting = &Squad->Sightings.AddDefaulted_GetRef();
+		Sighting->Target = Target;
+	}
+
+	Sighting->Location = Location;
+	Sighting->Time = GetWorld()->GetTimeSeconds();
+	Sighting->Confidence = Confidence;
+}
+
+bool UShooterSquadSubsystem::GetBestSighting(const AShooterAIController* Controller, FShooterSquadSighting& OutSighting, float& OutConfidence) const
+{
+	const FShooterSquad* Squad = FindSquad(Controller);
+
+	if (!Squad)
+	{
+		return false;
+	}
+
+	const float Lifetime = GetDefault<UShooterAISettings>()->SquadSightingLifetime;
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	OutConfidence = 0.0f;
+
+	for (const FShooterSquadSighting& Sighting : Squad->Sightings)
+	{
+		if (!Sighting.Target.IsValid())
+		{
+			continue;
+		}
+
+		// confidence fades out linearly over the sighting lifetime
+		const float Age = static_cast<float>(Now - Sighting.Time);
+		const float Confidence = Sighting.Confidence * FMath::Max(0.0f, 1.0f - Age / Lifetime);
+
+		if (Confidence > OutConfidence)
+		{
+			OutSighting = Sighting;
+			OutConfidence = Confidence;
+		}
+	}
+
+	return OutConfidence > 0.0f;
+}
+
+FShooterSquad* UShooterSquadSubsystem::FindSquad(const AShooterAIController* Controller, FName* OutSquadName /*= nullptr*/)
+{
+	for (TPair<FName, FShooterSquad>& Pair : Squads)
+	{
+		if (Pair.Value.Members.Contains(Controller))
+		{
+			if (OutSquadName)
+			{
+				*OutSquadName = Pair.Key;
+			}
+
+			return &Pair.Value;
+		}
+	}
+
+	return nullptr;
+}
+
+const FShooterSquad* UShooterSquadSubsystem::FindSquad(const AShooterAIController* Controller) const
+{
+	return const_cast<UShooterSquadSubsystem*>(this)->FindSquad(Controller);
+}
+
+void UShooterSquadSubsystem::ApplyRoles(FShooterSquad& Squad)
+{
+	// drop members destroyed without unregistering, and sightings of targets that are gone
+	Squad.Members.RemoveAll([](const TWeakObjectPtr<AShooterAIController>& Member) { return !Member.IsValid(); });
+	Squad.Sightings.RemoveAll([](const FShooterSquadSighting& Sighting) { return !Sighting.Target.IsValid(); });
+
+	ElectLeader(Squad);
+
+	for (int32 i = 0; i < Squad.Members.Num(); ++i)
+	{
+		Squad.Members[i]->SetSquadFollower(i > 0);
+	}
+}
+
+void UShooterSquadSubsystem::ElectLeader(FShooterSquad& Squad)
+{
+	if (Squad.Members.IsEmpty() || IsMemberAlive(Squad.Members[0].Get()))
+	{
+		return;
+	}
+
+	// promote the longest standing living member. If nobody is alive the order doesn't matter
+	const int32 NewLeader = Squad.Members.IndexOfByPredicate([](const TWeakObjectPtr<AShooterAIController>& Member) { return IsMemberAlive(Member.Get()); });
+
+	if (NewLeader != INDEX_NONE)
+	{
+		const TWeakObjectPtr<AShooterAIController> Leader = Squad.Members[NewLeader];
+
+		Squad.Members.RemoveAt(NewLeader);
+		Squad.Members.Insert(Leader, 0);
+	}
+}
+
+bool UShooterSquadSubsystem::IsMemberAlive(const AShooterAIController* Controller)
+{
+	const AShooterNPC* NPC = Controller ? Cast<AShooterNPC>(Controller->GetPawn()) : nullptr;
+
+	return NPC && !NPC->IsDead() && !NPC->IsPooled();
+}
@@ -0,0 +1,94 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterSquadSubsystem.generated.h"
+
+class AShooterAIController;
+
+/**
+ *  Last confirmed sighting of a target, shared by a squad
+ */
+struct FShooterSquadSighting
+{
+	/** Actor that was seen */
+	TWeakObjectPtr<AActor> Target;
+
+	/** Where the target was seen */
+	FVector Location = FVector::ZeroVector;
+
+	/** Game time of the sighting */
+	double Time = 0.0;
+
+	/** Confidence of the sighting when it was published, from 0 to 1 */
+	float Confidence = 0.0f;
+};
+
+/**
+ *  Shared knowledge and membership for a squad
+ */
+struct FShooterSquad
+{
+	/** Squad members. The first one is the leader, and is always alive while any member is */
+	TArray<TWeakObjectPtr<AShooterAIController>> Members;
+
+	/** Latest sighting of each target */
+	TArray<FShooterSquadSighting> Sightings;
+};
+
+/**
+ *  Squad knowledge for the shooter AI
+ *  Members publish confirmed sightings to their squad and read the squad's best sighting back,
+ *  so only the leader needs full perception and the rest of the squad runs on reduced senses
+ */
+UCLASS()
+class PROJECTOPERATOR_API UShooterSquadSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Squads by name */
+	TMap<FName, FShooterSquad> Squads;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+public:
+
+	/** Adds a controller to a squad. The first member becomes the leader */
+	void RegisterMember(AShooterAIController* Controller, FName SquadName);
+
+	/** Removes a controller from its squad, promoting a new leader if needed */
+	void UnregisterMember(AShooterAIController* Controller);
+
+	/** Publishes a confirmed sighting to the controller's squad */
+	void PublishSighting(const AShooterAIController* Controller, AActor* Target, const FVector& Location, float Confidence);
+
+	/**
+	 *  Returns the squad's most confident sighting, aged by the configured lifetime
+	 *  @param OutConfidence confidence of the sighting after aging
+	 */
+	bool GetBestSighting(const AShooterAIController* Controller, FShooterSquadSighting& OutSighting, float& OutConfidence) const;
+
+protected:
+
+	/** Returns the squad the controller belongs to */
+	FShooterSquad* FindSquad(const AShooterAIController* Controller, FName* OutSquadName = nullptr);
+
+	/** Returns the squad the controller belongs to */
+	const FShooterSquad* FindSquad(const AShooterAIController* Controller) const;
+
+	/** Moves the first living member to the front, so a dead leader is replaced right away */
+	static void ElectLeader(FShooterSquad& Squad);
+
+	/** Gives every member the perception role matching its position in the squad */
+	static void ApplyRoles(FShooterSquad& Squad);
+
+	/** Returns true if the member's pawn is alive and in play */
+	static bool IsMemberAlive(const AShooterAIController* Controller);
+};
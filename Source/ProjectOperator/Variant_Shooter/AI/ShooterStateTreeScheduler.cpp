@@ -0,0 +1,182 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterStateTreeScheduler.h"
+#include "Components/StateTreeComponent.h"
+#include "Settings/ShooterAISettings.h"
+#include "ProjectOperator.h"
+
+DECLARE_CYCLE_STAT(TEXT("StateTree Scheduler Tick"), STAT_ShooterStateTreeScheduler, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("StateTree Ticks"), STAT_ShooterStateTreeTicks, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("StateTree Deferred Ticks"), STAT_ShooterStateTreeDeferred, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("StateTree Starved Ticks"), STAT_ShooterStateTreeStarved, STATGROUP_ShooterAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("StateTree Scheduled Trees"), STAT_ShooterStateTreeAgents, STATGROUP_ShooterAI);
+
+bool UShooterStateTreeScheduler::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterStateTreeScheduler::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterStateTreeScheduler);
+
+	Super::Tick(DeltaTime);
+
+	// drop components destroyed since the last frame
+	Agents.RemoveAll([](const FShooterStateTreeAgent& Agent) { return !Agent.StateTree.IsValid(); });
+
+	SET_DWORD_STAT(STAT_ShooterStateTreeAgents, Agents.Num());
+
+	if (Agents.IsEmpty())
+	{
+		return;
+	}
+
+	const UShooterAISettings* Settings = GetDefault<UShooterAISettings>();
+	const double BudgetSeconds = Settings->StateTreeBudgetMs / 1000.0;
+	const double StartTime = FPlatformTime::Seconds();
+
+	// advance every agent's clock and collect the starved ones
+	TArray<int32> Starved;
+
+	for (int32 i = 0; i < Agents.Num(); ++i)
+	{
+		FShooterStateTreeAgent& Agent = Agents[i];
+		Agent.TimeSinceTick += DeltaTime;
+
+		if (Agent.TimeSinceTick >= Agent.TickInterval + Settings->StateTreeStarvationTime)
+		{
+			Starved.Add(i);
+		}
+	}
+
+	// most overdue first
+	Starved.Sort([this](int32 A, int32 B)
+	{
+		return Agents[A].TimeSinceTick - Agents[A].TickInterval > Agents[B].TimeSinceTick - Agents[B].TickInterval;
+	});
+
+	int32 NumTicked = 0;
+
+	// returns true if there's still time left this frame. The first tick is always allowed so nothing starves forever
+	auto HasBudget = [&NumTicked, StartTime, BudgetSeconds]()
+	{
+		return NumTicked == 0 || FPlatformTime::Seconds() - StartTime < BudgetSeconds;
+	};
+
+	// tick the starved agents ahead of the round robin
+	for (int32 Index : Starved)
+	{
+		if (!HasBudget())
+		{
+			break;
+		}
+
+		TickAgent(Agents[Index]);
+		++NumTicked;
+
+		INC_DWORD_STAT(STAT_ShooterStateTreeStarved);
+	}
+
+	// round robin through the remaining due agents
+	Cursor = Cursor % Agents.Num();
+
+	int32 NextCursor = Cursor;
+
+	for (int32 Offset = 0; Offset < Agents.Num(); ++Offset)
+	{
+		const int32 Index = (Cursor + Offset) % Agents.Num();
+		FShooterStateTreeAgent& Agent = Agents[Index];
+
+		// skip agents that aren't due, including the starved ones we just ticked
+		if (Agent.TimeSinceTick < Agent.TickInterval || Agent.TimeSinceTick == 0.0f)
+		{
+			continue;
+		}
+
+		if (!HasBudget())
+		{
+			INC_DWORD_STAT(STAT_ShooterStateTreeDeferred);
+			continue;
+		}
+
+		TickAgent(Agent);
+		++NumTicked;
+
+		// resume after the last agent we ticked on the next frame
+		NextCursor = Index + 1;
+	}
+
+	Cursor = NextCursor;
+}
+
+TStatId UShooterStateTreeScheduler::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterStateTreeScheduler, STATGROUP_Tickables);
+}
+
+void UShooterStateTreeScheduler::RegisterStateTree(UStateTreeComponent* StateTree)
+{
+	if (!IsValid(StateTree))
+	{
+		return;
+	}
+
+	// ignore duplicate registrations
+	for (const FShooterStateTreeAgent& Agent : Agents)
+	{
+		if (Agent.StateTree == StateTree)
+		{
+			return;
+		}
+	}
+
+	FShooterStateTreeAgent& Agent = Agents.AddDefaulted_GetRef();
+	Agent.StateTree = StateTree;
+
+	// we own ticking from now on
+	StateTree->SetComponentTickEnabled(false);
+}
+
+void UShooterStateTreeScheduler::UnregisterStateTree(UStateTreeComponent* StateTree)
+{
+	const int32 NumRemoved = Agents.RemoveAll([StateTree](const FShooterStateTreeAgent& Agent) { return Agent.StateTree == StateTree; });
+
+	// hand ticking back to the component
+	if (NumRemoved > 0 && IsValid(StateTree))
+	{
+		StateTree->SetComponentTickEnabled(true);
+	}
+}
+
+bool UShooterStateTreeScheduler::SetTickInterval(const UStateTreeComponent* StateTree, float TickInterval)
+{
+	for (FShooterStateTreeAgent& Agent : Agents)
+	{
+		if (Agent.StateTree == StateTree)
+		{
+			Agent.TickInterval = TickInterval;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void UShooterStateTreeScheduler::TickAgent(FShooterStateTreeAgent& Agent)
+{
+	UStateTreeComponent* StateTree = Agent.StateTree.Get();
+
+	StateTree->TickComponent(Agent.TimeSinceTick, LEVELTICK_All, nullptr);
+
+	Agent.TimeSinceTick = 0.0f;
+
+	// the component may re-enable its own tick when it schedules its next update
+	if (StateTree->IsComponentTickEnabled())
+	{
+		StateTree->SetComponentTickEnabled(false);
+	}
+
+	INC_DWORD_STAT(STAT_ShooterStateTreeTicks);
+}
@@ -0,0 +1,70 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterStateTreeScheduler.generated.h"
+
+class UStateTreeComponent;
+
+/**
+ *  Scheduling data tracked for a registered StateTree component
+ */
+struct FShooterStateTreeAgent
+{
+	/** StateTree component being ticked */
+	TWeakObjectPtr<UStateTreeComponent> StateTree;
+
+	/** Minimum time between ticks */
+	float TickInterval = 0.0f;
+
+	/** Time accumulated since the last tick. Passed as the delta time of the next one */
+	float TimeSinceTick = 0.0f;
+};
+
+/**
+ *  Owns StateTree ticking for all shooter AI
+ *  Registered trees are ticked round robin within a per-frame time budget
+ *  Trees deferred for too long are ticked first on the following frames
+ */
+UCLASS()
+class PROJECTOPERATOR_API UShooterStateTreeScheduler : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Registered StateTrees */
+	TArray<FShooterStateTreeAgent> Agents;
+
+	/** Index of the agent the round robin resumes from */
+	int32 Cursor = 0;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Ticks as many due StateTrees as the frame budget allows */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable object */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/** Takes over ticking the given StateTree component */
+	void RegisterStateTree(UStateTreeComponent* StateTree);
+
+	/** Stops ticking the given StateTree component and hands ticking back to it */
+	void UnregisterStateTree(UStateTreeComponent* StateTree);
+
+	/** Sets the minimum time between ticks for a registered StateTree. Returns false if it isn't registered */
+	bool SetTickInterval(const UStateTreeComponent* StateTree, float TickInterval);
+
+protected:
+
+	/** Ticks the agent's StateTree with its accumulated delta time */
+	static void TickAgent(FShooterStateTreeAgent& Agent);
+};
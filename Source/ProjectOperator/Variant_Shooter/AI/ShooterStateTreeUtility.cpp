@@ -9,6 +9,13 @@
 #include "Perception/AIPerceptionComponent.h"
 #include "ShooterAIController.h"
 #include "StateTreeAsyncExecutionContext.h"
+#include "ShooterLineOfSightSubsystem.h"
+#include "ShooterEnvQueryBroker.h"
+#include "ShooterInfluenceMapSubsystem.h"
+#include "ShooterSquadSubsystem.h"
+#include "ShooterPathBroker.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "Engine/World.h"
 
 bool FStateTreeLineOfSightToTargetCondition::TestCondition(FStateTreeExecutionContext& Context) const
 {
@@ -32,41 +39,24 @@ bool FStateTreeLineOfSightToTargetCondition::TestCondition(FStateTreeExecutionCo
 		return !InstanceData.bMustHaveLineOfSight;
 	}
 
-	// get the target's bounding box
-	FVector CenterOfMass, Extent;
-	InstanceData.Target->GetActorBounds(true, CenterOfMass, Extent, false);
+	// read the cached line of sight verdict. Stale verdicts are refreshed asynchronously under the AI trace budget
+	UShooterLineOfSightSubsystem* LineOfSight = UWorld::GetSubsystem<UShooterLineOfSightSubsystem>(InstanceData.Character->GetWorld());
 
-	// divide the vertical extent by the number of line of sight checks we'll do
-	const float ExtentZOffset = Extent.Z * 2.0f / InstanceData.NumberOfVerticalLineOfSightChecks;
-
-	// get the character's camera location as the source for the line checks
-	const FVector Start = InstanceData.Character->GetFirstPersonCameraComponent()->GetComponentLocation();
-
-	// ignore the character and target. We want to ensure there's an unobstructed trace not counting them
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(InstanceData.Character);
-	QueryParams.AddIgnoredActor(InstanceData.Target);
-
-	FHitResult OutHit;
-
-	// run a number of vertically offset line traces to the target location
-	for (int32 i = 0; i < InstanceData.NumberOfVerticalLineOfSightChecks - 1; ++i)
+	if (!LineOfSight)
 	{
-		// calculate the endpoint for the trace
-		const FVector End = CenterOfMass + FVector(0.0f, 0.0f, Extent.Z - ExtentZOffset * i);
+		return !InstanceData.bMustHaveLineOfSight;
+	}
 
-		InstanceData.Character->GetWorld()->LineTraceSingleByChannel(OutHit, Start, End, ECC_Visibility, QueryParams);
+	// pairs that were never traced or have been pruned are traced right away while the frame budget allows
+	const EShooterLineOfSight Verdict = LineOfSight->QueryLineOfSightNow(InstanceData.Character, InstanceData.Target, InstanceData.NumberOfVerticalLineOfSightChecks);
 
-		// is the trace unobstructed?
-		if (!OutHit.bBlockingHit)
-		{
-			// we only need one unobstructed trace, so terminate early
-			return InstanceData.bMustHaveLineOfSight;
-		}
+	// without a verdict yet, fail either way so the transition waits and the current state is kept
+	if (Verdict == EShooterLineOfSight::Unknown)
+	{
+		return false;
 	}
 
-	// no line of sight found
-	return !InstanceData.bMustHaveLineOfSight;
+	return (Verdict == EShooterLineOfSight::Visible) == InstanceData.bMustHaveLineOfSight;
 }
 
 #if WITH_EDITOR
@@ -78,6 +68,30 @@ FText FStateTreeLineOfSightToTargetCondition::GetDescription(const FGuid& ID, FS
 
 ////////////////////////////////////////////////////////////////////
 
+bool FStateTreeThreatAtLocationCondition::TestCondition(FStateTreeExecutionContext& Context) const
+{
+	const FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+	UShooterInfluenceMapSubsystem* InfluenceMap = UWorld::GetSubsystem<UShooterInfluenceMapSubsystem>(InstanceData.Character->GetWorld());
+
+	// without an influence map there's no known threat
+	if (!InfluenceMap)
+	{
+		return true;
+	}
+
+	return InfluenceMap->GetThreat(InstanceData.Character->GetTeamByte(), InstanceData.Location) <= InstanceData.MaxThreat;
+}
+
+#if WITH_EDITOR
+FText FStateTreeThreatAtLocationCondition::GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting /*= EStateTreeNodeFormatting::Text*/) const
+{
+	return FText::FromString("<b>Threat at Location</b>");
+}
+#endif // WITH_EDITOR
+
+////////////////////////////////////////////////////////////////////
+
 EStateTreeRunStatus FStateTreeFaceActorTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
 {
 	// have we transitioned from another state?
@@ -219,76 +233,97 @@ EStateTreeRunStatus FStateTreeSenseEnemiesTask::EnterState(FStateTreeExecutionCo
 		// get the instance data
 		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-		// bind the perception updated delegate on the controller
+		// bind the perception updated delegate on the controller. Stimuli arrive batched once per controller tick
 		InstanceData.Controller->OnShooterPerceptionUpdated.BindLambda(
-			[WeakContext = Context.MakeWeakExecutionContext()](AActor* SensedActor, const FAIStimulus& Stimulus)
+			[WeakContext = Context.MakeWeakExecutionContext()](TConstArrayView<FShooterPerceivedStimulus> Stimuli)
 			{
-				// get the instance data inside the lambda
+				// get the instance data once for the whole batch
 				const FStateTreeStrongExecutionContext StrongContext = WeakContext.MakeStrongExecutionContext();
+				FInstanceDataType* LambdaInstanceData = StrongContext.GetInstanceDataPtr<FInstanceDataType>();
 
-				if (FInstanceDataType* LambdaInstanceData = StrongContext.GetInstanceDataPtr<FInstanceDataType>())
+				if (!LambdaInstanceData)
 				{
-					if (SensedActor->ActorHasTag(LambdaInstanceData->SenseTag))
+					return;
+				}
+
+				const FVector CharacterLocation = LambdaInstanceData->Character->GetActorLocation();
+				const FVector CharacterForward = LambdaInstanceData->Character->GetActorForwardVector();
+				const float MaxDot = FMath::Cos(FMath::DegreesToRadians(LambdaInstanceData->DirectLineOfSightCone));
+
+				// stimuli within our perception cone need a line of sight check
+				TArray<AActor*> LineOfSightActors;
+				TArray<FAIStimulus> LineOfSightStimuli;
+
+				for (const FShooterPerceivedStimulus& Perceived : Stimuli)
+				{
+					AActor* SensedActor = Perceived.Actor.Get();
+
+					// perception already drops non hostile stimuli, but attitudes can change and NPCs can be pooled while stimuli are queued
+					if (!SensedActor || AShooterNPC::IsPooledNPC(SensedActor) || FGenericTeamId::GetAttitude(LambdaInstanceData->Controller, SensedActor) != ETeamAttitude::Hostile)
 					{
-						bool bDirectLOS = false;
+						continue;
+					}
 
-						// calculate the direction of the stimulus
-						const FVector StimulusDir = (Stimulus.StimulusLocation - LambdaInstanceData->Character->GetActorLocation()).GetSafeNormal();
+					// calculate the direction of the stimulus
+					const FVector StimulusDir = (Perceived.Stimulus.StimulusLocation - CharacterLocation).GetSafeNormal();
 
-						// infer the angle from the dot product between the character facing and the stimulus direction
-						const float DirDot = FVector::DotProduct(StimulusDir, LambdaInstanceData->Character->GetActorForwardVector());
-						const float MaxDot = FMath::Cos(FMath::DegreesToRadians(LambdaInstanceData->DirectLineOfSightCone));
+					// infer the angle from the dot product between the character facing and the stimulus direction
+					const float DirDot = FVector::DotProduct(StimulusDir, CharacterForward);
 
-						// is the direction within our perception cone?
-						if (DirDot >= MaxDot)
-						{
-							// run a line trace between the character and the sensed actor
-							FCollisionQueryParams QueryParams;
-							QueryParams.AddIgnoredActor(LambdaInstanceData->Character);
-							QueryParams.AddIgnoredActor(SensedActor);
+					// is the direction within our perception cone?
+					if (DirDot >= MaxDot)
+					{
+						LineOfSightActors.Add(SensedActor);
+						LineOfSightStimuli.Add(Perceived.Stimulus);
 
-							FHitResult OutHit;
+					} else {
 
-							// we have direct line of sight if this trace is unobstructed
-							bDirectLOS = !LambdaInstanceData->Character->GetWorld()->LineTraceSingleByChannel(OutHit, LambdaInstanceData->Character->GetActorLocation(), SensedActor->GetActorLocation(), ECC_Visibility, QueryParams);
+						// outside the cone this can only be a partial sense
+						ProcessPartialSense(*LambdaInstanceData, Perceived.Stimulus);
+					}
+				}
 
-						}
+				if (LineOfSightActors.IsEmpty())
+				{
+					return;
+				}
 
-						// check if we have a direct line of sight to the stimulus
-						if (bDirectLOS)
-						{
-							// set the controller's target
-							LambdaInstanceData->Controller->SetCurrentTarget(SensedActor);
+				UShooterLineOfSightSubsystem* LineOfSight = UWorld::GetSubsystem<UShooterLineOfSightSubsystem>(LambdaInstanceData->Character->GetWorld());
 
-							// set the task output
-							LambdaInstanceData->TargetActor = SensedActor;
+				if (!LineOfSight)
+				{
+					return;
+				}
 
-							// set the flags
-							LambdaInstanceData->bHasTarget = true;
-							LambdaInstanceData->bHasInvestigateLocation = false;
+				TArray<TWeakObjectPtr<AActor>> WeakLineOfSightActors(LineOfSightActors);
 
-						// no direct line of sight to target
-						} else {
+				// check line of sight to every candidate with a single batch of async traces
+				LineOfSight->RequestLineOfSightBatch(LambdaInstanceData->Character, LineOfSightActors, FShooterLineOfSightBatchDelegate::CreateLambda(
+					[WeakContext, WeakLineOfSightActors, LineOfSightStimuli](const TArray<bool>& Results)
+					{
+						// get the instance data again, since the traces may have taken a frame
+						const FStateTreeStrongExecutionContext BatchContext = WeakContext.MakeStrongExecutionContext();
+						FInstanceDataType* BatchInstanceData = BatchContext.GetInstanceDataPtr<FInstanceDataType>();
+
+						if (!BatchInstanceData)
+						{
+							return;
+						}
 
-							// if we already have a target, ignore the partial sense and keep on them
-							if (!IsValid(LambdaInstanceData->TargetActor))
+						for (int32 i = 0; i < Results.Num(); ++i)
+						{
+							// check if we have a direct line of sight to the stimulus
+							if (Results[i] && WeakLineOfSightActors[i].IsValid())
 							{
-								// is this stimulus stronger than the last one we had?
-								if (Stimulus.Strength > LambdaInstanceData->LastStimulusStrength)
-								{
-									// update the stimulus strength
-									LambdaInstanceData->LastStimulusStrength = Stimulus.Strength;
-
-									// set the investigate location
-									LambdaInstanceData->InvestigateLocation = Stimulus.StimulusLocation;
-
-									// set the investigate flag
-									LambdaInstanceData->bHasInvestigateLocation = true;
-								}
+								ProcessDirectSense(*BatchInstanceData, WeakLineOfSightActors[i].Get());
+
+							} else {
+
+								ProcessPartialSense(*BatchInstanceData, LineOfSightStimuli[i]);
 							}
 						}
 					}
-				}
+				));
 			}
 		);
 
@@ -358,9 +393,294 @@ void FStateTreeSenseEnemiesTask::ExitState(FStateTreeExecutionContext& Context,
 	}
 }
 
+void FStateTreeSenseEnemiesTask::ProcessDirectSense(FInstanceDataType& InstanceData, AActor* SensedActor)
+{
+	// set the controller's target
+	InstanceData.Controller->SetCurrentTarget(SensedActor);
+
+	// set the task output
+	InstanceData.TargetActor = SensedActor;
+
+	// set the flags
+	InstanceData.bHasTarget = true;
+	InstanceData.bHasInvestigateLocation = false;
+
+	// let the rest of the squad know where the target is
+	if (UShooterSquadSubsystem* SquadSubsystem = UWorld::GetSubsystem<UShooterSquadSubsystem>(InstanceData.Controller->GetWorld()))
+	{
+		SquadSubsystem->PublishSighting(InstanceData.Controller, SensedActor, SensedActor->GetActorLocation(), 1.0f);
+	}
+}
+
+void FStateTreeSenseEnemiesTask::ProcessPartialSense(FInstanceDataType& InstanceData, const FAIStimulus& Stimulus)
+{
+	// if we already have a target, ignore the partial sense and keep on them
+	if (IsValid(InstanceData.TargetActor))
+	{
+		return;
+	}
+
+	// is this stimulus stronger than the last one we had?
+	if (Stimulus.Strength > InstanceData.LastStimulusStrength)
+	{
+		// update the stimulus strength
+		InstanceData.LastStimulusStrength = Stimulus.Strength;
+
+		// set the investigate location
+		InstanceData.InvestigateLocation = Stimulus.StimulusLocation;
+
+		// set the investigate flag
+		InstanceData.bHasInvestigateLocation = true;
+	}
+}
+
 #if WITH_EDITOR
 FText FStateTreeSenseEnemiesTask::GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting /*= EStateTreeNodeFormatting::Text*/) const
 {
 	return FText::FromString("<b>Sense Enemies</b>");
 }
-#endif // WITH_EDITOR
\ No newline at end of file
+#endif // WITH_EDITOR
+
+////////////////////////////////////////////////////////////////////
+
+EStateTreeRunStatus FStateTreeRunSharedEnvQueryTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	// get the instance data
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+	// request the query from the broker
+	UShooterEnvQueryBroker* Broker = UWorld::GetSubsystem<UShooterEnvQueryBroker>(InstanceData.Controller->GetWorld());
+
+	InstanceData.RequestID = Broker ? Broker->RequestQuery(InstanceData.QueryTemplate, InstanceData.Controller) : INDEX_NONE;
+
+	if (InstanceData.RequestID == INDEX_NONE)
+	{
+		return EStateTreeRunStatus::Failed;
+	}
+
+	// the request may have been answered from a shared result already
+	return Tick(Context, 0.0f);
+}
+
+EStateTreeRunStatus FStateTreeRunSharedEnvQueryTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
+{
+	// get the instance data
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+	UShooterEnvQueryBroker* Broker = UWorld::GetSubsystem<UShooterEnvQueryBroker>(InstanceData.Controller->GetWorld());
+
+	if (!Broker)
+	{
+		return EStateTreeRunStatus::Failed;
+	}
+
+	// poll the broker for our result
+	switch (Broker->GetRequestStatus(InstanceData.RequestID, InstanceData.ResultLocation))
+	{
+	case EShooterEnvQueryStatus::Succeeded:
+		return EStateTreeRunStatus::Succeeded;
+
+	case EShooterEnvQueryStatus::Failed:
+		return EStateTreeRunStatus::Failed;
+
+	default:
+		return EStateTreeRunStatus::Running;
+	}
+}
+
+void FStateTreeRunSharedEnvQueryTask::ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	// get the instance data
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+	// release the request so the broker can drop queries nobody is waiting on
+	if (UShooterEnvQueryBroker* Broker = UWorld::GetSubsystem<UShooterEnvQueryBroker>(InstanceData.Controller->GetWorld()))
+	{
+		Broker->ReleaseRequest(InstanceData.RequestID);
+	}
+
+	InstanceData.RequestID = INDEX_NONE;
+}
+
+#if WITH_EDITOR
+FText FStateTreeRunSharedEnvQueryTask::GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting /*= EStateTreeNodeFormatting::Text*/) const
+{
+	return FText::FromString("<b>Run Shared Env Query</b>");
+}
+#endif // WITH_EDITOR
+
+////////////////////////////////////////////////////////////////////
+
+void FStateTreeSquadKnowledgeEvaluator::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
+{
+	// get the instance data
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+	InstanceData.bHasSquadTarget = false;
+
+	UShooterSquadSubsystem* SquadSubsystem = UWorld::GetSubsystem<UShooterSquadSubsystem>(InstanceData.Controller->GetWorld());
+
+	if (!SquadSubsystem)
+	{
+		return;
+	}
+
+	// keep the squad up to date while we can still see our target
+	AActor* CurrentTarget = InstanceData.Controller->GetCurrentTarget();
+
+	if (IsValid(CurrentTarget))
+	{
+		UShooterLineOfSightSubsystem* LineOfSight = UWorld::GetSubsystem<UShooterLineOfSightSubsystem>(InstanceData.Controller->GetWorld());
+
+		if (LineOfSight && LineOfSight->QueryLineOfSight(InstanceData.Controller->GetPawn(), CurrentTarget))
+		{
+			SquadSubsystem->PublishSighting(InstanceData.Controller, CurrentTarget, CurrentTarget->GetActorLocation(), 1.0f);
+		}
+	}
+
+	// read back the best sighting from anyone in the squad
+	FShooterSquadSighting Sighting;
+	float Confidence = 0.0f;
+
+	if (!SquadSubsystem->GetBestSighting(InstanceData.Controller, Sighting, Confidence))
+	{
+		return;
+	}
+
+	const float Age = static_cast<float>(InstanceData.Controller->GetWorld()->GetTimeSeconds() - Sighting.Time);
+
+	if (Age > InstanceData.MaxSightingAge)
+	{
+		return;
+	}
+
+	InstanceData.SquadTarget = Sighting.Target.Get();
+	InstanceData.SquadTargetLocation = Sighting.Location;
+	InstanceData.SquadTargetAge = Age;
+	InstanceData.Confidence = Confidence;
+	InstanceData.bHasSquadTarget = true;
+}
+
+#if WITH_EDITOR
+FText FStateTreeSquadKnowledgeEvaluator::GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting /*= EStateTreeNodeFormatting::Text*/) const
+{
+	return FText::FromString("<b>Squad Knowledge</b>");
+}
+#endif // WITH_EDITOR
+
+////////////////////////////////////////////////////////////////////
+
+EStateTreeRunStatus FStateTreeSharedMoveToTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	// get the instance data
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+	InstanceData.bMoving = false;
+
+	// request the path from the broker
+	UShooterPathBroker* Broker = UWorld::GetSubsystem<UShooterPathBroker>(InstanceData.Controller->GetWorld());
+
+	InstanceData.RequestID = Broker ? Broker->RequestPath(InstanceData.Controller, InstanceData.Destination, InstanceData.AcceptanceRadius) : INDEX_NONE;
+
+	if (InstanceData.RequestID == INDEX_NONE)
+	{
+		return EStateTreeRunStatus::Failed;
+	}
+
+	// the request may have been answered from a shared path already
+	return Tick(Context, 0.0f);
+}
+
+EStateTreeRunStatus FStateTreeSharedMoveToTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
+{
+	// get the instance data
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+	UPathFollowingComponent* PathFollowing = InstanceData.Controller->GetPathFollowingComponent();
+
+	if (!PathFollowing)
+	{
+		return EStateTreeRunStatus::Failed;
+	}
+
+	// follow the path once we have it
+	if (InstanceData.bMoving)
+	{
+		if (PathFollowing->GetStatus() != EPathFollowingStatus::Idle && PathFollowing->GetCurrentRequestId().IsEquivalent(InstanceData.MoveID))
+		{
+			return EStateTreeRunStatus::Running;
+		}
+
+		return PathFollowing->HasReached(InstanceData.Destination, EPathFollowingReachMode::OverlapAgent, InstanceData.AcceptanceRadius) ? EStateTreeRunStatus::Succeeded : EStateTreeRunStatus::Failed;
+	}
+
+	UShooterPathBroker* Broker = UWorld::GetSubsystem<UShooterPathBroker>(InstanceData.Controller->GetWorld());
+
+	if (!Broker)
+	{
+		return EStateTreeRunStatus::Failed;
+	}
+
+	// poll the broker for our path
+	FNavPathSharedPtr Path;
+
+	switch (Broker->GetRequestStatus(InstanceData.RequestID, Path))
+	{
+	case EShooterPathStatus::Pending:
+		return EStateTreeRunStatus::Running;
+
+	case EShooterPathStatus::Failed:
+		return EStateTreeRunStatus::Failed;
+
+	default:
+		break;
+	}
+
+	// the crowd simulation state can only be switched before the move starts
+	Broker->ApplyCrowdAvoidance(InstanceData.RequestID);
+
+	FAIMoveRequest MoveRequest(InstanceData.Destination);
+	MoveRequest.SetAcceptanceRadius(InstanceData.AcceptanceRadius);
+
+	const FAIRequestID MoveID = InstanceData.Controller->RequestMove(MoveRequest, Path);
+
+	if (!MoveID.IsValid())
+	{
+		return EStateTreeRunStatus::Failed;
+	}
+
+	InstanceData.MoveID = MoveID.GetID();
+	InstanceData.bMoving = true;
+
+	return EStateTreeRunStatus::Running;
+}
+
+void FStateTreeSharedMoveToTask::ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	// get the instance data
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+	// stop our move if it's still running
+	UPathFollowingComponent* PathFollowing = InstanceData.Controller->GetPathFollowingComponent();
+
+	if (InstanceData.bMoving && PathFollowing && PathFollowing->GetStatus() != EPathFollowingStatus::Idle)
+	{
+		PathFollowing->AbortMove(*InstanceData.Controller, FPathFollowingResultFlags::OwnerFinished, FAIRequestID(InstanceData.MoveID));
+	}
+
+	// release the request so the broker can drop queries nobody is waiting on
+	if (UShooterPathBroker* Broker = UWorld::GetSubsystem<UShooterPathBroker>(InstanceData.Controller->GetWorld()))
+	{
+		Broker->ReleaseRequest(InstanceData.RequestID);
+	}
+
+	InstanceData.RequestID = INDEX_NONE;
+	InstanceData.bMoving = false;
+}
+
+#if WITH_EDITOR
+FText FStateTreeSharedMoveToTask::GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting /*= EStateTreeNodeFormatting::Text*/) const
+{
+	return FText::FromString("<b>Shared Move To</b>");
+}
+#endif // WITH_EDITOR
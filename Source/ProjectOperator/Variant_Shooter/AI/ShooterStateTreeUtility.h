@@ -5,12 +5,15 @@
 #include "CoreMinimal.h"
 #include "StateTreeTaskBase.h"
 #include "StateTreeConditionBase.h"
+#include "StateTreeEvaluatorBase.h"
 
 #include "ShooterStateTreeUtility.generated.h"
 
 class AShooterNPC;
 class AAIController;
 class AShooterAIController;
+class UEnvQuery;
+struct FAIStimulus;
 
 /**
  *  Instance data struct for the FStateTreeLineOfSightToTargetCondition condition
@@ -69,6 +72,55 @@ struct FStateTreeLineOfSightToTargetCondition : public FStateTreeConditionCommon
 
 ////////////////////////////////////////////////////////////////////
 
+/**
+ *  Instance data struct for the FStateTreeThreatAtLocationCondition condition
+ */
+USTRUCT()
+struct FStateTreeThreatAtLocationConditionInstanceData
+{
+	GENERATED_BODY()
+
+	/** Character whose team the threat is evaluated for */
+	UPROPERTY(EditAnywhere, Category = "Context")
+	AShooterNPC* Character;
+
+	/** Location to sample the threat at */
+	UPROPERTY(EditAnywhere, Category = "Condition")
+	FVector Location = FVector::ZeroVector;
+
+	/** The condition passes if the threat is at or below this value */
+	UPROPERTY(EditAnywhere, Category = "Condition")
+	float MaxThreat = 0.5f;
+};
+STATETREE_POD_INSTANCEDATA(FStateTreeThreatAtLocationConditionInstanceData);
+
+/**
+ *  StateTree condition to check the influence map threat to the character's team at a location
+ */
+USTRUCT(DisplayName = "Threat at Location", Category="Shooter")
+struct FStateTreeThreatAtLocationCondition : public FStateTreeConditionCommonBase
+{
+	GENERATED_BODY()
+
+	/** Set the instance data type */
+	using FInstanceDataType = FStateTreeThreatAtLocationConditionInstanceData;
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+
+	/** Default constructor */
+	FStateTreeThreatAtLocationCondition() = default;
+
+	/** Tests the StateTree condition */
+	virtual bool TestCondition(FStateTreeExecutionContext& Context) const override;
+
+#if WITH_EDITOR
+	/** Provides the description string */
+	virtual FText GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting = EStateTreeNodeFormatting::Text) const override;
+#endif
+
+};
+
+////////////////////////////////////////////////////////////////////
+
 /**
  *  Instance data struct for the Face Towards Actor StateTree task
  */
@@ -270,8 +322,8 @@ struct FStateTreeSenseEnemiesInstanceData
 	UPROPERTY(EditAnywhere, Category = Output)
 	bool bHasInvestigateLocation = false;
 
-	/** Tag required on sensed actors */
-	UPROPERTY(EditAnywhere, Category = Parameter)
+	/** Deprecated. Sensed actors are filtered by team attitude. Kept so existing StateTree bindings still load and compile */
+	UPROPERTY(EditAnywhere, Category = Parameter, meta = (DeprecatedProperty, DeprecationMessage = "Sensed actors are filtered by team attitude"))
 	FName SenseTag = FName("Player");
 
 	/** Line of sight cone half angle to consider a full sense */
@@ -301,9 +353,195 @@ struct FStateTreeSenseEnemiesTask : public FStateTreeTaskCommonBase
 	/** Runs when the owning state is ended */
 	virtual void ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
 
+protected:
+
+	/** Targets an actor we have direct line of sight to */
+	static void ProcessDirectSense(FInstanceDataType& InstanceData, AActor* SensedActor);
+
+	/** Records a stimulus without direct line of sight as a location to investigate */
+	static void ProcessPartialSense(FInstanceDataType& InstanceData, const FAIStimulus& Stimulus);
+
+public:
+
+#if WITH_EDITOR
+	virtual FText GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting = EStateTreeNodeFormatting::Text) const override;
+#endif // WITH_EDITOR
+};
+
+////////////////////////////////////////////////////////////////////
+
+/**
+ *  Instance data struct for the Run Shared Env Query StateTree task
+ */
+USTRUCT()
+struct FStateTreeRunSharedEnvQueryInstanceData
+{
+	GENERATED_BODY()
+
+	/** Querying AI Controller */
+	UPROPERTY(EditAnywhere, Category = Context)
+	TObjectPtr<AShooterAIController> Controller;
+
+	/** EQS query to run */
+	UPROPERTY(EditAnywhere, Category = Parameter)
+	TObjectPtr<UEnvQuery> QueryTemplate;
+
+	/** Location picked for this NPC */
+	UPROPERTY(EditAnywhere, Category = Output)
+	FVector ResultLocation = FVector::ZeroVector;
+
+	/** Request ID on the EQS broker */
+	UPROPERTY()
+	int32 RequestID = INDEX_NONE;
+};
+
+/**
+ *  StateTree task to run an EQS query through the squad-shared query broker
+ *  Succeeds once a location has been picked for this NPC
+ */
+USTRUCT(meta=(DisplayName="Run Shared Env Query", Category="Shooter"))
+struct FStateTreeRunSharedEnvQueryTask : public FStateTreeTaskCommonBase
+{
+	GENERATED_BODY()
+
+	/* Ensure we're using the correct instance data struct */
+	using FInstanceDataType = FStateTreeRunSharedEnvQueryInstanceData;
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+
+	/** Runs when the owning state is entered */
+	virtual EStateTreeRunStatus EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+
+	/** Runs while the owning state is active */
+	virtual EStateTreeRunStatus Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const override;
+
+	/** Runs when the owning state is ended */
+	virtual void ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+
+#if WITH_EDITOR
+	virtual FText GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting = EStateTreeNodeFormatting::Text) const override;
+#endif // WITH_EDITOR
+};
+
+////////////////////////////////////////////////////////////////////
+
+/**
+ *  Instance data struct for the Squad Knowledge StateTree evaluator
+ */
+USTRUCT()
+struct FStateTreeSquadKnowledgeInstanceData
+{
+	GENERATED_BODY()
+
+	/** AI Controller reading the squad knowledge */
+	UPROPERTY(EditAnywhere, Category = Context)
+	TObjectPtr<AShooterAIController> Controller;
+
+	/** Sightings older than this are ignored */
+	UPROPERTY(EditAnywhere, Category = Parameter)
+	float MaxSightingAge = 5.0f;
+
+	/** Target the squad is most confident about */
+	UPROPERTY(EditAnywhere, Category = Output)
+	TObjectPtr<AActor> SquadTarget;
+
+	/** Last location the squad saw the target at */
+	UPROPERTY(EditAnywhere, Category = Output)
+	FVector SquadTargetLocation = FVector::ZeroVector;
+
+	/** Time since the squad last saw the target */
+	UPROPERTY(EditAnywhere, Category = Output)
+	float SquadTargetAge = 0.0f;
+
+	/** Confidence in the sighting, from 0 to 1 */
+	UPROPERTY(EditAnywhere, Category = Output)
+	float Confidence = 0.0f;
+
+	/** True if the squad currently knows about a target */
+	UPROPERTY(EditAnywhere, Category = Output)
+	bool bHasSquadTarget = false;
+};
+
+/**
+ *  StateTree evaluator that shares the NPC's confirmed sightings with its squad
+ *  and exposes the squad's best sighting to the rest of the tree
+ */
+USTRUCT(meta=(DisplayName="Squad Knowledge", Category="Shooter"))
+struct FStateTreeSquadKnowledgeEvaluator : public FStateTreeEvaluatorCommonBase
+{
+	GENERATED_BODY()
+
+	/* Ensure we're using the correct instance data struct */
+	using FInstanceDataType = FStateTreeSquadKnowledgeInstanceData;
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+
+	/** Publishes our own sighting and reads the squad's best one */
+	virtual void Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const override;
+
+#if WITH_EDITOR
+	virtual FText GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting = EStateTreeNodeFormatting::Text) const override;
+#endif // WITH_EDITOR
+};
+
+////////////////////////////////////////////////////////////////////
+
+/**
+ *  Instance data struct for the Shared Move To StateTree task
+ */
+USTRUCT()
+struct FStateTreeSharedMoveToInstanceData
+{
+	GENERATED_BODY()
+
+	/** Moving AI Controller */
+	UPROPERTY(EditAnywhere, Category = Context)
+	TObjectPtr<AShooterAIController> Controller;
+
+	/** Location to move to */
+	UPROPERTY(EditAnywhere, Category = Input)
+	FVector Destination = FVector::ZeroVector;
+
+	/** Distance from the destination the move is considered complete at */
+	UPROPERTY(EditAnywhere, Category = Parameter)
+	float AcceptanceRadius = 50.0f;
+
+	/** Request ID on the path broker */
+	UPROPERTY()
+	int32 RequestID = INDEX_NONE;
+
+	/** Path following request ID, once moving */
+	UPROPERTY()
+	uint32 MoveID = 0;
+
+	/** True once the brokered path has been handed to path following */
+	UPROPERTY()
+	bool bMoving = false;
+};
+
+/**
+ *  StateTree task to move to a location along a path from the shared path broker
+ *  Succeeds once the destination is reached
+ */
+USTRUCT(meta=(DisplayName="Shared Move To", Category="Shooter"))
+struct FStateTreeSharedMoveToTask : public FStateTreeTaskCommonBase
+{
+	GENERATED_BODY()
+
+	/* Ensure we're using the correct instance data struct */
+	using FInstanceDataType = FStateTreeSharedMoveToInstanceData;
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+
+	/** Runs when the owning state is entered */
+	virtual EStateTreeRunStatus EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+
+	/** Runs while the owning state is active */
+	virtual EStateTreeRunStatus Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const override;
+
+	/** Runs when the owning state is ended */
+	virtual void ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+
 #if WITH_EDITOR
 	virtual FText GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting = EStateTreeNodeFormatting::Text) const override;
 #endif // WITH_EDITOR
 };
 
-////////////////////////////////////////////////////////////////////
\ No newline at end of file
+////////////////////////////////////////////////////////////////////
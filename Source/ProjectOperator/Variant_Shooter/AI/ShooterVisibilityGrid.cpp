@@ -0,0 +1,87 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterVisibilityGrid.h"
+
+void UShooterVisibilityGrid::Initialize(const FVector& InOrigin, float InCellSize, const FIntVector& InDimensions)
+{
+	Origin = InOrigin;
+	CellSize = InCellSize;
+	Dimensions = InDimensions;
+
+	// one bit per unordered pair, diagonal included
+	const int64 NumCells = GetNumCells();
+	const int64 NumPairs = NumCells * (NumCells + 1) / 2;
+
+	VisibilityBits.Reset();
+	VisibilityBits.SetNumZeroed(static_cast<int32>((NumPairs + 31) / 32));
+}
+
+void UShooterVisibilityGrid::SetCellsVisible(int32 CellA, int32 CellB)
+{
+	const int64 PairIndex = GetPairIndex(CellA, CellB);
+
+	VisibilityBits[static_cast<int32>(PairIndex >> 5)] |= 1u << (PairIndex & 31);
+}
+
+bool UShooterVisibilityGrid::CanCellsSee(int32 CellA, int32 CellB) const
+{
+	const int64 PairIndex = GetPairIndex(CellA, CellB);
+
+	return (VisibilityBits[static_cast<int32>(PairIndex >> 5)] & (1u << (PairIndex & 31))) != 0;
+}
+
+int32 UShooterVisibilityGrid::GetCellIndex(const FVector& Location) const
+{
+	const FVector Local = (Location - Origin) / CellSize;
+
+	const int32 X = FMath::FloorToInt32(Local.X);
+	const int32 Y = FMath::FloorToInt32(Local.Y);
+	const int32 Z = FMath::FloorToInt32(Local.Z);
+
+	if (X < 0 || Y < 0 || Z < 0 || X >= Dimensions.X || Y >= Dimensions.Y || Z >= Dimensions.Z)
+	{
+		return INDEX_NONE;
+	}
+
+	return X + Dimensions.X * (Y + Dimensions.Y * Z);
+}
+
+FVector UShooterVisibilityGrid::GetCellCenter(int32 CellIndex) const
+{
+	const int32 X = CellIndex % Dimensions.X;
+	const int32 Y = (CellIndex / Dimensions.X) % Dimensions.Y;
+	const int32 Z = CellIndex / (Dimensions.X * Dimensions.Y);
+
+	return Origin + (FVector(X, Y, Z) + 0.5f) * CellSize;
+}
+
+bool UShooterVisibilityGrid::MayBeVisible(const FVector& From, const FVector& To) const
+{
+	// an empty or unbaked grid knows nothing
+	if (VisibilityBits.IsEmpty())
+	{
+		return true;
+	}
+
+	const int32 CellA = GetCellIndex(From);
+	const int32 CellB = GetCellIndex(To);
+
+	if (CellA == INDEX_NONE || CellB == INDEX_NONE)
+	{
+		return true;
+	}
+
+	return CanCellsSee(CellA, CellB);
+}
+
+int64 UShooterVisibilityGrid::GetPairIndex(int32 CellA, int32 CellB) const
+{
+	// the matrix is symmetric, so only the upper triangle is stored
+	const int64 Row = FMath::Min(CellA, CellB);
+	const int64 Column = FMath::Max(CellA, CellB);
+	const int64 NumCells = GetNumCells();
+
+	// rows shrink by one entry each, so skip the full rows before ours
+	return Row * NumCells - Row * (Row - 1) / 2 + (Column - Row);
+}
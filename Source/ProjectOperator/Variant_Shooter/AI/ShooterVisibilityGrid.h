@@ -0,0 +1,71 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "ShooterVisibilityGrid.generated.h"
+
+/**
+ *  Baked cell to cell potential visibility table for a level
+ *  The level bounds are split into uniform cells, and one bit per unordered cell pair
+ *  records whether any sample point in one cell could see any sample point in the other
+ *  Pairs with a clear bit can never see each other, so line of sight checks between them can be skipped
+ */
+UCLASS(BlueprintType)
+class PROJECTOPERATOR_API UShooterVisibilityGrid : public UDataAsset
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** World location of the minimum corner of the grid */
+	UPROPERTY(VisibleAnywhere, Category = "Visibility Grid")
+	FVector Origin = FVector::ZeroVector;
+
+	/** Size of each cubic cell */
+	UPROPERTY(VisibleAnywhere, Category = "Visibility Grid", meta = (Units = "cm"))
+	float CellSize = 400.0f;
+
+	/** Number of cells along each axis */
+	UPROPERTY(VisibleAnywhere, Category = "Visibility Grid")
+	FIntVector Dimensions = FIntVector::ZeroValue;
+
+	/** Packed upper triangle of the cell pair visibility matrix, diagonal included */
+	UPROPERTY()
+	TArray<uint32> VisibilityBits;
+
+public:
+
+	/** Sizes the grid and clears every visibility bit */
+	void Initialize(const FVector& InOrigin, float InCellSize, const FIntVector& InDimensions);
+
+	/** Marks a pair of cells as able to see each other */
+	void SetCellsVisible(int32 CellA, int32 CellB);
+
+	/** Returns true if the pair of cells may be able to see each other */
+	bool CanCellsSee(int32 CellA, int32 CellB) const;
+
+	/** Returns the index of the cell containing the location, or INDEX_NONE if it's outside the grid */
+	int32 GetCellIndex(const FVector& Location) const;
+
+	/** Returns the center of the given cell */
+	FVector GetCellCenter(int32 CellIndex) const;
+
+	/** Returns the total number of cells */
+	int32 GetNumCells() const { return Dimensions.X * Dimensions.Y * Dimensions.Z; }
+
+	/** Returns the size of each cell */
+	float GetCellSize() const { return CellSize; }
+
+	/**
+	 *  Returns false only if the two locations can never see each other
+	 *  Locations outside the grid are always considered potentially visible
+	 */
+	bool MayBeVisible(const FVector& From, const FVector& To) const;
+
+protected:
+
+	/** Returns the bit index for an unordered pair of cells */
+	int64 GetPairIndex(int32 CellA, int32 CellB) const;
+};
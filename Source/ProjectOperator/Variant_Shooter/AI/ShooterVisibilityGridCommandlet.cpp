@@ -0,0 +1,229 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterVisibilityGridCommandlet.h"
+#include "Variant_Shooter/AI/ShooterVisibilityGrid.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Components/PrimitiveComponent.h"
+#include "Async/ParallelFor.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+#include "ProjectOperator.h"
+
+int32 UShooterVisibilityGridCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	FString MapName = TEXT("/Game/Maps/FPTest");
+	FParse::Value(*Params, TEXT("Map="), MapName);
+
+	FString OutputName = FString::Printf(TEXT("/Game/AI/VIS_%s"), *FPackageName::GetShortName(MapName));
+	FParse::Value(*Params, TEXT("Output="), OutputName);
+
+	float CellSize = 400.0f;
+	FParse::Value(*Params, TEXT("CellSize="), CellSize);
+
+	int32 MaxCells = 8192;
+	FParse::Value(*Params, TEXT("MaxCells="), MaxCells);
+
+	// load the level
+	UPackage* MapPackage = LoadPackage(nullptr, *MapName, LOAD_None);
+	UWorld* World = MapPackage ? UWorld::FindWorldInPackage(MapPackage) : nullptr;
+
+	if (!World)
+	{
+		UE_LOG(LogProjectOperator, Error, TEXT("Visibility grid: couldn't load map %s"), *MapName);
+		return 1;
+	}
+
+	// bring up collision so we can trace against the level
+	World->WorldType = EWorldType::Editor;
+	World->AddToRoot();
+
+	if (!World->bIsWorldInitialized)
+	{
+		World->InitWorld(UWorld::InitializationValues()
+			.ShouldSimulatePhysics(false)
+			.EnableTraceCollision(true)
+			.CreatePhysicsScene(true)
+			.CreateNavigation(false)
+			.CreateAISystem(false)
+			.AllowAudioPlayback(false));
+	}
+
+	World->UpdateWorldComponents(true, false);
+
+	// size the grid to the level's collision
+	const FBox Bounds = GetCollisionBounds(World);
+
+	if (!Bounds.IsValid || CellSize <= 0.0f)
+	{
+		UE_LOG(LogProjectOperator, Error, TEXT("Visibility grid: %s has no collision to bake"), *MapName);
+		World->RemoveFromRoot();
+		return 1;
+	}
+
+	const FVector Size = Bounds.GetSize();
+	const FIntVector Dimensions(
+		FMath::Max(1, FMath::CeilToInt32(Size.X / CellSize)),
+		FMath::Max(1, FMath::CeilToInt32(Size.Y / CellSize)),
+		FMath::Max(1, FMath::CeilToInt32(Size.Z / CellSize)));
+
+	const int64 NumCells = static_cast<int64>(Dimensions.X) * Dimensions.Y * Dimensions.Z;
+
+	if (NumCells > MaxCells)
+	{
+		UE_LOG(LogProjectOperator, Error, TEXT("Visibility grid: %lld cells exceeds MaxCells %d. Use a larger CellSize"), NumCells, MaxCells);
+		World->RemoveFromRoot();
+		return 1;
+	}
+
+	// create the grid asset
+	UPackage* OutputPackage = CreatePackage(*OutputName);
+	UShooterVisibilityGrid* Grid = NewObject<UShooterVisibilityGrid>(OutputPackage, *FPackageName::GetShortName(OutputName), RF_Public | RF_Standalone);
+	Grid->Initialize(Bounds.Min, CellSize, Dimensions);
+
+	UE_LOG(LogProjectOperator, Display, TEXT("Visibility grid: baking %s, %dx%dx%d cells"), *MapName, Dimensions.X, Dimensions.Y, Dimensions.Z);
+
+	BakeVisibility(World, Grid);
+
+	// save the asset
+	FSavePackageArgs SaveArgs;
+	SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+
+	const FString Filename = FPackageName::LongPackageNameToFilename(OutputName, FPackageName::GetAssetPackageExtension());
+	const bool bSaved = UPackage::SavePackage(OutputPackage, Grid, *Filename, SaveArgs);
+
+	World->RemoveFromRoot();
+
+	if (!bSaved)
+	{
+		UE_LOG(LogProjectOperator, Error, TEXT("Visibility grid: couldn't save %s"), *Filename);
+		return 1;
+	}
+
+	UE_LOG(LogProjectOperator, Display, TEXT("Visibility grid: saved %s"), *Filename);
+	return 0;
+#else
+	return 1;
+#endif
+}
+
+FBox UShooterVisibilityGridCommandlet::GetCollisionBounds(UWorld* World)
+{
+	FBox Bounds(ForceInit);
+
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		TInlineComponentArray<UPrimitiveComponent*> Primitives(*It);
+
+		for (const UPrimitiveComponent* Primitive : Primitives)
+		{
+			if (Primitive->IsCollisionEnabled())
+			{
+				Bounds += Primitive->Bounds.GetBox();
+			}
+		}
+	}
+
+	return Bounds;
+}
+
+void UShooterVisibilityGridCommandlet::BakeVisibility(UWorld* World, UShooterVisibilityGrid* Grid)
+{
+	const int32 NumCells = Grid->GetNumCells();
+
+	// sample each cell at its center, near its eight corners and near its horizontal corners at mid height,
+	// so the bake covers the full cell height and stays conservative
+	const float Inset = Grid->GetCellSize() * 0.45f;
+
+	const FVector SampleOffsets[] = {
+		FVector::ZeroVector,
+		FVector(Inset, Inset, Inset),
+		FVector(-Inset, Inset, Inset),
+		FVector(Inset, -Inset, Inset),
+		FVector(-Inset, -Inset, Inset),
+		FVector(Inset, Inset, -Inset),
+		FVector(-Inset, Inset, -Inset),
+		FVector(Inset, -Inset, -Inset),
+		FVector(-Inset, -Inset, -Inset),
+		FVector(Inset, Inset, 0.0f),
+		FVector(-Inset, Inset, 0.0f),
+		FVector(Inset, -Inset, 0.0f),
+		FVector(-Inset, -Inset, 0.0f)
+	};
+
+	constexpr int32 NumSamples = UE_ARRAY_COUNT(SampleOffsets);
+
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ShooterVisibilityGridBake), false);
+
+	// find the samples that start inside geometry up front. Traces from them can't be trusted, so they count as visible
+	TArray<bool> SampleInsideGeometry;
+	SampleInsideGeometry.SetNumZeroed(NumCells * NumSamples);
+
+	ParallelFor(NumCells, [&](int32 Cell)
+	{
+		const FVector Center = Grid->GetCellCenter(Cell);
+
+		for (int32 i = 0; i < NumSamples; ++i)
+		{
+			SampleInsideGeometry[Cell * NumSamples + i] = World->OverlapAnyTestByChannel(Center + SampleOffsets[i], FQuat::Identity, ECC_Visibility, FCollisionShape::MakeSphere(1.0f), QueryParams);
+		}
+	});
+
+	// visible pairs for each row, filled in parallel and written to the grid afterwards
+	TArray<TArray<int32>> VisibleColumns;
+	VisibleColumns.SetNum(NumCells);
+
+	ParallelFor(NumCells, [&](int32 CellA)
+	{
+		const FVector CenterA = Grid->GetCellCenter(CellA);
+
+		for (int32 CellB = CellA; CellB < NumCells; ++CellB)
+		{
+			const FVector CenterB = Grid->GetCellCenter(CellB);
+
+			// any clear sample pair makes the cells potentially visible
+			bool bVisible = CellA == CellB;
+
+			for (int32 i = 0; i < NumSamples && !bVisible; ++i)
+			{
+				for (int32 j = 0; j < NumSamples && !bVisible; ++j)
+				{
+					if (SampleInsideGeometry[CellA * NumSamples + i] || SampleInsideGeometry[CellB * NumSamples + j])
+					{
+						bVisible = true;
+						continue;
+					}
+
+					FHitResult Hit;
+
+					// a trace that starts penetrating geometry is treated the same as a sample inside it
+					bVisible = !World->LineTraceSingleByChannel(Hit, CenterA + SampleOffsets[i], CenterB + SampleOffsets[j], ECC_Visibility, QueryParams) || Hit.bStartPenetrating;
+				}
+			}
+
+			if (bVisible)
+			{
+				VisibleColumns[CellA].Add(CellB);
+			}
+		}
+	});
+
+	int64 NumVisible = 0;
+
+	for (int32 CellA = 0; CellA < NumCells; ++CellA)
+	{
+		for (int32 CellB : VisibleColumns[CellA])
+		{
+			Grid->SetCellsVisible(CellA, CellB);
+		}
+
+		NumVisible += VisibleColumns[CellA].Num();
+	}
+
+	const int64 NumPairs = static_cast<int64>(NumCells) * (NumCells + 1) / 2;
+
+	UE_LOG(LogProjectOperator, Display, TEXT("Visibility grid: %lld of %lld cell pairs potentially visible"), NumVisible, NumPairs);
+}
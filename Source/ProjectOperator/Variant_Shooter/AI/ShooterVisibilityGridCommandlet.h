@@ -0,0 +1,33 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ShooterVisibilityGridCommandlet.generated.h"
+
+class UWorld;
+class UShooterVisibilityGrid;
+
+/**
+ *  Bakes a UShooterVisibilityGrid for a level
+ *  Usage: -run=ShooterVisibilityGrid -Map=/Game/Maps/FPTest [-Output=/Game/AI/VIS_FPTest] [-CellSize=400] [-MaxCells=8192]
+ */
+UCLASS()
+class PROJECTOPERATOR_API UShooterVisibilityGridCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Commandlet entry point */
+	virtual int32 Main(const FString& Params) override;
+
+protected:
+
+	/** Returns the bounds of every colliding actor in the world */
+	static FBox GetCollisionBounds(UWorld* World);
+
+	/** Traces every cell pair and sets the visibility bits on the grid */
+	static void BakeVisibility(UWorld* World, UShooterVisibilityGrid* Grid);
+};
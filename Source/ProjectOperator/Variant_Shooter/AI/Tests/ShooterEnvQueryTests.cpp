@@ -0,0 +1,332 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/EnvQueryTest_ShooterDistance.h"
+#include "Variant_Shooter/AI/EnvQueryTest_ShooterFacing.h"
+#include "Variant_Shooter/AI/EnvQueryTest_ShooterVisibility.h"
+#include "Settings/ShooterAISettings.h"
+#include "EnvironmentQuery/EnvQuery.h"
+#include "EnvironmentQuery/EnvQueryManager.h"
+#include "EnvironmentQuery/EnvQueryOption.h"
+#include "EnvironmentQuery/Contexts/EnvQueryContext_Querier.h"
+#include "EnvironmentQuery/Generators/EnvQueryGenerator_SimpleGrid.h"
+#include "EnvironmentQuery/Tests/EnvQueryTest_Distance.h"
+#include "EnvironmentQuery/Tests/EnvQueryTest_Dot.h"
+#include "EnvironmentQuery/Tests/EnvQueryTest_Trace.h"
+#include "Components/BoxComponent.h"
+#include "Components/SceneComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Misc/AutomationTest.h"
+#include "ProjectOperator.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ShooterEnvQueryTests
+{
+	/** Half size of the generated grid and spacing between its items, in cm. This gives about 10k items */
+	constexpr float GridHalfSize = 5000.0f;
+	constexpr float GridSpacing = 100.0f;
+
+	/** Number of items in the generated grid */
+	constexpr int32 NumGridItems = FMath::Square(int32(GridHalfSize * 2.0f / GridSpacing) + 1);
+
+	/** Number of timed runs for each test */
+	constexpr int32 NumRuns = 20;
+
+	/** Max difference allowed between the normalized stock and batched scores */
+	constexpr float ScoreTolerance = 1.0e-3f;
+
+	/** Querier placement. Off the origin and turned, so location and facing both matter */
+	const FVector QuerierLocation(123.0f, -456.0f, 78.0f);
+	const FRotator QuerierRotation(0.0f, 37.0f, 0.0f);
+
+	/** Brings up a bare game world with an AI system to run the queries in */
+	UWorld* CreateTestWorld()
+	{
+		UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.SetCurrentWorld(World);
+
+		World->InitializeActorsForPlay(FURL());
+		World->BeginPlay();
+
+		return World;
+	}
+
+	/** Tears down a world from CreateTestWorld */
+	void DestroyTestWorld(UWorld* World)
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	}
+
+	/** Spawns the querier. A bare actor has no location or rotation without a root component, so give it one */
+	AActor* SpawnQuerier(UWorld* World)
+	{
+		AActor* Querier = World->SpawnActor<AActor>();
+
+		USceneComponent* Root = NewObject<USceneComponent>(Querier, TEXT("Root"));
+		Querier->SetRootComponent(Root);
+		Root->RegisterComponent();
+
+		Querier->SetActorLocationAndRotation(QuerierLocation, QuerierRotation);
+
+		return Querier;
+	}
+
+	/** Spawns a wall blocking visibility in front of the querier, so the trace tests have something to hit */
+	void SpawnWall(UWorld* World)
+	{
+		AActor* Wall = World->SpawnActor<AActor>();
+
+		UBoxComponent* Box = NewObject<UBoxComponent>(Wall, TEXT("Box"));
+		Box->SetBoxExtent(FVector(100.0f, 1500.0f, 1000.0f));
+		Box->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+		Wall->SetRootComponent(Box);
+		Box->RegisterComponent();
+
+		Wall->SetActorLocationAndRotation(QuerierLocation + QuerierRotation.RotateVector(FVector(1000.0f, 0.0f, 0.0f)), QuerierRotation);
+	}
+
+	/** Returns a pointer to a test property by name, so protected settings on stock and batched tests can be set to match */
+	template<typename ValueType>
+	ValueType* FindTestValue(UEnvQueryTest* Test, FName PropertyName)
+	{
+		const FProperty* Property = Test->GetClass()->FindPropertyByName(PropertyName);
+
+		return Property && Property->GetElementSize() == sizeof(ValueType) ? Property->ContainerPtrToValuePtr<ValueType>(Test) : nullptr;
+	}
+
+	/** Builds a query scoring an unprojected grid around the querier with a default test of the given class */
+	UEnvQuery* MakeGridQuery(TSubclassOf<UEnvQueryTest> TestClass)
+	{
+		UEnvQuery* Query = NewObject<UEnvQuery>(GetTransientPackage());
+
+		UEnvQueryGenerator_SimpleGrid* Generator = NewObject<UEnvQueryGenerator_SimpleGrid>(Query);
+		Generator->GridSize.DefaultValue = GridHalfSize;
+		Generator->SpaceBetween.DefaultValue = GridSpacing;
+		Generator->ProjectionData.TraceMode = EEnvQueryTrace::None;
+
+		UEnvQueryOption* Option = NewObject<UEnvQueryOption>(Query);
+		Option->Generator = Generator;
+
+		UEnvQueryTest* Test = NewObject<UEnvQueryTest>(Option, TestClass);
+		Test->TestOrder = 0;
+		Option->Tests.Add(Test);
+
+		Query->GetOptionsMutable().Add(Option);
+
+		return Query;
+	}
+
+	/** Returns the single test of a query from MakeGridQuery */
+	UEnvQueryTest* GetGridTest(UEnvQuery* Query)
+	{
+		return Query->GetOptions()[0]->Tests[0];
+	}
+
+	/** Runs the query NumRuns times, returning the last result and the average run time in milliseconds */
+	TSharedPtr<FEnvQueryResult> RunTimed(UEnvQueryManager* QueryManager, UEnvQuery* Query, AActor* Querier, double& OutAverageMs)
+	{
+		TSharedPtr<FEnvQueryResult> Result;
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		for (int32 Run = 0; Run < NumRuns; ++Run)
+		{
+			Result = QueryManager->RunInstantQuery(FEnvQueryRequest(Query, Querier), EEnvQueryRunMode::AllMatching);
+		}
+
+		OutAverageMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumRuns;
+
+		return Result;
+	}
+
+	/** Returns the number of batched items missing from the stock result or scored differently. Items come back sorted by score, so they're matched up by location */
+	int32 CountMismatches(const FEnvQueryResult& StockResult, const FEnvQueryResult& BatchedResult)
+	{
+		TMap<FVector, float> StockScores;
+
+		for (int32 i = 0; i < StockResult.Items.Num(); ++i)
+		{
+			StockScores.Add(StockResult.GetItemAsLocation(i), StockResult.GetItemScore(i));
+		}
+
+		int32 NumMismatches = 0;
+
+		for (int32 i = 0; i < BatchedResult.Items.Num(); ++i)
+		{
+			const float* StockScore = StockScores.Find(BatchedResult.GetItemAsLocation(i));
+
+			if (!StockScore || !FMath::IsNearlyEqual(*StockScore, BatchedResult.GetItemScore(i), ScoreTolerance))
+			{
+				++NumMismatches;
+			}
+		}
+
+		return NumMismatches;
+	}
+}
+
+/**
+ *  Compares a stock EQS test against its batched replacement over the same grid
+ *  Both queries are timed, and the batched one has to pass the same items with the same normalized scores
+ */
+class FShooterEnvQueryComparisonTest : public FAutomationTestBase
+{
+public:
+
+	FShooterEnvQueryComparisonTest(const FString& InName, const bool bInComplexTask)
+		: FAutomationTestBase(InName, bInComplexTask)
+	{
+	}
+
+protected:
+
+	/** Runs both queries and checks the results match */
+	void Compare(UEnvQueryManager* QueryManager, AActor* Querier, UEnvQuery* StockQuery, UEnvQuery* BatchedQuery, const TCHAR* TestName)
+	{
+		using namespace ShooterEnvQueryTests;
+
+		double StockMs = 0.0;
+		double BatchedMs = 0.0;
+
+		const TSharedPtr<FEnvQueryResult> StockResult = RunTimed(QueryManager, StockQuery, Querier, StockMs);
+		const TSharedPtr<FEnvQueryResult> BatchedResult = RunTimed(QueryManager, BatchedQuery, Querier, BatchedMs);
+
+		if (!TestTrue(TEXT("Queries succeeded"), StockResult.IsValid() && BatchedResult.IsValid() && StockResult->IsSuccessful() && BatchedResult->IsSuccessful()))
+		{
+			return;
+		}
+
+		TestEqual(TEXT("Item count"), BatchedResult->Items.Num(), StockResult->Items.Num());
+		TestEqual(TEXT("Mismatched scores"), CountMismatches(*StockResult, *BatchedResult), 0);
+
+		AddInfo(FString::Printf(TEXT("%d items: stock %s %.3fms, batched %s %.3fms (%.2fx)"), StockResult->Items.Num(), TestName, StockMs, TestName, BatchedMs, BatchedMs > 0.0 ? StockMs / BatchedMs : 0.0));
+	}
+};
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FShooterEnvQueryBatchedDistanceTest, FShooterEnvQueryComparisonTest, "ProjectOperator.AI.EQS.BatchedDistance", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FShooterEnvQueryBatchedDistanceTest::RunTest(const FString& Parameters)
+{
+	using namespace ShooterEnvQueryTests;
+
+	UWorld* World = CreateTestWorld();
+	UEnvQueryManager* QueryManager = UEnvQueryManager::GetCurrent(World);
+
+	if (TestNotNull(TEXT("EQS manager"), QueryManager))
+	{
+		// both tests default to the 3D distance to the querier
+		Compare(QueryManager, SpawnQuerier(World), MakeGridQuery(UEnvQueryTest_Distance::StaticClass()), MakeGridQuery(UEnvQueryTest_ShooterDistance::StaticClass()), TEXT("distance"));
+	}
+
+	DestroyTestWorld(World);
+
+	return true;
+}
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FShooterEnvQueryBatchedFacingTest, FShooterEnvQueryComparisonTest, "ProjectOperator.AI.EQS.BatchedFacing", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FShooterEnvQueryBatchedFacingTest::RunTest(const FString& Parameters)
+{
+	using namespace ShooterEnvQueryTests;
+
+	UWorld* World = CreateTestWorld();
+	UEnvQueryManager* QueryManager = UEnvQueryManager::GetCurrent(World);
+
+	if (TestNotNull(TEXT("EQS manager"), QueryManager))
+	{
+		// the stock dot test defaults to the 3D dot between the querier's facing and the direction from the querier to the item
+		UEnvQuery* StockQuery = MakeGridQuery(UEnvQueryTest_Dot::StaticClass());
+		UEnvQuery* BatchedQuery = MakeGridQuery(UEnvQueryTest_ShooterFacing::StaticClass());
+
+		TSubclassOf<UEnvQueryContext>* FacingFrom = FindTestValue<TSubclassOf<UEnvQueryContext>>(GetGridTest(BatchedQuery), TEXT("FacingFrom"));
+		bool* bWorkIn2D = FindTestValue<bool>(GetGridTest(BatchedQuery), TEXT("bWorkIn2D"));
+
+		if (TestNotNull(TEXT("FacingFrom"), FacingFrom) && TestNotNull(TEXT("bWorkIn2D"), bWorkIn2D))
+		{
+			*FacingFrom = UEnvQueryContext_Querier::StaticClass();
+			*bWorkIn2D = false;
+
+			Compare(QueryManager, SpawnQuerier(World), StockQuery, BatchedQuery, TEXT("dot"));
+		}
+	}
+
+	DestroyTestWorld(World);
+
+	return true;
+}
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FShooterEnvQueryBatchedVisibilityTest, FShooterEnvQueryComparisonTest, "ProjectOperator.AI.EQS.BatchedVisibility", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FShooterEnvQueryBatchedVisibilityTest::RunTest(const FString& Parameters)
+{
+	using namespace ShooterEnvQueryTests;
+
+	UWorld* World = CreateTestWorld();
+	UEnvQueryManager* QueryManager = UEnvQueryManager::GetCurrent(World);
+
+	if (TestNotNull(TEXT("EQS manager"), QueryManager))
+	{
+		AActor* Querier = SpawnQuerier(World);
+		SpawnWall(World);
+
+		// the stock trace test defaults to a geometry line trace from the querier, passing items that are hit
+		UEnvQuery* StockQuery = MakeGridQuery(UEnvQueryTest_Trace::StaticClass());
+		UEnvQuery* BatchedQuery = MakeGridQuery(UEnvQueryTest_ShooterVisibility::StaticClass());
+
+		UEnvQueryTest* StockTest = GetGridTest(StockQuery);
+		UEnvQueryTest* BatchedTest = GetGridTest(BatchedQuery);
+
+		FAIDataProviderFloatValue* StockContextHeightOffset = FindTestValue<FAIDataProviderFloatValue>(StockTest, TEXT("ContextHeightOffset"));
+		FAIDataProviderFloatValue* StockItemHeightOffset = FindTestValue<FAIDataProviderFloatValue>(StockTest, TEXT("ItemHeightOffset"));
+		TSubclassOf<UEnvQueryContext>* TraceFrom = FindTestValue<TSubclassOf<UEnvQueryContext>>(BatchedTest, TEXT("TraceFrom"));
+		const float* ContextHeightOffset = FindTestValue<float>(BatchedTest, TEXT("ContextHeightOffset"));
+		const float* ItemHeightOffset = FindTestValue<float>(BatchedTest, TEXT("ItemHeightOffset"));
+
+		if (TestNotNull(TEXT("Stock height offsets"), StockContextHeightOffset) && TestNotNull(TEXT("Stock height offsets"), StockItemHeightOffset)
+			&& TestNotNull(TEXT("TraceFrom"), TraceFrom) && TestNotNull(TEXT("Height offsets"), ContextHeightOffset) && TestNotNull(TEXT("Height offsets"), ItemHeightOffset))
+		{
+			StockTest->BoolValue.DefaultValue = false;
+			StockContextHeightOffset->DefaultValue = *ContextHeightOffset;
+			StockItemHeightOffset->DefaultValue = *ItemHeightOffset;
+
+			*TraceFrom = UEnvQueryContext_Querier::StaticClass();
+
+			// trace every item for the comparison, then check the per run cap
+			UShooterAISettings* Settings = GetMutableDefault<UShooterAISettings>();
+			const int32 SavedMaxTraces = Settings->MaxVisibilityTracesPerRun;
+
+			Settings->MaxVisibilityTracesPerRun = 0;
+
+			Compare(QueryManager, Querier, StockQuery, BatchedQuery, TEXT("trace"));
+
+			const TSharedPtr<FEnvQueryResult> StockResult = QueryManager->RunInstantQuery(FEnvQueryRequest(StockQuery, Querier), EEnvQueryRunMode::AllMatching);
+
+			if (TestTrue(TEXT("Wall blocks some items"), StockResult.IsValid() && StockResult->IsSuccessful() && StockResult->Items.Num() > 0 && StockResult->Items.Num() < NumGridItems))
+			{
+				constexpr int32 MaxTraces = 100;
+				Settings->MaxVisibilityTracesPerRun = MaxTraces;
+
+				const TSharedPtr<FEnvQueryResult> CappedResult = QueryManager->RunInstantQuery(FEnvQueryRequest(BatchedQuery, Querier), EEnvQueryRunMode::AllMatching);
+
+				if (TestTrue(TEXT("Capped query succeeded"), CappedResult.IsValid() && CappedResult->IsSuccessful()))
+				{
+					TestTrue(TEXT("Capped items"), CappedResult->Items.Num() > 0 && CappedResult->Items.Num() <= MaxTraces);
+				}
+			}
+
+			Settings->MaxVisibilityTracesPerRun = SavedMaxTraces;
+		}
+	}
+
+	DestroyTestWorld(World);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
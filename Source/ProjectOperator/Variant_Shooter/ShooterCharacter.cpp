@@ -12,6 +12,9 @@
 #include "Camera/CameraComponent.h"
 #include "TimerManager.h"
 #include "ShooterGameMode.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "ShooterInfluenceMapSubsystem.h"
 
 AShooterCharacter::AShooterCharacter()
 {
@@ -29,6 +32,9 @@ void AShooterCharacter::BeginPlay()
 	// reset HP to max
 	CurrentHP = MaxHP;
 
+	// initialize the replicated state
+	UpdateCombatState();
+
 	// update the HUD
 	OnDamaged.Broadcast(1.0f);
 }
@@ -41,6 +47,22 @@ void AShooterCharacter::EndPlay(EEndPlayReason::Type EndPlayReason)
 	GetWorld()->GetTimerManager().ClearTimer(RespawnTimer);
 }
 
+void AShooterCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// combat state is relevant to every client for remote visuals
+	FDoRepLifetimeParams CombatParams;
+	CombatParams.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterCharacter, CombatState, CombatParams);
+
+	// ammo is only needed by the owning client's HUD
+	FDoRepLifetimeParams AmmoParams;
+	AmmoParams.bIsPushBased = true;
+	AmmoParams.Condition = COND_OwnerOnly;
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterCharacter, AmmoState, AmmoParams);
+}
+
 void AShooterCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 {
 	// base class handles move, aim and jump inputs
@@ -76,6 +98,9 @@ float AShooterCharacter::TakeDamage(float Damage, struct FDamageEvent const& Dam
 		Die();
 	}
 
+	// replicate the new HP
+	UpdateCombatState();
+
 	// update the HUD
 	OnDamaged.Broadcast(FMath::Max(0.0f, CurrentHP / MaxHP));
 
@@ -156,7 +181,7 @@ void AShooterCharacter::AddWeaponRecoil(float Recoil)
 
 void AShooterCharacter::UpdateWeaponHUD(int32 CurrentAmmo, int32 MagazineSize)
 {
-	OnBulletCountUpdated.Broadcast(MagazineSize, CurrentAmmo);
+	UpdateAmmoState(CurrentAmmo, MagazineSize);
 }
 
 FVector AShooterCharacter::GetWeaponTargetLocation()
@@ -213,16 +238,45 @@ void AShooterCharacter::AddWeaponClass(const TSubclassOf<AShooterWeapon>& Weapon
 void AShooterCharacter::OnWeaponActivated(AShooterWeapon* Weapon)
 {
 	// update the bullet counter
-	OnBulletCountUpdated.Broadcast(Weapon->GetMagazineSize(), Weapon->GetBulletCount());
+	UpdateAmmoState(Weapon->GetBulletCount(), Weapon->GetMagazineSize());
+
+	// switch the character mesh animations over to the new weapon
+	ApplyWeaponAnimation(GetFirstPersonMesh(), LinkedFirstPersonAnimLayerClass, Weapon->GetFirstPersonAnimLayerClass(), Weapon->GetFirstPersonAnimInstanceClass());
+	ApplyWeaponAnimation(GetMesh(), LinkedThirdPersonAnimLayerClass, Weapon->GetThirdPersonAnimLayerClass(), Weapon->GetThirdPersonAnimInstanceClass());
+}
+
+void AShooterCharacter::ApplyWeaponAnimation(USkeletalMeshComponent* TargetMesh, TSubclassOf<UAnimInstance>& LinkedLayerClass, TSubclassOf<UAnimInstance> AnimLayerClass, TSubclassOf<UAnimInstance> AnimInstanceClass)
+{
+	// drop the previous weapon's layers, so interfaces the new weapon doesn't implement fall back to their defaults
+	if (LinkedLayerClass != AnimLayerClass)
+	{
+		UnlinkWeaponAnimation(TargetMesh, LinkedLayerClass);
+	}
+
+	if (AnimLayerClass)
+	{
+		TargetMesh->LinkAnimClassLayers(AnimLayerClass);
+		LinkedLayerClass = AnimLayerClass;
 
-	// set the character mesh AnimInstances
-	GetFirstPersonMesh()->SetAnimInstanceClass(Weapon->GetFirstPersonAnimInstanceClass());
-	GetMesh()->SetAnimInstanceClass(Weapon->GetThirdPersonAnimInstanceClass());
+	} else if (AnimInstanceClass && TargetMesh->GetAnimClass() != AnimInstanceClass) {
+
+		// no layers, so the whole AnimInstance has to be recreated
+		TargetMesh->SetAnimInstanceClass(AnimInstanceClass);
+	}
+}
+
+void AShooterCharacter::UnlinkWeaponAnimation(USkeletalMeshComponent* TargetMesh, TSubclassOf<UAnimInstance>& LinkedLayerClass)
+{
+	if (LinkedLayerClass)
+	{
+		TargetMesh->UnlinkAnimClassLayers(LinkedLayerClass);
+		LinkedLayerClass = nullptr;
+	}
 }
 
 void AShooterCharacter::OnWeaponDeactivated(AShooterWeapon* Weapon)
 {
-	// unused
+	// the anim layers stay linked, since a weapon switch activates the replacement right after
 }
 
 void AShooterCharacter::OnSemiWeaponRefire()
@@ -254,11 +308,21 @@ void AShooterCharacter::Die()
 		CurrentWeapon->DeactivateWeapon();
 	}
 
+	// no weapon replaces it, so unlink its anim layers
+	UnlinkWeaponAnimation(GetFirstPersonMesh(), LinkedFirstPersonAnimLayerClass);
+	UnlinkWeaponAnimation(GetMesh(), LinkedThirdPersonAnimLayerClass);
+
 	// increment the team score
 	if (AShooterGameMode* GM = Cast<AShooterGameMode>(GetWorld()->GetAuthGameMode()))
 	{
 		GM->IncrementTeamScore(TeamByte);
 	}
+
+	// mark the death on the AI influence map
+	if (UShooterInfluenceMapSubsystem* InfluenceMap = GetWorld()->GetSubsystem<UShooterInfluenceMapSubsystem>())
+	{
+		InfluenceMap->ReportDeath(this);
+	}
 		
 	// stop character movement
 	GetCharacterMovement()->StopMovementImmediately();
@@ -267,7 +331,7 @@ void AShooterCharacter::Die()
 	DisableInput(nullptr);
 
 	// reset the bullet counter UI
-	OnBulletCountUpdated.Broadcast(0, 0);
+	UpdateAmmoState(0, 0);
 
 	// call the BP handler
 	BP_OnDeath();
@@ -281,3 +345,54 @@ void AShooterCharacter::OnRespawn()
 	// destroy the character to force the PC to respawn
 	Destroy();
 }
+
+void AShooterCharacter::UpdateCombatState()
+{
+	// only the server writes the replicated state
+	if (!HasAuthority())
+	{
+		return;
+	}
+
+	CombatState.SetHP(CurrentHP, MaxHP);
+	CombatState.TeamByte = TeamByte;
+	CombatState.bIsDead = CurrentHP <= 0.0f;
+
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterCharacter, CombatState, this);
+}
+
+void AShooterCharacter::UpdateAmmoState(int32 Bullets, int32 MagazineSize)
+{
+	// only the server writes the replicated state
+	if (HasAuthority())
+	{
+		AmmoState.Set(Bullets, MagazineSize);
+
+		MARK_PROPERTY_DIRTY_FROM_NAME(AShooterCharacter, AmmoState, this);
+	}
+
+	// update the local HUD
+	OnBulletCountUpdated.Broadcast(MagazineSize, Bullets);
+}
+
+void AShooterCharacter::OnRep_CombatState(const FShooterCombatState& OldCombatState)
+{
+	// mirror the replicated HP and team locally
+	CurrentHP = CombatState.GetHPPercent() * MaxHP;
+	TeamByte = CombatState.TeamByte;
+
+	// update the HUD
+	OnDamaged.Broadcast(CombatState.GetHPPercent());
+
+	// have we just died?
+	if (CombatState.bIsDead && !OldCombatState.bIsDead)
+	{
+		BP_OnDeath();
+	}
+}
+
+void AShooterCharacter::OnRep_AmmoState()
+{
+	// update the HUD
+	OnBulletCountUpdated.Broadcast(AmmoState.MagazineSize, AmmoState.Bullets);
+}
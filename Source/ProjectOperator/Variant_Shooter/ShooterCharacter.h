@@ -5,9 +5,12 @@
 #include "CoreMinimal.h"
 #include "ProjectOperatorCharacter.h"
 #include "ShooterWeaponHolder.h"
+#include "ShooterCombatState.h"
+#include "GenericTeamAgentInterface.h"
 #include "ShooterCharacter.generated.h"
 
 class AShooterWeapon;
+class UAnimInstance;
 class UInputAction;
 class UInputComponent;
 class UPawnNoiseEmitterComponent;
@@ -21,7 +24,7 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FDamagedDelegate, float, LifePercent
  *  Manages health and death
  */
 UCLASS(abstract)
-class PROJECTOPERATOR_API AShooterCharacter : public AProjectOperatorCharacter, public IShooterWeaponHolder
+class PROJECTOPERATOR_API AShooterCharacter : public AProjectOperatorCharacter, public IShooterWeaponHolder, public IGenericTeamAgentInterface
 {
 	GENERATED_BODY()
 	
@@ -62,12 +65,24 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Team")
 	uint8 TeamByte = 0;
 
+	/** Quantized HP, team and death state replicated to all clients */
+	UPROPERTY(ReplicatedUsing=OnRep_CombatState)
+	FShooterCombatState CombatState;
+
+	/** Ammo state of the current weapon, replicated only to the owning client for the HUD */
+	UPROPERTY(ReplicatedUsing=OnRep_AmmoState)
+	FShooterAmmoState AmmoState;
+
 	/** List of weapons picked up by the character */
 	TArray<AShooterWeapon*> OwnedWeapons;
 
 	/** Weapon currently equipped and ready to shoot with */
 	TObjectPtr<AShooterWeapon> CurrentWeapon;
 
+	/** Anim layer classes currently linked into the first and third person meshes */
+	TSubclassOf<UAnimInstance> LinkedFirstPersonAnimLayerClass;
+	TSubclassOf<UAnimInstance> LinkedThirdPersonAnimLayerClass;
+
 	UPROPERTY(EditAnywhere, Category ="Destruction", meta = (ClampMin = 0, ClampMax = 10, Units = "s"))
 	float RespawnTime = 5.0f;
 
@@ -94,6 +109,9 @@ protected:
 	/** Gameplay cleanup */
 	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
 
+	/** Sets up replicated properties */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 	/** Set up input action bindings */
 	virtual void SetupPlayerInputComponent(UInputComponent* InputComponent) override;
 
@@ -102,6 +120,16 @@ public:
 	/** Handle incoming damage */
 	virtual float TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
 
+	/** Returns the team ID for this character */
+	uint8 GetTeamByte() const { return TeamByte; }
+
+	//~Begin IGenericTeamAgentInterface interface
+
+	/** Returns the team ID used for AI attitude checks */
+	virtual FGenericTeamId GetGenericTeamId() const override { return FGenericTeamId(TeamByte); }
+
+	//~End IGenericTeamAgentInterface interface
+
 public:
 
 	/** Handles start firing input */
@@ -151,6 +179,17 @@ public:
 
 protected:
 
+	/**
+	 *  Switches the mesh's animation over to a weapon
+	 *  Links the weapon's anim layers into the existing AnimInstance if it has them, so the AnimInstance isn't recreated.
+	 *  Otherwise falls back to swapping the whole AnimInstance class, but only if it actually changes.
+	 *  Any previously linked layer class is unlinked first
+	 */
+	static void ApplyWeaponAnimation(USkeletalMeshComponent* TargetMesh, TSubclassOf<UAnimInstance>& LinkedLayerClass, TSubclassOf<UAnimInstance> AnimLayerClass, TSubclassOf<UAnimInstance> AnimInstanceClass);
+
+	/** Unlinks the mesh's currently linked anim layer class, if any */
+	static void UnlinkWeaponAnimation(USkeletalMeshComponent* TargetMesh, TSubclassOf<UAnimInstance>& LinkedLayerClass);
+
 	/** Returns true if the character already owns a weapon of the given class */
 	AShooterWeapon* FindWeaponOfType(TSubclassOf<AShooterWeapon> WeaponClass) const;
 
@@ -163,4 +202,18 @@ protected:
 
 	/** Called from the respawn timer to destroy this character and force the PC to respawn */
 	void OnRespawn();
+
+	/** Copies the current HP, team and death state into the replicated combat state */
+	void UpdateCombatState();
+
+	/** Updates the replicated ammo state and the local HUD */
+	void UpdateAmmoState(int32 Bullets, int32 MagazineSize);
+
+	/** Updates the HUD and death visuals on clients from the replicated combat state */
+	UFUNCTION()
+	void OnRep_CombatState(const FShooterCombatState& OldCombatState);
+
+	/** Updates the HUD bullet counter on the owning client */
+	UFUNCTION()
+	void OnRep_AmmoState();
 };
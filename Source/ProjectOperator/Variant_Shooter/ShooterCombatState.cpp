@@ -0,0 +1,24 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterCombatState.h"
+
+void FShooterCombatState::SetHP(float CurrentHP, float MaxHP)
+{
+	// guard against a zero max HP
+	const float Percent = MaxHP > 0.0f ? FMath::Clamp(CurrentHP / MaxHP, 0.0f, 1.0f) : 0.0f;
+
+	// scale the fraction to the full word range
+	QuantizedHP = static_cast<uint16>(FMath::RoundToInt(Percent * MAX_uint16));
+}
+
+float FShooterCombatState::GetHPPercent() const
+{
+	return static_cast<float>(QuantizedHP) / MAX_uint16;
+}
+
+void FShooterAmmoState::Set(int32 InBullets, int32 InMagazineSize)
+{
+	Bullets = static_cast<uint8>(FMath::Clamp(InBullets, 0, MAX_uint8));
+	MagazineSize = static_cast<uint8>(FMath::Clamp(InMagazineSize, 0, MAX_uint8));
+}
@@ -0,0 +1,54 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ShooterCombatState.generated.h"
+
+/**
+ *  Compact replicated combat state shared by shooter characters and NPCs
+ *  HP is quantized to a fraction of max HP so it fits in a word on the wire
+ */
+USTRUCT(BlueprintType)
+struct PROJECTOPERATOR_API FShooterCombatState
+{
+	GENERATED_BODY()
+
+	/** Remaining HP as a fraction of max HP, quantized to the full uint16 range */
+	UPROPERTY()
+	uint16 QuantizedHP = 0;
+
+	/** Team ID for the owning character */
+	UPROPERTY()
+	uint8 TeamByte = 0;
+
+	/** If true, the owning character has died */
+	UPROPERTY()
+	bool bIsDead = false;
+
+	/** Quantizes and stores the passed HP values */
+	void SetHP(float CurrentHP, float MaxHP);
+
+	/** Returns the remaining HP as a 0-1 fraction */
+	float GetHPPercent() const;
+};
+
+/**
+ *  Compact replicated ammo state for the owning client's weapon HUD
+ */
+USTRUCT(BlueprintType)
+struct PROJECTOPERATOR_API FShooterAmmoState
+{
+	GENERATED_BODY()
+
+	/** Bullets left in the current magazine */
+	UPROPERTY()
+	uint8 Bullets = 0;
+
+	/** Size of the current magazine */
+	UPROPERTY()
+	uint8 MagazineSize = 0;
+
+	/** Stores the passed ammo values clamped to the replicated range */
+	void Set(int32 InBullets, int32 InMagazineSize);
+};
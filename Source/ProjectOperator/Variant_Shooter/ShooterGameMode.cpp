@@ -5,6 +5,7 @@
 #include "ShooterUI.h"
 #include "Kismet/GameplayStatics.h"
 #include "Engine/World.h"
+#include "ShooterRoundResetSubsystem.h"
 
 void AShooterGameMode::BeginPlay()
 {
@@ -13,6 +14,12 @@ void AShooterGameMode::BeginPlay()
 	// create the UI
 	ShooterUI = CreateWidget<UShooterUI>(UGameplayStatics::GetPlayerController(GetWorld(), 0), ShooterUIClass);
 	ShooterUI->AddToViewport(0);
+
+	// remember the starting state so rounds can be reset in place
+	if (UShooterRoundResetSubsystem* RoundReset = GetWorld()->GetSubsystem<UShooterRoundResetSubsystem>())
+	{
+		RoundReset->RequestSnapshot();
+	}
 }
 
 void AShooterGameMode::IncrementTeamScore(uint8 TeamByte)
@@ -31,3 +38,22 @@ void AShooterGameMode::IncrementTeamScore(uint8 TeamByte)
 	// update the UI
 	ShooterUI->BP_UpdateScore(TeamByte, Score);
 }
+
+void AShooterGameMode::ResetTeamScores()
+{
+	// zero out the scores on the UI
+	for (const TPair<uint8, int32>& TeamScore : TeamScores)
+	{
+		ShooterUI->BP_UpdateScore(TeamScore.Key, 0);
+	}
+
+	TeamScores.Reset();
+}
+
+void AShooterGameMode::ResetRound()
+{
+	if (UShooterRoundResetSubsystem* RoundReset = GetWorld()->GetSubsystem<UShooterRoundResetSubsystem>())
+	{
+		RoundReset->StartRoundReset();
+	}
+}
@@ -12,6 +12,7 @@ class UShooterUI;
  *  Simple GameMode for a first person shooter game
  *  Manages game UI
  *  Keeps track of team scores
+ *  Resets rounds in place without reloading the map
  */
 UCLASS(abstract)
 class PROJECTOPERATOR_API AShooterGameMode : public AGameModeBase
@@ -39,4 +40,11 @@ public:
 
 	/** Increases the score for the given team */
 	void IncrementTeamScore(uint8 TeamByte);
+
+	/** Clears every team score */
+	void ResetTeamScores();
+
+	/** Restores the level to its starting state over the next few frames */
+	UFUNCTION(BlueprintCallable, Category="Shooter")
+	void ResetRound();
 };
@@ -5,9 +5,9 @@
 #include "EnhancedInputSubsystems.h"
 #include "Engine/LocalPlayer.h"
 #include "InputMappingContext.h"
-#include "Kismet/GameplayStatics.h"
 #include "GameFramework/PlayerStart.h"
 #include "ShooterCharacter.h"
+#include "ShooterSpawnPointSubsystem.h"
 #include "ShooterBulletCounterUI.h"
 #include "ProjectOperator.h"
 #include "Widgets/Input/SVirtualJoystick.h"
@@ -87,9 +87,6 @@ void AShooterPlayerController::OnPossess(APawn* InPawn)
 	// is this a shooter character?
 	if (AShooterCharacter* ShooterCharacter = Cast<AShooterCharacter>(InPawn))
 	{
-		// add the player tag
-		ShooterCharacter->Tags.Add(PlayerPawnTag);
-
 		// subscribe to the pawn's delegates
 		ShooterCharacter->OnBulletCountUpdated.AddDynamic(this, &AShooterPlayerController::OnBulletCountUpdated);
 		ShooterCharacter->OnDamaged.AddDynamic(this, &AShooterPlayerController::OnPawnDamaged);
@@ -104,17 +101,19 @@ void AShooterPlayerController::OnPawnDestroyed(AActor* DestroyedActor)
 	// reset the bullet counter HUD
 	BulletCounterUI->BP_UpdateBulletCounter(0, 0);
 
-	// find the player start
-	TArray<AActor*> ActorList;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), APlayerStart::StaticClass(), ActorList);
-
-	if (ActorList.Num() > 0)
+	if (!CharacterClass)
 	{
-		// select a random player start
-		AActor* RandomPlayerStart = ActorList[FMath::RandRange(0, ActorList.Num() - 1)];
+		return;
+	}
 
+	// find the safest player start for the respawned character's team
+	UShooterSpawnPointSubsystem* SpawnPoints = GetWorld()->GetSubsystem<UShooterSpawnPointSubsystem>();
+	const uint8 TeamByte = CharacterClass->GetDefaultObject<AShooterCharacter>()->GetTeamByte();
+
+	if (APlayerStart* BestPlayerStart = SpawnPoints ? SpawnPoints->GetBestSpawnPoint(TeamByte) : nullptr)
+	{
 		// spawn a character at the player start
-		const FTransform SpawnTransform = RandomPlayerStart->GetActorTransform();
+		const FTransform SpawnTransform = BestPlayerStart->GetActorTransform();
 
 		if (AShooterCharacter* RespawnedCharacter = GetWorld()->SpawnActor<AShooterCharacter>(CharacterClass, SpawnTransform))
 		{
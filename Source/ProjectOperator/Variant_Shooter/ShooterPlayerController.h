@@ -45,8 +45,8 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Shooter|UI")
 	TSubclassOf<UShooterBulletCounterUI> BulletCounterUIClass;
 
-	/** Tag to grant the possessed pawn to flag it as the player */
-	UPROPERTY(EditAnywhere, Category="Shooter|Player")
+	/** Deprecated. Players are identified by team attitude. Kept so existing Blueprint references still load and compile */
+	UPROPERTY(EditAnywhere, Category="Shooter|Player", meta = (DeprecatedProperty, DeprecationMessage = "Players are identified by team attitude"))
 	FName PlayerPawnTag = FName("Player");
 
 	/** Pointer to the bullet counter UI widget */
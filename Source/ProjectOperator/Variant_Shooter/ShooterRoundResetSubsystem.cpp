@@ -0,0 +1,277 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/ShooterRoundResetSubsystem.h"
+#include "Variant_Shooter/ShooterGameMode.h"
+#include "Variant_Shooter/ShooterCharacter.h"
+#include "Variant_Shooter/AI/ShooterNPC.h"
+#include "Variant_Shooter/AI/ShooterNPCPool.h"
+#include "Variant_Shooter/Weapons/ShooterPickupSubsystem.h"
+#include "Interactables/InteractableActivator.h"
+#include "Activables/ActivableBase.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Settings/ShooterAISettings.h"
+#include "ProjectOperator.h"
+
+DECLARE_CYCLE_STAT(TEXT("Round Reset"), STAT_ShooterRoundReset, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Round Reset Steps"), STAT_ShooterRoundResetSteps, STATGROUP_ShooterAI);
+
+void UShooterRoundResetSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	if (UShooterNPCPool* Pool = Collection.InitializeDependency<UShooterNPCPool>())
+	{
+		NPCReleasedHandle = Pool->OnNPCReleased.AddUObject(this, &UShooterRoundResetSubsystem::OnNPCReleased);
+	}
+}
+
+void UShooterRoundResetSubsystem::Deinitialize()
+{
+	if (UShooterNPCPool* Pool = GetWorld()->GetSubsystem<UShooterNPCPool>())
+	{
+		Pool->OnNPCReleased.Remove(NPCReleasedHandle);
+	}
+
+	Super::Deinitialize();
+}
+
+bool UShooterRoundResetSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterRoundResetSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (bSnapshotPending)
+	{
+		bSnapshotPending = false;
+
+		TakeSnapshot();
+	}
+
+	if (Phase == EShooterRoundResetPhase::Idle)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterRoundReset);
+
+	const double StartTime = FPlatformTime::Seconds();
+	const double BudgetSeconds = GetDefault<UShooterAISettings>()->RoundResetBudgetMs * 0.001;
+
+	int32 NumSteps = 0;
+
+	// always take at least one step per frame so the reset keeps moving
+	while (Phase != EShooterRoundResetPhase::Idle && (NumSteps == 0 || FPlatformTime::Seconds() - StartTime < BudgetSeconds))
+	{
+		ResetNext();
+		++NumSteps;
+	}
+
+	INC_DWORD_STAT_BY(STAT_ShooterRoundResetSteps, NumSteps);
+}
+
+TStatId UShooterRoundResetSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterRoundResetSubsystem, STATGROUP_Tickables);
+}
+
+void UShooterRoundResetSubsystem::RequestSnapshot()
+{
+	bSnapshotPending = true;
+}
+
+void UShooterRoundResetSubsystem::StartRoundReset()
+{
+	// only the server resets the round. Clients get the results through replication
+	if (GetWorld()->GetNetMode() == NM_Client || IsResetting())
+	{
+		return;
+	}
+
+	// make sure there's something to restore
+	if (bSnapshotPending)
+	{
+		bSnapshotPending = false;
+
+		TakeSnapshot();
+	}
+
+	Phase = EShooterRoundResetPhase::Interactables;
+	PhaseIndex = 0;
+}
+
+void UShooterRoundResetSubsystem::TakeSnapshot()
+{
+	Interactables.Reset();
+	Activables.Reset();
+	NPCs.Reset();
+
+	// this only runs once per level, so a full iteration is fine here
+	for (TActorIterator<AInteractableActivator> It(GetWorld()); It; ++It)
+	{
+		Interactables.Add(*It);
+	}
+
+	for (TActorIterator<AActivableBase> It(GetWorld()); It; ++It)
+	{
+		Activables.Add(*It);
+	}
+
+	for (TActorIterator<AShooterNPC> It(GetWorld()); It; ++It)
+	{
+		// skip NPCs already sitting in the pool
+		if (It->IsPooled())
+		{
+			continue;
+		}
+
+		FShooterRoundNPCSnapshot& Snapshot = NPCs.AddDefaulted_GetRef();
+		Snapshot.NPC = *It;
+		Snapshot.NPCClass = It->GetClass();
+		Snapshot.Transform = It->GetActorTransform();
+		Snapshot.MaxHP = It->GetMaxHP();
+		Snapshot.TeamByte = It->GetTeamByte();
+		Snapshot.SquadName = It->GetSquadName();
+	}
+}
+
+void UShooterRoundResetSubsystem::ResetNext()
+{
+	switch (Phase)
+	{
+	case EShooterRoundResetPhase::Interactables:
+
+		if (Interactables.IsValidIndex(PhaseIndex))
+		{
+			if (AInteractableActivator* Interactable = Interactables[PhaseIndex++].Get())
+			{
+				Interactable->ResetInteractable();
+			}
+
+			return;
+		}
+
+		break;
+
+	case EShooterRoundResetPhase::Activables:
+
+		if (Activables.IsValidIndex(PhaseIndex))
+		{
+			if (AActivableBase* Activable = Activables[PhaseIndex++].Get())
+			{
+				Activable->ResetActivable();
+			}
+
+			return;
+		}
+
+		break;
+
+	case EShooterRoundResetPhase::Pickups:
+
+		// the pickup subsystem restores everything from its compact arrays in one go
+		if (UShooterPickupSubsystem* PickupSubsystem = GetWorld()->GetSubsystem<UShooterPickupSubsystem>())
+		{
+			PickupSubsystem->ResetAllPickups();
+		}
+
+		break;
+
+	case EShooterRoundResetPhase::NPCs:
+
+		if (NPCs.IsValidIndex(PhaseIndex))
+		{
+			ResetNPC(NPCs[PhaseIndex++]);
+			return;
+		}
+
+		break;
+
+	case EShooterRoundResetPhase::Players:
+
+		ResetPlayers();
+		break;
+
+	case EShooterRoundResetPhase::Scores:
+
+		if (AShooterGameMode* GameMode = GetWorld()->GetAuthGameMode<AShooterGameMode>())
+		{
+			GameMode->ResetTeamScores();
+		}
+
+		break;
+
+	default:
+
+		break;
+	}
+
+	// move on to the next step
+	PhaseIndex = 0;
+	Phase = static_cast<EShooterRoundResetPhase>(static_cast<uint8>(Phase) + 1);
+
+	if (Phase == EShooterRoundResetPhase::Finished)
+	{
+		Phase = EShooterRoundResetPhase::Idle;
+
+		OnRoundResetFinished.Broadcast();
+	}
+}
+
+void UShooterRoundResetSubsystem::OnNPCReleased(AShooterNPC* NPC)
+{
+	for (FShooterRoundNPCSnapshot& Snapshot : NPCs)
+	{
+		if (Snapshot.NPC == NPC)
+		{
+			Snapshot.NPC = nullptr;
+		}
+	}
+}
+
+void UShooterRoundResetSubsystem::ResetNPC(FShooterRoundNPCSnapshot& Snapshot)
+{
+	UShooterNPCPool* Pool = GetWorld()->GetSubsystem<UShooterNPCPool>();
+
+	if (!Pool)
+	{
+		return;
+	}
+
+	// pool the NPC if it still belongs to this placement, whether alive or dead. Pooling restores its HP, ammo and alive state
+	// NPCs released earlier were let go of, since the spawn director or the bot subsystem may have reused them since
+	if (AShooterNPC* NPC = Snapshot.NPC.Get())
+	{
+		Pool->ReleaseNPC(NPC);
+	}
+
+	// bring an NPC back in at the starting placement. This is usually the same one we just pooled
+	Snapshot.NPC = Pool->AcquireNPC(Snapshot.NPCClass, Snapshot.Transform, [&Snapshot](AShooterNPC& AcquiredNPC)
+	{
+		// NPCs spawned fresh pick up their HP from the class defaults in BeginPlay
+		if (Snapshot.MaxHP > 0.0f)
+		{
+			AcquiredNPC.ApplyBotState(Snapshot.MaxHP, Snapshot.MaxHP, Snapshot.TeamByte, Snapshot.SquadName);
+		}
+	});
+}
+
+void UShooterRoundResetSubsystem::ResetPlayers()
+{
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PC = It->Get();
+
+		// destroying the character makes the shooter player controller respawn it at the best spawn point
+		if (AShooterCharacter* Character = PC ? Cast<AShooterCharacter>(PC->GetPawn()) : nullptr)
+		{
+			Character->Destroy();
+		}
+	}
+}
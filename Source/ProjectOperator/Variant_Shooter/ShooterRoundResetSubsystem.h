@@ -0,0 +1,139 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Templates/SubclassOf.h"
+#include "ShooterRoundResetSubsystem.generated.h"
+
+class AInteractableActivator;
+class AActivableBase;
+class AShooterNPC;
+
+/**
+ *  Steps of an in-place round reset, in the order they run
+ */
+enum class EShooterRoundResetPhase : uint8
+{
+	Idle,
+	Interactables,
+	Activables,
+	Pickups,
+	NPCs,
+	Players,
+	Scores,
+	Finished
+};
+
+/**
+ *  Starting state of an NPC placed in the level
+ */
+struct FShooterRoundNPCSnapshot
+{
+	/** NPC currently standing in for this placement. Cleared once it's released to the pool */
+	TWeakObjectPtr<AShooterNPC> NPC;
+
+	/** Class to acquire from the pool if the NPC is gone */
+	TSubclassOf<AShooterNPC> NPCClass;
+
+	/** Starting transform */
+	FTransform Transform;
+
+	/** Starting HP */
+	float MaxHP = 0.0f;
+
+	/** Starting team */
+	uint8 TeamByte = 0;
+
+	/** Starting squad */
+	FName SquadName;
+};
+
+/**
+ *  Resets a round in place instead of reloading the map
+ *  The resettable actors are snapshotted once play begins. Resetting the round restores them
+ *  over a few frames within a time budget: interactables, activables, pickups, NPCs through the pool,
+ *  player characters through a respawn and finally the team scores
+ */
+UCLASS()
+class PROJECTOPERATOR_API UShooterRoundResetSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Interactables to reset */
+	TArray<TWeakObjectPtr<AInteractableActivator>> Interactables;
+
+	/** Activables to reset */
+	TArray<TWeakObjectPtr<AActivableBase>> Activables;
+
+	/** NPCs placed in the level and how they started */
+	TArray<FShooterRoundNPCSnapshot> NPCs;
+
+	/** Current reset step */
+	EShooterRoundResetPhase Phase = EShooterRoundResetPhase::Idle;
+
+	/** Next item to reset within the current step */
+	int32 PhaseIndex = 0;
+
+	/** If true, the snapshot is taken on the next tick */
+	bool bSnapshotPending = false;
+
+	/** Handle for the NPC pool release delegate */
+	FDelegateHandle NPCReleasedHandle;
+
+public:
+
+	/** Broadcast once a round reset has restored everything */
+	FSimpleMulticastDelegate OnRoundResetFinished;
+
+public:
+
+	/** Watches the NPC pool for released NPCs */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Subsystem cleanup */
+	virtual void Deinitialize() override;
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Takes the pending snapshot and runs the current reset within the frame budget */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable object */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/**
+	 *  Snapshots the resettable actors in the world
+	 *  Called from BeginPlay. The snapshot is taken on the next tick, once every actor has begun play
+	 */
+	void RequestSnapshot();
+
+	/** Starts restoring the snapshotted state. Does nothing on clients or while a reset is already running */
+	void StartRoundReset();
+
+	/** Returns true while a round reset is in progress */
+	bool IsResetting() const { return Phase != EShooterRoundResetPhase::Idle; }
+
+protected:
+
+	/** Gathers the resettable actors and the starting state of the placed NPCs */
+	void TakeSnapshot();
+
+	/** Resets the next item of the current step, moving on to the next step once it's done */
+	void ResetNext();
+
+	/** Lets go of a placed NPC released to the pool, since it may be reused by somebody else */
+	void OnNPCReleased(AShooterNPC* NPC);
+
+	/** Returns a placed NPC to its starting state through the NPC pool */
+	void ResetNPC(FShooterRoundNPCSnapshot& Snapshot);
+
+	/** Respawns every player shooter character at the best spawn point for its team */
+	void ResetPlayers();
+};
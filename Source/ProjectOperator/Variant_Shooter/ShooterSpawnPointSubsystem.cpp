@@ -0,0 +1,335 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/ShooterSpawnPointSubsystem.h"
+#include "Variant_Shooter/ShooterTeams.h"
+#include "Variant_Shooter/AI/ShooterInfluenceMapSubsystem.h"
+#include "Variant_Shooter/AI/ShooterNPC.h"
+#include "GameFramework/PlayerStart.h"
+#include "GameFramework/Controller.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "Settings/ShooterAISettings.h"
+#include "ProjectOperator.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spawn Point Scoring"), STAT_ShooterSpawnPointScoring, STATGROUP_ShooterAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Spawn Points"), STAT_ShooterSpawnPoints, STATGROUP_ShooterAI);
+
+void FShooterSpawnTeamScores::UpdateBestIndex()
+{
+	BestIndex = INDEX_NONE;
+
+	for (int32 Index = 0; Index < Scores.Num(); ++Index)
+	{
+		if (BestIndex == INDEX_NONE || Scores[Index] > Scores[BestIndex])
+		{
+			BestIndex = Index;
+		}
+	}
+}
+
+void UShooterSpawnPointSubsystem::PostInitialize()
+{
+	Super::PostInitialize();
+
+	// cache the player starts already loaded
+	for (const ULevel* Level : GetWorld()->GetLevels())
+	{
+		AddSpawnPoints(Level);
+	}
+
+	// keep up with level streaming
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UShooterSpawnPointSubsystem::OnLevelAdded);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UShooterSpawnPointSubsystem::OnLevelRemoved);
+}
+
+void UShooterSpawnPointSubsystem::Deinitialize()
+{
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+
+	Super::Deinitialize();
+}
+
+bool UShooterSpawnPointSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterSpawnPointSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SET_DWORD_STAT(STAT_ShooterSpawnPoints, SpawnPoints.Num());
+
+	// nothing to score until a team asks for a spawn point
+	if (SpawnPoints.IsEmpty() || TeamScores.IsEmpty())
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterSpawnPointScoring);
+
+	GatherCharacters();
+
+	// rescore a slice of the spawn points, wrapping around
+	const int32 NumToScore = FMath::Min(GetDefault<UShooterAISettings>()->SpawnPointsScoredPerFrame, SpawnPoints.Num());
+
+	for (int32 i = 0; i < NumToScore; ++i)
+	{
+		NextScoredIndex %= SpawnPoints.Num();
+
+		RescoreSpawnPoint(NextScoredIndex++);
+	}
+}
+
+TStatId UShooterSpawnPointSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterSpawnPointSubsystem, STATGROUP_Tickables);
+}
+
+APlayerStart* UShooterSpawnPointSubsystem::GetBestSpawnPoint(uint8 Team)
+{
+	if (SpawnPoints.IsEmpty())
+	{
+		return nullptr;
+	}
+
+	FShooterSpawnTeamScores* TeamScore = TeamScores.Find(Team);
+
+	// start tracking the team
+	if (!TeamScore)
+	{
+		GatherCharacters();
+
+		TeamScore = &TeamScores.Add(Team);
+		RescoreTeam(Team, *TeamScore);
+	}
+
+	APlayerStart* BestSpawnPoint = SpawnPoints.IsValidIndex(TeamScore->BestIndex) ? SpawnPoints[TeamScore->BestIndex].Get() : nullptr;
+
+	// the best spawn point was destroyed without its level streaming out
+	if (!BestSpawnPoint)
+	{
+		RescoreTeam(Team, *TeamScore);
+
+		BestSpawnPoint = SpawnPoints.IsValidIndex(TeamScore->BestIndex) ? SpawnPoints[TeamScore->BestIndex].Get() : nullptr;
+	}
+
+	if (BestSpawnPoint)
+	{
+		ClaimSpawnPoint(TeamScore->BestIndex, Team);
+	}
+
+	return BestSpawnPoint;
+}
+
+void UShooterSpawnPointSubsystem::ClaimSpawnPoint(int32 Index, uint8 Team)
+{
+	// count the spawning character as standing on the point until the next gather picks up the real one,
+	// so players spawning on the same frame don't all get the same point
+	Characters.Emplace(SpawnLocations[Index], Team);
+
+	RescoreSpawnPoint(Index);
+
+	// the claimed point only got worse, so any team that had it as the best needs to look again
+	for (TPair<uint8, FShooterSpawnTeamScores>& Pair : TeamScores)
+	{
+		if (Pair.Value.BestIndex == Index)
+		{
+			Pair.Value.UpdateBestIndex();
+		}
+	}
+}
+
+void UShooterSpawnPointSubsystem::OnLevelAdded(ULevel* Level, UWorld* World)
+{
+	if (World != GetWorld())
+	{
+		return;
+	}
+
+	const int32 NumSpawnPoints = SpawnPoints.Num();
+
+	AddSpawnPoints(Level);
+
+	// score the new spawn points for every tracked team
+	if (SpawnPoints.Num() != NumSpawnPoints)
+	{
+		GatherCharacters();
+
+		for (TPair<uint8, FShooterSpawnTeamScores>& Pair : TeamScores)
+		{
+			Pair.Value.Scores.SetNum(SpawnPoints.Num());
+
+			for (int32 Index = NumSpawnPoints; Index < SpawnPoints.Num(); ++Index)
+			{
+				Pair.Value.Scores[Index] = ScoreSpawnPoint(Index, Pair.Key);
+
+				if (!Pair.Value.Scores.IsValidIndex(Pair.Value.BestIndex) || Pair.Value.Scores[Index] > Pair.Value.Scores[Pair.Value.BestIndex])
+				{
+					Pair.Value.BestIndex = Index;
+				}
+			}
+		}
+	}
+}
+
+void UShooterSpawnPointSubsystem::OnLevelRemoved(ULevel* Level, UWorld* World)
+{
+	if (World != GetWorld())
+	{
+		return;
+	}
+
+	// a null level means every streamed level is going away
+	bool bRemovedAny = false;
+
+	for (int32 Index = SpawnPoints.Num() - 1; Index >= 0; --Index)
+	{
+		const APlayerStart* SpawnPoint = SpawnPoints[Index].Get();
+
+		if (!SpawnPoint || !Level || SpawnPoint->GetLevel() == Level)
+		{
+			SpawnPoints.RemoveAtSwap(Index);
+			SpawnLocations.RemoveAtSwap(Index);
+			bRemovedAny = true;
+		}
+	}
+
+	// indices moved, so rescore the tracked teams from scratch
+	if (bRemovedAny)
+	{
+		NextScoredIndex = 0;
+
+		GatherCharacters();
+
+		for (TPair<uint8, FShooterSpawnTeamScores>& Pair : TeamScores)
+		{
+			RescoreTeam(Pair.Key, Pair.Value);
+		}
+	}
+}
+
+void UShooterSpawnPointSubsystem::AddSpawnPoints(const ULevel* Level)
+{
+	if (!Level)
+	{
+		return;
+	}
+
+	for (AActor* Actor : Level->Actors)
+	{
+		if (APlayerStart* PlayerStart = Cast<APlayerStart>(Actor))
+		{
+			SpawnPoints.Add(PlayerStart);
+			SpawnLocations.Add(PlayerStart->GetActorLocation());
+		}
+	}
+}
+
+void UShooterSpawnPointSubsystem::GatherCharacters()
+{
+	Characters.Reset();
+
+	// controllers are a short list compared to every actor in the world
+	for (FConstControllerIterator It = GetWorld()->GetControllerIterator(); It; ++It)
+	{
+		const APawn* Pawn = It->Get() ? It->Get()->GetPawn() : nullptr;
+
+		if (!Pawn)
+		{
+			continue;
+		}
+
+		// dead and pooled NPCs stay possessed, but they're no threat
+		if (const AShooterNPC* NPC = Cast<AShooterNPC>(Pawn))
+		{
+			if (NPC->IsDead() || NPC->IsPooled())
+			{
+				continue;
+			}
+		}
+
+		uint8 Team;
+
+		if (UShooterInfluenceMapSubsystem::GetActorTeam(Pawn, Team))
+		{
+			Characters.Emplace(Pawn->GetActorLocation(), Team);
+		}
+	}
+}
+
+float UShooterSpawnPointSubsystem::ScoreSpawnPoint(int32 Index, uint8 Team) const
+{
+	// destroyed spawn points are never picked
+	if (!SpawnPoints[Index].IsValid())
+	{
+		return -UE_MAX_FLT;
+	}
+
+	const UShooterAISettings* Settings = GetDefault<UShooterAISettings>();
+
+	const FVector& Location = SpawnLocations[Index];
+	const float BlockedRadiusSquared = FMath::Square(Settings->SpawnBlockedRadius);
+
+	float NearestEnemySquared = FMath::Square(Settings->SpawnSafeDistance);
+	bool bBlocked = false;
+
+	for (const TPair<FVector, uint8>& Character : Characters)
+	{
+		const float DistanceSquared = FVector::DistSquared(Character.Key, Location);
+
+		bBlocked |= DistanceSquared <= BlockedRadiusSquared;
+
+		if (FShooterTeamAttitudes::IsHostile(Team, Character.Value))
+		{
+			NearestEnemySquared = FMath::Min(NearestEnemySquared, DistanceSquared);
+		}
+	}
+
+	// favor spawn points far from enemies
+	float Score = FMath::Sqrt(NearestEnemySquared);
+
+	// avoid places where the enemies have recently been shooting or killing
+	if (const UShooterInfluenceMapSubsystem* InfluenceMap = GetWorld()->GetSubsystem<UShooterInfluenceMapSubsystem>())
+	{
+		Score -= InfluenceMap->GetThreat(Team, Location) * Settings->SpawnThreatPenalty;
+	}
+
+	// avoid spawning on top of somebody
+	if (bBlocked)
+	{
+		Score -= Settings->SpawnSafeDistance;
+	}
+
+	return Score;
+}
+
+void UShooterSpawnPointSubsystem::RescoreSpawnPoint(int32 Index)
+{
+	for (TPair<uint8, FShooterSpawnTeamScores>& Pair : TeamScores)
+	{
+		FShooterSpawnTeamScores& TeamScore = Pair.Value;
+
+		TeamScore.Scores[Index] = ScoreSpawnPoint(Index, Pair.Key);
+
+		// a worse score on the current best lets the others catch up as they're rescored
+		if (!TeamScore.Scores.IsValidIndex(TeamScore.BestIndex) || TeamScore.Scores[Index] > TeamScore.Scores[TeamScore.BestIndex])
+		{
+			TeamScore.BestIndex = Index;
+		}
+	}
+}
+
+void UShooterSpawnPointSubsystem::RescoreTeam(uint8 Team, FShooterSpawnTeamScores& TeamScore) const
+{
+	TeamScore.Scores.SetNum(SpawnPoints.Num());
+
+	for (int32 Index = 0; Index < SpawnPoints.Num(); ++Index)
+	{
+		TeamScore.Scores[Index] = ScoreSpawnPoint(Index, Team);
+	}
+
+	TeamScore.UpdateBestIndex();
+}
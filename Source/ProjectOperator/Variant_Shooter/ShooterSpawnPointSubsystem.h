@@ -0,0 +1,108 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterSpawnPointSubsystem.generated.h"
+
+class APlayerStart;
+class ULevel;
+
+/**
+ *  Spawn point scores for a single team
+ */
+struct FShooterSpawnTeamScores
+{
+	/** Score for each spawn point, in spawn point order. Higher is safer */
+	TArray<float> Scores;
+
+	/** Index of the best scored spawn point, or INDEX_NONE */
+	int32 BestIndex = INDEX_NONE;
+
+	/** Finds the best scored spawn point from scratch */
+	void UpdateBestIndex();
+};
+
+/**
+ *  Registry of player starts for respawning shooter characters
+ *  Player starts are cached when the world initializes and kept up to date as levels stream in and out
+ *  A few spawn points are rescored against enemy positions every frame, so the safest one is always ready
+ */
+UCLASS()
+class PROJECTOPERATOR_API UShooterSpawnPointSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Cached player starts */
+	TArray<TWeakObjectPtr<APlayerStart>> SpawnPoints;
+
+	/** Cached spawn point locations, in spawn point order */
+	TArray<FVector> SpawnLocations;
+
+	/** Spawn point scores for each team that has asked for a spawn point */
+	TMap<uint8, FShooterSpawnTeamScores> TeamScores;
+
+	/** Locations and teams of the living characters, gathered each frame. Includes spawn points handed out since the last gather */
+	TArray<TPair<FVector, uint8>> Characters;
+
+	/** Index of the next spawn point to rescore */
+	int32 NextScoredIndex = 0;
+
+	/** Handles for the level streaming delegates */
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+
+public:
+
+	/** Caches the player starts in the persistent level and watches for streamed levels */
+	virtual void PostInitialize() override;
+
+	/** Subsystem cleanup */
+	virtual void Deinitialize() override;
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Rescores the next few spawn points */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable object */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/**
+	 *  Returns the safest spawn point for the given team, or nullptr if there are none
+	 *  Teams are scored from the first time they ask, so their first call rescores every spawn point
+	 */
+	APlayerStart* GetBestSpawnPoint(uint8 Team);
+
+protected:
+
+	/** Adds the player starts in a newly streamed level */
+	void OnLevelAdded(ULevel* Level, UWorld* World);
+
+	/** Removes the player starts belonging to a level being streamed out */
+	void OnLevelRemoved(ULevel* Level, UWorld* World);
+
+	/** Adds the player starts in the given level */
+	void AddSpawnPoints(const ULevel* Level);
+
+	/** Gathers the locations and teams of the living characters */
+	void GatherCharacters();
+
+	/** Scores a spawn point for the given team against the gathered characters */
+	float ScoreSpawnPoint(int32 Index, uint8 Team) const;
+
+	/** Marks a handed out spawn point as occupied and moves every team's best spawn point off it */
+	void ClaimSpawnPoint(int32 Index, uint8 Team);
+
+	/** Rescores a spawn point for every tracked team, updating their best spawn point */
+	void RescoreSpawnPoint(int32 Index);
+
+	/** Rescores every spawn point for the given team from scratch */
+	void RescoreTeam(uint8 Team, FShooterSpawnTeamScores& TeamScore) const;
+};
@@ -0,0 +1,19 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/ShooterTeamSubsystem.h"
+#include "Variant_Shooter/ShooterTeams.h"
+#include "Settings/ShooterAISettings.h"
+
+void UShooterTeamSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// rebuilt for every world, so allied team changes between PIE sessions are picked up
+	FShooterTeamAttitudes::Initialize(GetDefault<UShooterAISettings>()->AlliedTeams);
+}
+
+bool UShooterTeamSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
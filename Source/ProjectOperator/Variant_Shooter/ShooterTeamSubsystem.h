@@ -0,0 +1,25 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterTeamSubsystem.generated.h"
+
+/**
+ *  Builds the shooter team attitude table for every game world, whatever game mode it runs
+ *  Runs before any actor begins play, so perception and targeting always see the configured attitudes
+ */
+UCLASS()
+class PROJECTOPERATOR_API UShooterTeamSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Builds the team attitude table from the AI settings */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+};
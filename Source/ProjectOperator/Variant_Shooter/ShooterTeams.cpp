@@ -0,0 +1,38 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/ShooterTeams.h"
+#include "Settings/ShooterAISettings.h"
+
+uint32 FShooterTeamAttitudes::HostileMasks[FShooterTeamAttitudes::MaxTeams] = {};
+
+void FShooterTeamAttitudes::Initialize(const TArray<FShooterTeamPair>& AlliedTeams)
+{
+	// every team is hostile to every other team by default
+	for (int32 Team = 0; Team < MaxTeams; ++Team)
+	{
+		HostileMasks[Team] = ~(1u << Team);
+	}
+
+	// clear the allied pairs both ways
+	for (const FShooterTeamPair& Pair : AlliedTeams)
+	{
+		if (Pair.TeamA < MaxTeams && Pair.TeamB < MaxTeams)
+		{
+			HostileMasks[Pair.TeamA] &= ~(1u << Pair.TeamB);
+			HostileMasks[Pair.TeamB] &= ~(1u << Pair.TeamA);
+		}
+	}
+
+	FGenericTeamId::SetAttitudeSolver(&FShooterTeamAttitudes::GetAttitude);
+}
+
+ETeamAttitude::Type FShooterTeamAttitudes::GetAttitude(FGenericTeamId TeamA, FGenericTeamId TeamB)
+{
+	if (TeamA == TeamB)
+	{
+		return TeamA == FGenericTeamId::NoTeam ? ETeamAttitude::Neutral : ETeamAttitude::Friendly;
+	}
+
+	return IsHostile(TeamA.GetId(), TeamB.GetId()) ? ETeamAttitude::Hostile : ETeamAttitude::Neutral;
+}
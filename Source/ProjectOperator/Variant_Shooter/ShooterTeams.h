@@ -0,0 +1,36 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GenericTeamAgentInterface.h"
+
+struct FShooterTeamPair;
+
+/**
+ *  Team attitude table for the shooter variant
+ *  Each team keeps a bitmask of the teams it's hostile to, so attitude checks are a single bit test
+ *  Teams outside the table, including NoTeam, are neutral to everybody
+ */
+struct PROJECTOPERATOR_API FShooterTeamAttitudes
+{
+	/** Number of teams tracked by the table */
+	static constexpr int32 MaxTeams = 32;
+
+	/** Makes every team hostile to every other team except the allied pairs, and installs the attitude solver */
+	static void Initialize(const TArray<FShooterTeamPair>& AlliedTeams);
+
+	/** Returns true if the two teams are hostile to each other */
+	static bool IsHostile(uint8 TeamA, uint8 TeamB)
+	{
+		return TeamA < MaxTeams && TeamB < MaxTeams && (HostileMasks[TeamA] & (1u << TeamB)) != 0;
+	}
+
+	/** Attitude solver for FGenericTeamId */
+	static ETeamAttitude::Type GetAttitude(FGenericTeamId TeamA, FGenericTeamId TeamB);
+
+private:
+
+	/** Hostile team bits, by team */
+	static uint32 HostileMasks[MaxTeams];
+};
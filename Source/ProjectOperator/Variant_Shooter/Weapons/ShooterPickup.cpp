@@ -5,14 +5,17 @@
 #include "Components/SceneComponent.h"
 #include "Components/SphereComponent.h"
 #include "Components/StaticMeshComponent.h"
+#include "Animation/AnimInstance.h"
 #include "ShooterWeaponHolder.h"
 #include "ShooterWeapon.h"
+#include "ShooterPickupSubsystem.h"
 #include "Engine/World.h"
-#include "TimerManager.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
 
 AShooterPickup::AShooterPickup()
 {
- 	PrimaryActorTick.bCanEverTick = true;
+ 	PrimaryActorTick.bCanEverTick = false;
 
 	// create the root
 	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
@@ -22,14 +25,7 @@ AShooterPickup::AShooterPickup()
 	SphereCollision->SetupAttachment(RootComponent);
 
 	SphereCollision->SetRelativeLocation(FVector(0.0f, 0.0f, 84.0f));
-	SphereCollision->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-	SphereCollision->SetCollisionObjectType(ECC_WorldStatic);
-	SphereCollision->SetCollisionResponseToAllChannels(ECR_Ignore);
-	SphereCollision->SetCollisionResponseToChannel(ECC_Pawn, ECR_Overlap);
-	SphereCollision->bFillCollisionUnderneathForNavmesh = true;
-
-	// subscribe to the collision overlap on the sphere
-	SphereCollision->OnComponentBeginOverlap.AddDynamic(this, &AShooterPickup::OnOverlap);
+	SphereCollision->SetCollisionProfileName(FName("NoCollision"));
 
 	// create the mesh
 	Mesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Mesh"));
@@ -44,8 +40,15 @@ void AShooterPickup::OnConstruction(const FTransform& Transform)
 
 	if (FWeaponTableRow* WeaponData = WeaponType.GetRow<FWeaponTableRow>(FString()))
 	{
-		// set the mesh
-		Mesh->SetStaticMesh(WeaponData->StaticMesh.LoadSynchronous());
+		// set the mesh if it's in memory. Outside of game worlds we can afford to load it right away
+		if (UStaticMesh* LoadedMesh = WeaponData->StaticMesh.Get())
+		{
+			Mesh->SetStaticMesh(LoadedMesh);
+
+		} else if (!GetWorld() || !GetWorld()->IsGameWorld()) {
+
+			Mesh->SetStaticMesh(WeaponData->StaticMesh.LoadSynchronous());
+		}
 	}
 }
 
@@ -57,6 +60,26 @@ void AShooterPickup::BeginPlay()
 	{
 		// copy the weapon class
 		WeaponClass = WeaponData->WeaponToSpawn;
+
+		// stream in the pickup mesh if construction couldn't set it
+		if (!Mesh->GetStaticMesh() && !WeaponData->StaticMesh.IsNull())
+		{
+			MeshLoadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(WeaponData->StaticMesh.ToSoftObjectPath(), FStreamableDelegate::CreateUObject(this, &AShooterPickup::OnMeshLoaded));
+		}
+	}
+
+	// register with the pickup subsystem. Only watch for streaming if the weapon isn't already in memory
+	if (UShooterPickupSubsystem* PickupSubsystem = GetPickupSubsystem())
+	{
+		const bool bNeedsStreaming = !WeaponClass.IsNull() && !WeaponClass.Get();
+
+		PickupSlot = PickupSubsystem->RegisterPickup(this, SphereCollision->GetComponentLocation(), SphereCollision->GetScaledSphereRadius(), bNeedsStreaming ? StreamingRadius : -1.0f);
+	}
+
+	// a weapon already in memory still needs its anim layers requested
+	if (WeaponClass.Get())
+	{
+		RequestWeaponLoad();
 	}
 }
 
@@ -64,28 +87,132 @@ void AShooterPickup::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
-	// clear the respawn timer
-	GetWorld()->GetTimerManager().ClearTimer(RespawnTimer);
+	// unregister from the pickup subsystem
+	if (UShooterPickupSubsystem* PickupSubsystem = GetPickupSubsystem())
+	{
+		PickupSubsystem->UnregisterPickup(PickupSlot);
+	}
+
+	PickupSlot = INDEX_NONE;
+
+	// let go of the streamed assets
+	if (WeaponLoadHandle.IsValid())
+	{
+		WeaponLoadHandle->CancelHandle();
+		WeaponLoadHandle.Reset();
+	}
+
+	if (AnimLayerLoadHandle.IsValid())
+	{
+		AnimLayerLoadHandle->CancelHandle();
+		AnimLayerLoadHandle.Reset();
+	}
+
+	if (MeshLoadHandle.IsValid())
+	{
+		MeshLoadHandle->CancelHandle();
+		MeshLoadHandle.Reset();
+	}
+}
+
+UShooterPickupSubsystem* AShooterPickup::GetPickupSubsystem() const
+{
+	return GetWorld() ? GetWorld()->GetSubsystem<UShooterPickupSubsystem>() : nullptr;
+}
+
+bool AShooterPickup::GrantTo(AActor* Holder)
+{
+	// can the actor hold weapons?
+	IShooterWeaponHolder* WeaponHolder = Cast<IShooterWeaponHolder>(Holder);
+
+	if (!WeaponHolder)
+	{
+		return false;
+	}
+
+	UClass* LoadedClass = WeaponClass.Get();
+
+	if (bWeaponReady && LoadedClass)
+	{
+		WeaponHolder->AddWeaponClass(LoadedClass);
+
+	} else {
+
+		// the holder outran the streaming radius, so grant the weapon once it's in
+		PendingWeaponHolder = Holder;
+		RequestWeaponLoad();
+	}
+
+	// hide this mesh. The subsystem schedules the respawn
+	SetActorHiddenInGame(true);
+
+	return true;
+}
+
+void AShooterPickup::RequestWeaponLoad()
+{
+	// no need to keep checking once the load is requested
+	if (UShooterPickupSubsystem* PickupSubsystem = GetPickupSubsystem())
+	{
+		PickupSubsystem->ClearStreaming(PickupSlot);
+	}
+
+	if (WeaponLoadHandle.IsValid() || WeaponClass.IsNull())
+	{
+		return;
+	}
+
+	// the anim layers are requested separately once the class is in
+	WeaponLoadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(WeaponClass.ToSoftObjectPath(), FStreamableDelegate::CreateUObject(this, &AShooterPickup::OnWeaponLoaded));
 }
 
-void AShooterPickup::OnOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void AShooterPickup::OnWeaponLoaded()
 {
-	// have we collided against a weapon holder?
-	if (IShooterWeaponHolder* WeaponHolder = Cast<IShooterWeaponHolder>(OtherActor))
+	// the weapon links its anim layers as soon as it's activated, so load them explicitly before handing it out
+	TArray<FSoftObjectPath> AnimLayerPaths;
+
+	if (UClass* LoadedClass = WeaponClass.Get())
 	{
-		WeaponHolder->AddWeaponClass(WeaponClass);
+		const AShooterWeapon* WeaponCDO = GetDefault<AShooterWeapon>(LoadedClass);
+
+		for (const TSubclassOf<UAnimInstance>& AnimLayerClass : { WeaponCDO->GetFirstPersonAnimLayerClass(), WeaponCDO->GetThirdPersonAnimLayerClass() })
+		{
+			if (AnimLayerClass)
+			{
+				AnimLayerPaths.AddUnique(FSoftObjectPath(AnimLayerClass.Get()));
+			}
+		}
+	}
+
+	if (AnimLayerPaths.IsEmpty())
+	{
+		OnWeaponAnimLayersLoaded();
+		return;
+	}
 
-		// hide this mesh
-		SetActorHiddenInGame(true);
+	AnimLayerLoadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(AnimLayerPaths, FStreamableDelegate::CreateUObject(this, &AShooterPickup::OnWeaponAnimLayersLoaded));
+}
+
+void AShooterPickup::OnWeaponAnimLayersLoaded()
+{
+	bWeaponReady = true;
 
-		// disable collision
-		SetActorEnableCollision(false);
+	IShooterWeaponHolder* WeaponHolder = Cast<IShooterWeaponHolder>(PendingWeaponHolder.Get());
+	PendingWeaponHolder.Reset();
 
-		// disable ticking
-		SetActorTickEnabled(false);
+	UClass* LoadedClass = WeaponClass.Get();
 
-		// schedule the respawn
-		GetWorld()->GetTimerManager().SetTimer(RespawnTimer, this, &AShooterPickup::RespawnPickup, RespawnTime, false);
+	if (WeaponHolder && LoadedClass)
+	{
+		WeaponHolder->AddWeaponClass(LoadedClass);
+	}
+}
+
+void AShooterPickup::OnMeshLoaded()
+{
+	if (FWeaponTableRow* WeaponData = WeaponType.GetRow<FWeaponTableRow>(FString()))
+	{
+		Mesh->SetStaticMesh(WeaponData->StaticMesh.Get());
 	}
 }
 
@@ -98,11 +225,17 @@ void AShooterPickup::RespawnPickup()
 	BP_OnRespawn();
 }
 
-void AShooterPickup::FinishRespawn()
+void AShooterPickup::ResetPickup()
 {
-	// enable collision
-	SetActorEnableCollision(true);
+	// unhide this pickup
+	SetActorHiddenInGame(false);
+}
 
-	// enable tick
-	SetActorTickEnabled(true);
+void AShooterPickup::FinishRespawn()
+{
+	// make the pickup available again
+	if (UShooterPickupSubsystem* PickupSubsystem = GetPickupSubsystem())
+	{
+		PickupSubsystem->SetPickupAvailable(PickupSlot);
+	}
 }
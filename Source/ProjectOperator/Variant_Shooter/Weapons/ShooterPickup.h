@@ -9,8 +9,9 @@
 #include "ShooterPickup.generated.h"
 
 class USphereComponent;
-class UPrimitiveComponent;
 class AShooterWeapon;
+class UShooterPickupSubsystem;
+struct FStreamableHandle;
 
 /**
  *  Holds information about a type of weapon pickup
@@ -24,20 +25,21 @@ struct FWeaponTableRow : public FTableRowBase
 	UPROPERTY(EditAnywhere)
 	TSoftObjectPtr<UStaticMesh> StaticMesh;
 
-	/** Weapon class to grant on pickup */
+	/** Weapon class to grant on pickup. Streamed in along with its anim layers when a player gets close */
 	UPROPERTY(EditAnywhere)
-	TSubclassOf<AShooterWeapon> WeaponToSpawn;
+	TSoftClassPtr<AShooterWeapon> WeaponToSpawn;
 };
 
 /**
  *  Simple shooter game weapon pickup
+ *  Players are checked against the pickup by UShooterPickupSubsystem, so it needs no collision or tick of its own
  */
 UCLASS(abstract)
 class PROJECTOPERATOR_API AShooterPickup : public AActor
 {
 	GENERATED_BODY()
 
-	/** Collision sphere */
+	/** Pickup sphere. Has no collision, only sets the pickup location and radius */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
 	USphereComponent* SphereCollision;
 
@@ -52,14 +54,33 @@ protected:
 	FDataTableRowHandle WeaponType;
 
 	/** Type to weapon to grant on pickup. Set from the weapon data table. */
-	TSubclassOf<AShooterWeapon> WeaponClass;
+	TSoftClassPtr<AShooterWeapon> WeaponClass;
+
+	/** Players within this distance start streaming in the weapon class, so it's loaded by the time they pick it up */
+	UPROPERTY(EditAnywhere, Category="Pickup", meta = (ClampMin = 0, Units = "cm"))
+	float StreamingRadius = 3000.0f;
+
+	/** Keeps the weapon class loaded once requested */
+	TSharedPtr<FStreamableHandle> WeaponLoadHandle;
+
+	/** Keeps the weapon's anim layer classes loaded once the weapon class is in */
+	TSharedPtr<FStreamableHandle> AnimLayerLoadHandle;
+
+	/** Set once the weapon class and its anim layer classes are loaded */
+	bool bWeaponReady = false;
+
+	/** Keeps the pickup mesh loaded once requested */
+	TSharedPtr<FStreamableHandle> MeshLoadHandle;
+
+	/** Weapon holder that picked this up before the weapon finished loading */
+	TWeakObjectPtr<AActor> PendingWeaponHolder;
 	
 	/** Time to wait before respawning this pickup */
 	UPROPERTY(EditAnywhere, Category="Pickup", meta = (ClampMin = 0, ClampMax = 120, Units = "s"))
 	float RespawnTime = 4.0f;
 
-	/** Timer to respawn the pickup */
-	FTimerHandle RespawnTimer;
+	/** Slot for this pickup in the pickup subsystem */
+	int32 PickupSlot = INDEX_NONE;
 
 public:	
 	
@@ -77,15 +98,40 @@ protected:
 	/** Gameplay cleanup */
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
-	/** Handles collision overlap */
-	UFUNCTION()
-	virtual void OnOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+	/** Returns the pickup subsystem for this world, if any */
+	UShooterPickupSubsystem* GetPickupSubsystem() const;
 
-protected:
+public:
+
+	/**
+	 *  Grants the weapon to the passed actor and hides this pickup until it respawns
+	 *  Called by the pickup subsystem. Returns false if the actor can't hold weapons
+	 */
+	bool GrantTo(AActor* Holder);
 
-	/** Called when it's time to respawn this pickup */
+	/** Starts streaming the weapon class and its anim layers, if they're not loaded or loading already */
+	void RequestWeaponLoad();
+
+	/** Called by the pickup subsystem when it's time to respawn this pickup */
 	void RespawnPickup();
 
+	/** Makes this pickup immediately visible and available again, skipping the respawn animation */
+	void ResetPickup();
+
+	/** Returns the time to wait before respawning this pickup */
+	float GetRespawnTime() const { return RespawnTime; }
+
+protected:
+
+	/** Requests the weapon's anim layer classes once the weapon class is in */
+	void OnWeaponLoaded();
+
+	/** Grants the weapon to a holder that picked it up while it was still loading */
+	void OnWeaponAnimLayersLoaded();
+
+	/** Sets the pickup mesh once it's streamed in */
+	void OnMeshLoaded();
+
 	/** Passes control to Blueprint to animate the pickup respawn. Should end by calling FinishRespawn */
 	UFUNCTION(BlueprintImplementableEvent, Category="Pickup", meta = (DisplayName = "OnRespawn"))
 	void BP_OnRespawn();
@@ -0,0 +1,254 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/Weapons/ShooterPickupSubsystem.h"
+#include "Variant_Shooter/Weapons/ShooterPickup.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerState.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+#include "Math/VectorRegister.h"
+#include "ProjectOperator.h"
+
+DECLARE_CYCLE_STAT(TEXT("Pickup Checks"), STAT_ShooterPickupChecks, STATGROUP_ShooterAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pickup Slots"), STAT_ShooterPickupSlots, STATGROUP_ShooterAI);
+
+bool UShooterPickupSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterPickupSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TimeUntilCheck -= DeltaTime;
+
+	if (TimeUntilCheck > 0.0f)
+	{
+		return;
+	}
+
+	TimeUntilCheck = CheckInterval;
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterPickupChecks);
+
+	SET_DWORD_STAT(STAT_ShooterPickupSlots, Pickups.Num());
+
+	ProcessRespawns(GetWorld()->GetTimeSeconds());
+
+	if (Pickups.IsEmpty())
+	{
+		return;
+	}
+
+	// gather the player pawns. Clients only have their own player controller, so go through the replicated player states
+	Players.Reset();
+
+	if (const AGameStateBase* GameState = GetWorld()->GetGameState())
+	{
+		for (const APlayerState* PlayerState : GameState->PlayerArray)
+		{
+			if (PlayerState && !PlayerState->IsABot() && PlayerState->GetPawn())
+			{
+				Players.Add(PlayerState->GetPawn());
+			}
+		}
+	}
+
+	TArray<int32> PickupSlots;
+	TArray<int32> StreamingSlots;
+
+	for (APawn* Player : Players)
+	{
+		PickupSlots.Reset();
+		StreamingSlots.Reset();
+
+		TestPlayer(Player->GetActorLocation(), PickupSlots, StreamingSlots);
+
+		for (int32 Slot : StreamingSlots)
+		{
+			StreamingRadiusSq[Slot] = -1.0f;
+
+			if (AShooterPickup* Pickup = Pickups[Slot].Get())
+			{
+				Pickup->RequestWeaponLoad();
+			}
+		}
+
+		for (int32 Slot : PickupSlots)
+		{
+			AShooterPickup* Pickup = Pickups[Slot].Get();
+
+			// the pickup may have been taken by an earlier player this check
+			if (!Pickup || PickupRadiusSq[Slot] < 0.0f)
+			{
+				continue;
+			}
+
+			if (!Pickup->GrantTo(Player))
+			{
+				continue;
+			}
+
+			// unavailable until the shared schedule respawns it
+			PickupRadiusSq[Slot] = -1.0f;
+			FShooterPickupRespawn Respawn;
+			Respawn.Time = GetWorld()->GetTimeSeconds() + Pickup->GetRespawnTime();
+			Respawn.Slot = Slot;
+			Respawn.Generation = SlotGenerations[Slot];
+
+			RespawnQueue.HeapPush(Respawn);
+		}
+	}
+}
+
+TStatId UShooterPickupSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterPickupSubsystem, STATGROUP_Tickables);
+}
+
+int32 UShooterPickupSubsystem::RegisterPickup(AShooterPickup* Pickup, const FVector& Location, float Radius, float StreamingRadius)
+{
+	// grow by a full SIMD run of padding slots when we're out
+	if (FreeSlots.IsEmpty())
+	{
+		const int32 FirstNewSlot = Pickups.Num();
+
+		Pickups.AddDefaulted(Width);
+		X.AddZeroed(Width);
+		Y.AddZeroed(Width);
+		Z.AddZeroed(Width);
+		SlotGenerations.AddZeroed(Width);
+
+		for (int32 i = 0; i < Width; ++i)
+		{
+			PickupRadiusSq.Add(-1.0f);
+			StreamingRadiusSq.Add(-1.0f);
+			AvailableRadiusSq.Add(-1.0f);
+
+			// hand out the lowest slot first
+			FreeSlots.Add(FirstNewSlot + Width - 1 - i);
+		}
+	}
+
+	const int32 Slot = FreeSlots.Pop(EAllowShrinking::No);
+
+	Pickups[Slot] = Pickup;
+	X[Slot] = Location.X;
+	Y[Slot] = Location.Y;
+	Z[Slot] = Location.Z;
+
+	AvailableRadiusSq[Slot] = FMath::Square(Radius);
+	PickupRadiusSq[Slot] = AvailableRadiusSq[Slot];
+	StreamingRadiusSq[Slot] = StreamingRadius < 0.0f ? -1.0f : FMath::Square(StreamingRadius);
+
+	return Slot;
+}
+
+void UShooterPickupSubsystem::UnregisterPickup(int32 Slot)
+{
+	if (!Pickups.IsValidIndex(Slot))
+	{
+		return;
+	}
+
+	// turn the slot into padding. Any queued respawn for it is now stale, even if the slot is reused before it's due
+	Pickups[Slot] = nullptr;
+	PickupRadiusSq[Slot] = -1.0f;
+	StreamingRadiusSq[Slot] = -1.0f;
+	AvailableRadiusSq[Slot] = -1.0f;
+
+	++SlotGenerations[Slot];
+
+	FreeSlots.Add(Slot);
+}
+
+void UShooterPickupSubsystem::SetPickupAvailable(int32 Slot)
+{
+	if (Pickups.IsValidIndex(Slot))
+	{
+		PickupRadiusSq[Slot] = AvailableRadiusSq[Slot];
+	}
+}
+
+void UShooterPickupSubsystem::ClearStreaming(int32 Slot)
+{
+	if (StreamingRadiusSq.IsValidIndex(Slot))
+	{
+		StreamingRadiusSq[Slot] = -1.0f;
+	}
+}
+
+void UShooterPickupSubsystem::ResetAllPickups()
+{
+	RespawnQueue.Reset();
+
+	for (int32 Slot = 0; Slot < Pickups.Num(); ++Slot)
+	{
+		if (AShooterPickup* Pickup = Pickups[Slot].Get())
+		{
+			Pickup->ResetPickup();
+
+			PickupRadiusSq[Slot] = AvailableRadiusSq[Slot];
+		}
+	}
+}
+
+void UShooterPickupSubsystem::TestPlayer(const FVector& PlayerLocation, TArray<int32>& OutPickupSlots, TArray<int32>& OutStreamingSlots) const
+{
+	const VectorRegister4Float PX = VectorSetFloat1(PlayerLocation.X);
+	const VectorRegister4Float PY = VectorSetFloat1(PlayerLocation.Y);
+	const VectorRegister4Float PZ = VectorSetFloat1(PlayerLocation.Z);
+
+	for (int32 Slot = 0; Slot < Pickups.Num(); Slot += Width)
+	{
+		const VectorRegister4Float DX = VectorSubtract(PX, VectorLoad(&X[Slot]));
+		const VectorRegister4Float DY = VectorSubtract(PY, VectorLoad(&Y[Slot]));
+		const VectorRegister4Float DZ = VectorSubtract(PZ, VectorLoad(&Z[Slot]));
+
+		const VectorRegister4Float DistanceSq = VectorMultiplyAdd(DX, DX, VectorMultiplyAdd(DY, DY, VectorMultiply(DZ, DZ)));
+
+		// unavailable and padding lanes have negative radii, so they never pass
+		const int32 PickupMask = VectorMaskBits(VectorCompareLE(DistanceSq, VectorLoad(&PickupRadiusSq[Slot])));
+		const int32 StreamingMask = VectorMaskBits(VectorCompareLE(DistanceSq, VectorLoad(&StreamingRadiusSq[Slot])));
+
+		if ((PickupMask | StreamingMask) == 0)
+		{
+			continue;
+		}
+
+		for (int32 Lane = 0; Lane < Width; ++Lane)
+		{
+			if (PickupMask & (1 << Lane))
+			{
+				OutPickupSlots.Add(Slot + Lane);
+			}
+
+			if (StreamingMask & (1 << Lane))
+			{
+				OutStreamingSlots.Add(Slot + Lane);
+			}
+		}
+	}
+}
+
+void UShooterPickupSubsystem::ProcessRespawns(double Now)
+{
+	while (!RespawnQueue.IsEmpty() && RespawnQueue.HeapTop().Time <= Now)
+	{
+		FShooterPickupRespawn Respawn;
+		RespawnQueue.HeapPop(Respawn, EAllowShrinking::No);
+
+		// the pickup may have been removed while waiting, and its slot handed to another pickup
+		if (SlotGenerations[Respawn.Slot] != Respawn.Generation)
+		{
+			continue;
+		}
+
+		if (AShooterPickup* Pickup = Pickups[Respawn.Slot].Get())
+		{
+			Pickup->RespawnPickup();
+		}
+	}
+}
@@ -0,0 +1,123 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterPickupSubsystem.generated.h"
+
+class AShooterPickup;
+
+/**
+ *  Pickup respawn scheduled by the pickup subsystem
+ */
+struct FShooterPickupRespawn
+{
+	/** Game time to respawn at */
+	double Time = 0.0;
+
+	/** Slot of the pickup */
+	int32 Slot = INDEX_NONE;
+
+	/** Generation of the slot when the respawn was scheduled. The respawn is stale if the slot was reused since */
+	uint32 Generation = 0;
+
+	/** Orders the respawn heap by time */
+	bool operator<(const FShooterPickupRespawn& Other) const
+	{
+		return Time < Other.Time;
+	}
+};
+
+/**
+ *  Manages every weapon pickup in the world from a compact array
+ *  On a fixed schedule, pickup locations are tested against the player pawns four at a time,
+ *  both for pickup and for streaming in the weapon ahead of time. Respawns share a single schedule,
+ *  so pickups themselves need no collision or tick
+ */
+UCLASS()
+class PROJECTOPERATOR_API UShooterPickupSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Number of floats processed per SIMD operation */
+	static constexpr int32 Width = 4;
+
+	/** Interval between pickup checks */
+	static constexpr float CheckInterval = 0.1f;
+
+protected:
+
+	/** Pickup for each slot. Null for free and padding slots */
+	TArray<TWeakObjectPtr<AShooterPickup>> Pickups;
+
+	/** Pickup locations */
+	TArray<float> X;
+	TArray<float> Y;
+	TArray<float> Z;
+
+	/** Squared pickup radius. Negative while the pickup is unavailable, so the lane never passes */
+	TArray<float> PickupRadiusSq;
+
+	/** Squared streaming radius. Negative once the weapon no longer needs streaming */
+	TArray<float> StreamingRadiusSq;
+
+	/** Pickup radius to restore once each pickup is available again */
+	TArray<float> AvailableRadiusSq;
+
+	/** Bumped every time a slot is freed, so respawns queued for a removed pickup are skipped */
+	TArray<uint32> SlotGenerations;
+
+	/** Slots free for reuse */
+	TArray<int32> FreeSlots;
+
+	/** Pending respawns as a min heap of game time */
+	TArray<FShooterPickupRespawn> RespawnQueue;
+
+	/** Player pawns gathered for the current check */
+	TArray<TObjectPtr<APawn>> Players;
+
+	/** Time left until the next check */
+	float TimeUntilCheck = 0.0f;
+
+public:
+
+	/** Only create this subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Runs pickup, streaming and respawn checks on the fixed schedule */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable object */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/**
+	 *  Adds a pickup and returns its slot
+	 *  @param StreamingRadius players within this distance stream in the weapon. Pass a negative radius if no streaming is needed
+	 */
+	int32 RegisterPickup(AShooterPickup* Pickup, const FVector& Location, float Radius, float StreamingRadius);
+
+	/** Removes a pickup */
+	void UnregisterPickup(int32 Slot);
+
+	/** Marks the pickup as ready to be picked up again */
+	void SetPickupAvailable(int32 Slot);
+
+	/** Stops streaming checks for the pickup */
+	void ClearStreaming(int32 Slot);
+
+	/** Cancels any pending respawn and makes every pickup immediately available */
+	void ResetAllPickups();
+
+protected:
+
+	/** Tests every slot against a single player location, returning the slots within each radius */
+	void TestPlayer(const FVector& PlayerLocation, TArray<int32>& OutPickupSlots, TArray<int32>& OutStreamingSlots) const;
+
+	/** Respawns every pickup whose respawn time has passed */
+	void ProcessRespawns(double Now);
+};
@@ -12,6 +12,7 @@
 #include "Engine/OverlapResult.h"
 #include "Engine/World.h"
 #include "TimerManager.h"
+#include "ShooterInfluenceMapSubsystem.h"
 
 AShooterProjectile::AShooterProjectile()
 {
@@ -68,6 +69,12 @@ void AShooterProjectile::NotifyHit(class UPrimitiveComponent* MyComp, AActor* Ot
 	// make AI perception noise
 	MakeNoise(NoiseLoudness, GetInstigator(), GetActorLocation(), NoiseRange, NoiseTag);
 
+	// mark the impact on the AI influence map
+	if (UShooterInfluenceMapSubsystem* InfluenceMap = GetWorld()->GetSubsystem<UShooterInfluenceMapSubsystem>())
+	{
+		InfluenceMap->ReportNoise(GetInstigator(), GetActorLocation());
+	}
+
 	if (bExplodeOnHit)
 	{
 		
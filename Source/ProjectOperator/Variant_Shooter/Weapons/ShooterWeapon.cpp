@@ -11,10 +11,15 @@
 #include "Animation/AnimInstance.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "GameFramework/Pawn.h"
+#include "ShooterInfluenceMapSubsystem.h"
+#include "Misc/PackageName.h"
+
+const FPrimaryAssetType AShooterWeapon::WeaponAssetType(TEXT("ShooterWeapon"));
 
 AShooterWeapon::AShooterWeapon()
 {
-	PrimaryActorTick.bCanEverTick = true;
+	// weapons are driven by their owner and timers, so they never need to tick
+	PrimaryActorTick.bCanEverTick = false;
 
 	// create the root
 	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
@@ -27,6 +32,9 @@ AShooterWeapon::AShooterWeapon()
 	FirstPersonMesh->SetFirstPersonPrimitiveType(EFirstPersonPrimitiveType::FirstPerson);
 	FirstPersonMesh->bOnlyOwnerSee = true;
 
+	// only animate for viewers that can actually see this mesh
+	FirstPersonMesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+
 	// create the third person mesh
 	ThirdPersonMesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("Third Person Mesh"));
 	ThirdPersonMesh->SetupAttachment(RootComponent);
@@ -34,6 +42,20 @@ AShooterWeapon::AShooterWeapon()
 	ThirdPersonMesh->SetCollisionProfileName(FName("NoCollision"));
 	ThirdPersonMesh->SetFirstPersonPrimitiveType(EFirstPersonPrimitiveType::WorldSpaceRepresentation);
 	ThirdPersonMesh->bOwnerNoSee = true;
+
+	// the owner never sees this mesh, so it only animates for everyone else
+	ThirdPersonMesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+}
+
+FPrimaryAssetId AShooterWeapon::GetPrimaryAssetId() const
+{
+	// only the blueprint class defaults stand for a weapon asset
+	if (HasAnyFlags(RF_ClassDefaultObject) && !GetClass()->HasAnyClassFlags(CLASS_Native))
+	{
+		return FPrimaryAssetId(WeaponAssetType, FPackageName::GetShortFName(GetOutermost()->GetFName()));
+	}
+
+	return Super::GetPrimaryAssetId();
 }
 
 void AShooterWeapon::BeginPlay()
@@ -70,8 +92,8 @@ void AShooterWeapon::OnOwnerDestroyed(AActor* DestroyedActor)
 
 void AShooterWeapon::ActivateWeapon()
 {
-	// unhide this weapon
-	SetActorHiddenInGame(false);
+	// wake this weapon up
+	SetDormant(false);
 
 	// notify the owner
 	WeaponOwner->OnWeaponActivated(this);
@@ -82,8 +104,8 @@ void AShooterWeapon::DeactivateWeapon()
 	// ensure we're no longer firing this weapon while deactivated
 	StopFiring();
 
-	// hide the weapon
-	SetActorHiddenInGame(true);
+	// put the weapon to sleep
+	SetDormant(true);
 
 	// notify the owner
 	WeaponOwner->OnWeaponDeactivated(this);
@@ -123,6 +145,62 @@ void AShooterWeapon::StopFiring()
 	GetWorld()->GetTimerManager().ClearTimer(RefireTimer);
 }
 
+void AShooterWeapon::ResetAmmo()
+{
+	StopFiring();
+
+	// fill the magazine
+	CurrentBullets = MagazineSize;
+
+	// update the owner's HUD
+	WeaponOwner->UpdateWeaponHUD(CurrentBullets, MagazineSize);
+}
+
+void AShooterWeapon::DisableFirstPersonMesh()
+{
+	bFirstPersonMeshEnabled = false;
+
+	// nobody will ever see it, so don't render, animate or tick it
+	FirstPersonMesh->SetVisibility(false);
+	FirstPersonMesh->SetComponentTickEnabled(false);
+	FirstPersonMesh->bNoSkeletonUpdate = true;
+}
+
+void AShooterWeapon::SetDormant(bool bDormant)
+{
+	if (bIsDormant == bDormant)
+	{
+		return;
+	}
+
+	bIsDormant = bDormant;
+
+	SetActorHiddenInGame(bDormant);
+
+	// dormant meshes neither tick nor refresh their bones
+	FirstPersonMesh->SetComponentTickEnabled(!bDormant && bFirstPersonMeshEnabled);
+	FirstPersonMesh->bNoSkeletonUpdate = bDormant || !bFirstPersonMeshEnabled;
+
+	ThirdPersonMesh->SetComponentTickEnabled(!bDormant);
+	ThirdPersonMesh->bNoSkeletonUpdate = bDormant;
+
+	if (bDormant)
+	{
+		// detach from the owner so holstered weapons don't follow its bones around
+		const FAttachmentTransformRules AttachmentRule(EAttachmentRule::SnapToTarget, false);
+
+		FirstPersonMesh->AttachToComponent(RootComponent, AttachmentRule);
+		ThirdPersonMesh->AttachToComponent(RootComponent, AttachmentRule);
+
+		DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+
+	} else {
+
+		// get back in the owner's hands
+		WeaponOwner->AttachWeaponMeshes(this);
+	}
+}
+
 void AShooterWeapon::Fire()
 {
 	// ensure the player still wants to fire. They may have let go of the trigger
@@ -140,6 +218,12 @@ void AShooterWeapon::Fire()
 	// make noise so the AI perception system can hear us
 	MakeNoise(ShotLoudness, PawnOwner, PawnOwner->GetActorLocation(), ShotNoiseRange, ShotNoiseTag);
 
+	// mark the shooter's position on the AI influence map
+	if (UShooterInfluenceMapSubsystem* InfluenceMap = GetWorld()->GetSubsystem<UShooterInfluenceMapSubsystem>())
+	{
+		InfluenceMap->ReportNoise(PawnOwner, PawnOwner->GetActorLocation());
+	}
+
 	// are we full auto?
 	if (bFullAuto)
 	{
@@ -194,8 +278,9 @@ void AShooterWeapon::FireProjectile(const FVector& TargetLocation)
 
 FTransform AShooterWeapon::CalculateProjectileSpawnTransform(const FVector& TargetLocation) const
 {
-	// find the muzzle location
-	const FVector MuzzleLoc = FirstPersonMesh->GetSocketLocation(MuzzleSocketName);
+	// find the muzzle location on the mesh the owner is actually holding
+	const USkeletalMeshComponent* MuzzleMesh = bFirstPersonMeshEnabled ? FirstPersonMesh : ThirdPersonMesh;
+	const FVector MuzzleLoc = MuzzleMesh->GetSocketLocation(MuzzleSocketName);
 
 	// calculate the spawn location ahead of the muzzle
 	const FVector SpawnLoc = MuzzleLoc + ((TargetLocation - MuzzleLoc).GetSafeNormal() * MuzzleOffset);
@@ -216,3 +301,13 @@ const TSubclassOf<UAnimInstance>& AShooterWeapon::GetThirdPersonAnimInstanceClas
 {
 	return ThirdPersonAnimInstanceClass;
 }
+
+const TSubclassOf<UAnimInstance>& AShooterWeapon::GetFirstPersonAnimLayerClass() const
+{
+	return FirstPersonAnimLayerClass;
+}
+
+const TSubclassOf<UAnimInstance>& AShooterWeapon::GetThirdPersonAnimLayerClass() const
+{
+	return ThirdPersonAnimLayerClass;
+}
@@ -53,11 +53,19 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Animation")
 	UAnimMontage* FiringMontage;
 
-	/** AnimInstance class to set for the first person character mesh when this weapon is active */
+	/** Anim layers class to link into the first person character mesh when this weapon is active */
+	UPROPERTY(EditAnywhere, Category="Animation")
+	TSubclassOf<UAnimInstance> FirstPersonAnimLayerClass;
+
+	/** Anim layers class to link into the third person character mesh when this weapon is active */
+	UPROPERTY(EditAnywhere, Category="Animation")
+	TSubclassOf<UAnimInstance> ThirdPersonAnimLayerClass;
+
+	/** AnimInstance class to set for the first person character mesh when this weapon is active. Only used if there's no anim layers class */
 	UPROPERTY(EditAnywhere, Category="Animation")
 	TSubclassOf<UAnimInstance> FirstPersonAnimInstanceClass;
 
-	/** AnimInstance class to set for the third person character mesh when this weapon is active */
+	/** AnimInstance class to set for the third person character mesh when this weapon is active. Only used if there's no anim layers class */
 	UPROPERTY(EditAnywhere, Category="Animation")
 	TSubclassOf<UAnimInstance> ThirdPersonAnimInstanceClass;
 
@@ -94,6 +102,12 @@ protected:
 	/** Timer to handle full auto refiring */
 	FTimerHandle RefireTimer;
 
+	/** If true, the weapon is holstered and asleep */
+	bool bIsDormant = false;
+
+	/** If false, the owner has no first person view, so the first person mesh is off and shots come out of the third person mesh */
+	bool bFirstPersonMeshEnabled = true;
+
 	/** Cast pawn pointer to the owner for AI perception system interactions */
 	TObjectPtr<APawn> PawnOwner;
 
@@ -114,6 +128,12 @@ public:
 	/** Constructor */
 	AShooterWeapon();
 
+	/** Primary asset type weapon blueprints are registered with the asset manager under */
+	static const FPrimaryAssetType WeaponAssetType;
+
+	/** Identifies weapon blueprints to the asset manager, so they can be cooked and streamed as primary assets */
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+
 protected:
 	
 	/** Gameplay initialization */
@@ -128,12 +148,18 @@ protected:
 	UFUNCTION()
 	void OnOwnerDestroyed(AActor* DestroyedActor);
 
+	/**
+	 *  Puts the weapon to sleep while holstered, or wakes it back up
+	 *  Dormant weapons are hidden, detached from the owner's bones and skip mesh ticking and skeleton updates
+	 */
+	void SetDormant(bool bDormant);
+
 public:
 
 	/** Activates this weapon and gets it ready to fire */
 	void ActivateWeapon();
 
-	/** Deactivates this weapon */
+	/** Deactivates this weapon and puts it to sleep until it's activated again */
 	void DeactivateWeapon();
 
 	/** Start firing this weapon */
@@ -142,6 +168,12 @@ public:
 	/** Stop firing this weapon */
 	void StopFiring();
 
+	/** Stops firing and fills the magazine, e.g. when a pooled owner is reset for respawn */
+	void ResetAmmo();
+
+	/** Turns off the first person mesh for owners that are never viewed in first person */
+	void DisableFirstPersonMesh();
+
 protected:
 
 	/** Fire the weapon */
@@ -172,6 +204,12 @@ public:
 	/** Returns the third person anim instance class */
 	const TSubclassOf<UAnimInstance>& GetThirdPersonAnimInstanceClass() const;
 
+	/** Returns the first person anim layers class */
+	const TSubclassOf<UAnimInstance>& GetFirstPersonAnimLayerClass() const;
+
+	/** Returns the third person anim layers class */
+	const TSubclassOf<UAnimInstance>& GetThirdPersonAnimLayerClass() const;
+
 	/** Returns the magazine size */
 	int32 GetMagazineSize() const { return MagazineSize; };
 